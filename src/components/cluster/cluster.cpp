@@ -417,8 +417,9 @@ namespace Hill {
 #endif
             std::thread work([&, sock]() {
                 while(run) {
-                    check_income_connection(sock);
-                    sleep(1);
+                    if (Misc::wait_readable(sock, Misc::Constants::iACCEPT_WAIT_MS)) {
+                        check_income_connection(sock);
+                    }
                 }
                 shutdown(sock, 0);
             });
@@ -7,5 +7,7 @@
 #define __HILL_PINDEX__
 #define __HILL_FETCH_VALUE__
 // #define __HILL_SAMPLE__
+// #define __HILL_CRASH_TEST__
 #define __HILL_LOG_ALLOCATOR__
+// #define __HILL_VALUE_LOG__
 #endif
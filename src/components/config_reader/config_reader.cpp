@@ -118,6 +118,36 @@ namespace Hill {
     // Monitor loops on regex matching, thus no method is offered here
 
     // for client
+    auto ConfigReader::read_numeric_keys(const std::string &content) -> std::optional<std::string> {
+        std::regex rnumeric_keys("numeric_keys:\\s*\"([^\"]*)\"");
+        std::smatch vnumeric_keys;
+        if (!std::regex_search(content, vnumeric_keys, rnumeric_keys)) {
+            return {};
+        }
+
+        return vnumeric_keys[1].str();
+    }
+
+    auto ConfigReader::read_partition_samples(const std::string &content) -> std::optional<std::string> {
+        std::regex rpartition_samples("partition_samples:\\s+(\\S+)");
+        std::smatch vpartition_samples;
+        if (!std::regex_search(content, vpartition_samples, rpartition_samples)) {
+            return {};
+        }
+
+        return vpartition_samples[1].str();
+    }
+
+    auto ConfigReader::read_placement(const std::string &content, const std::string &role) -> std::optional<std::string> {
+        std::regex rplacement("placement_" + role + ":\\s*(\\S+)");
+        std::smatch vplacement;
+        if (!std::regex_search(content, vplacement, rplacement)) {
+            return {};
+        }
+
+        return vplacement[1].str();
+    }
+
     auto ConfigReader::read_rpc_uri(const std::string &content) -> std::optional<std::string> {
         std::regex rrpc_uri("rpc_uri:\\s*(\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}:\\d+)");
         std::smatch vrpc_uri;
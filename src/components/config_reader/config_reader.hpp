@@ -21,6 +21,12 @@ namespace Hill {
         static auto read_erpc_listen_port(const std::string &content) -> std::optional<int>;
         static auto read_monitor_addr(const std::string &content) -> std::optional<std::string>;
         static auto read_monitor_port(const std::string &content) -> std::optional<int>;
+        // optional, the fixed prefix of numeric keys, e.g., numeric_keys: "user"
+        static auto read_numeric_keys(const std::string &content) -> std::optional<std::string>;
+        // optional, a file of sample keys for range partitioning, e.g., partition_samples: keys.txt
+        static auto read_partition_samples(const std::string &content) -> std::optional<std::string>;
+        // optional, CPUs of a thread role, e.g., placement_backend: 8-15 or placement_service: numa:1
+        static auto read_placement(const std::string &content, const std::string &role) -> std::optional<std::string>;
 
         // for monitor
         // Monitor loops on regex matching, thus no method is offered here
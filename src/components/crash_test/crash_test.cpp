@@ -0,0 +1 @@
+#include "crash_test.hpp"
@@ -0,0 +1,69 @@
+#ifndef __HILL__CRASH_TEST__CRASH_TEST__
+#define __HILL__CRASH_TEST__CRASH_TEST__
+#include "config/config.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#include <unistd.h>
+
+/*
+ * Crash point injection for recovery tests
+ *
+ * A crash point is placed right after a store recovery has to cope with. Once armed with n, the
+ * process dies at the n-th crash point it passes via _exit, i.e., without unwinding or running
+ * any destructor, which is the closest a process gets to a power failure on a DRAM-backed fake
+ * PM. Crash points compile to nothing unless __HILL_CRASH_TEST__ is defined.
+ *
+ * Everything here is inline so that turning the flag on does not change link dependencies
+ */
+namespace Hill {
+    namespace CrashTest {
+        namespace Constants {
+            static constexpr int iCRASH_EXIT_CODE = 42;
+            static constexpr uint64_t uDISARMED = ~0UL;
+        }
+
+        using CrashHook = void (*)(const char *);
+
+        inline std::atomic_uint64_t countdown = Constants::uDISARMED;
+        inline std::atomic_uint64_t passed = 0;
+        // invoked with the name of the point right before dying, e.g., to leave a note on PM
+        inline CrashHook on_crash = nullptr;
+
+        inline auto arm(uint64_t n, CrashHook hook = nullptr) noexcept -> void {
+            passed = 0;
+            on_crash = hook;
+            countdown = n;
+        }
+
+        inline auto disarm() noexcept -> void {
+            countdown = Constants::uDISARMED;
+        }
+
+        inline auto get_passed() noexcept -> uint64_t {
+            return passed.load();
+        }
+
+        inline auto crash_point(const char *name) noexcept -> void {
+            ++passed;
+            if (countdown.load(std::memory_order_relaxed) == Constants::uDISARMED) {
+                return;
+            }
+
+            if (--countdown == 0) {
+                if (on_crash) {
+                    on_crash(name);
+                }
+                _exit(Constants::iCRASH_EXIT_CODE);
+            }
+        }
+    }
+}
+
+#ifdef __HILL_CRASH_TEST__
+#define HILL_CRASH_POINT(name) ::Hill::CrashTest::crash_point(name)
+#else
+#define HILL_CRASH_POINT(name)
+#endif
+#endif
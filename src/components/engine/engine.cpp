@@ -6,12 +6,25 @@ namespace Hill {
             return false;
         }
 
-        return run = node->launch();
+        run = node->launch();
+        if (run) {
+            logger->launch_checkpointer();
+            placement.apply(logger->get_checkpointer().native_handle(), Placement::Enums::Role::Service);
+#ifdef __HILL_VALUE_LOG__
+            value_log->launch_cleaner();
+            placement.apply(value_log->get_cleaner().native_handle(), Placement::Enums::Role::Service);
+#endif
+        }
+        return run;
     }
 
     auto Engine::stop() noexcept -> void {
         run = false;
         node->stop();
+        logger->stop_checkpointer();
+#ifdef __HILL_VALUE_LOG__
+        value_log->stop_cleaner();
+#endif
         for (auto &_p : peer_connections) {
             for (auto &p : _p)
                 p = nullptr;
@@ -26,9 +39,12 @@ namespace Hill {
     auto Engine::register_thread() -> int {
         int tid = tids++;
         std::thread checker([&, tid] {
+            placement.apply(Placement::Enums::Role::Service);
+            // checkers share the socket, those losing an accept just wait again
             while(this->run) {
-                check_rdma_request(tid);
-                sleep(1);
+                if (Misc::wait_readable(sock, Misc::Constants::iACCEPT_WAIT_MS)) {
+                    check_rdma_request(tid);
+                }
             }
         });
         checker.detach();
@@ -134,6 +150,7 @@ namespace Hill {
         std::cout << "---->> RDMA device: " << rdma_dev_name << "\n";
         std::cout << "---->> ib port: " << ib_port << "\n";
         std::cout << "---->> gid index: " << gid_idx << "\n";
+        placement.dump();
     }
 
     auto Engine::parse_ib(const std::string &config) noexcept -> bool {
@@ -164,6 +181,30 @@ namespace Hill {
         }
     }
 
+    auto Engine::parse_key_codec(const std::string &config) noexcept -> bool {
+        auto content_ = Misc::file_as_string(config);
+        if (!content_.has_value()) {
+            return false;
+        }
+
+        if (auto p = ConfigReader::read_numeric_keys(content_.value()); p.has_value()) {
+            key_codec = KVPair::KeyCodec::make_numeric_codec(p.value());
+            std::cout << ">> Numeric keys prefixed by \"" << p.value() << "\" are encoded\n";
+            return true;
+        }
+        return false;
+    }
+
+    auto Engine::parse_placement(const std::string &config) noexcept -> bool {
+        auto content_ = Misc::file_as_string(config);
+        if (!content_.has_value()) {
+            return false;
+        }
+
+        placement = Placement::Placement::make_placement(content_.value());
+        return true;
+    }
+
     auto Client::connect_monitor() noexcept -> bool {
         run = true;
         monitor_socket = Misc::socket_connect(false, monitor_port, monitor_addr.to_string().c_str());
@@ -275,6 +316,16 @@ namespace Hill {
         return server_connections[tid][node_id]->post_read(remote_ptr, msg_len);
     }
 
+    auto Client::read_chunked(int tid, int node_id, const byte_ptr_t &remote_ptr, size_t msg_len, byte_ptr_t out)
+        noexcept -> RDMAUtil::StatusPair
+    {
+        if (node_id <= 0 || size_t(node_id) >= Cluster::Constants::uMAX_NODE) {
+            return {RDMAUtil::Status::InvalidArguments, -1};
+        }
+
+        return server_connections[tid][node_id]->read_chunked(remote_ptr, msg_len, out);
+    }
+
     auto Client::poll_completion_once(int tid, int node_id) noexcept -> void {
         if (node_id <= 0 || size_t(node_id) >= Cluster::Constants::uMAX_NODE) {
             return;
@@ -1,12 +1,15 @@
 #ifndef __HILL__ENGINE__ENGINE__
 #define __HILL__ENGINE__ENGINE__
 #include "wal/wal.hpp"
+#include "value_log/value_log.hpp"
 #include "memory_manager/memory_manager.hpp"
 #include "remote_memory/remote_memory.hpp"
 #include "cluster/cluster.hpp"
 #include "rdma/rdma.hpp"
 #include "misc/misc.hpp"
 #include "config_reader/config_reader.hpp"
+#include "kv_pair/kv_pair.hpp"
+#include "placement/placement.hpp"
 
 #include <shared_mutex>
 #include <atomic>
@@ -30,6 +33,8 @@ namespace Hill {
      * |                            |
      * |  ------------------------  |
      * |    Remote Memory Agents    |
+     * |  ------------------------  |
+     * |  Value Log Directory (opt) |
      * |----------------------------|
      * |                            |
      * |        Data Region         |
@@ -40,7 +45,7 @@ namespace Hill {
      * |                            |
      * |----------------------------|
      *
-     * The read cache is placed in DRAM
+     * The read cache is placed in DRAM. Arenas of the value log are taken from the data region
      */
     using namespace Memory::TypeAliases;
     using namespace RDMAUtil;
@@ -69,6 +74,8 @@ namespace Hill {
                 return nullptr;
             }
 
+            ret->parse_key_codec(config);
+            ret->parse_placement(config);
             if (!ret->parse_pmem(config)) {
                 std::cout << ">> Pmem is not specified, using DRAM instead\n";
                 ret->base = new byte_t[ret->node->available_pm];
@@ -93,9 +100,21 @@ namespace Hill {
             offset += sizeof(WAL::LogRegions);
             ret->agent = Memory::RemoteMemoryAgent::make_agent(ret->base + offset, &ret->peer_connections[0]);
             offset += sizeof(Memory::RemoteMemoryAgent);
+#ifdef __HILL_VALUE_LOG__
+            auto vlog_base = ret->base + offset;
+            offset += sizeof(ValueLog::Directory);
+#endif
             ret->node->available_pm -= offset;
             std::cout << ">> " << ret->node->available_pm / 1024 / 1024 / 1024.0 << "GB pmem is available\n";
             ret->allocator = Memory::Allocator::make_allocator(ret->base + offset, ret->node->available_pm);
+#ifdef __HILL_VALUE_LOG__
+            /*
+             * Like the WAL and the allocator, the value log is made afresh on every start, the engine has
+             * no recovery path yet. Once it has, the directory is recovered by recover_or_make_value_log
+             * after the allocator, and the indexes are rebuilt from the records it reports
+             */
+            ret->value_log = ValueLog::ValueLog::make_value_log(vlog_base, ret->allocator);
+#endif
 
             auto [rdma_device, status] = RDMADevice::make_rdma(ret->rdma_dev_name, ret->ib_port, ret->gid_idx);
             if (status != Status::Ok) {
@@ -155,6 +174,21 @@ namespace Hill {
             return agent;
         }
 
+#ifdef __HILL_VALUE_LOG__
+        inline auto get_value_log() noexcept -> ValueLog::ValueLog * {
+            return value_log.get();
+        }
+#endif
+
+        inline auto get_key_codec() const noexcept -> const KVPair::KeyCodec & {
+            return key_codec;
+        }
+
+        // threads of a server apply their placement as they are launched
+        inline auto get_placement() const noexcept -> const Placement::Placement & {
+            return placement;
+        }
+
         inline auto get_rpc_uri() const noexcept -> const std::string & {
             return node->rpc_uri;
         }
@@ -171,12 +205,17 @@ namespace Hill {
         // logger has some runtime data, thus is a smart pointer
         std::unique_ptr<WAL::Logger> logger;
         Memory::Allocator *allocator;
+#ifdef __HILL_VALUE_LOG__
+        std::unique_ptr<ValueLog::ValueLog> value_log;
+#endif
 
         std::unique_ptr<RDMADevice> rdma_device;
         std::string rdma_dev_name;
         int ib_port;
         int gid_idx;
         std::string pmem_file;
+        KVPair::KeyCodec key_codec;
+        Placement::Placement placement;
         byte_ptr_t base;
         bool run;
         std::atomic_int tids;
@@ -190,6 +229,8 @@ namespace Hill {
 
         auto parse_ib(const std::string &config) noexcept -> bool;
         auto parse_pmem(const std::string &config) noexcept -> bool;
+        auto parse_key_codec(const std::string &config) noexcept -> bool;
+        auto parse_placement(const std::string &config) noexcept -> bool;
     };
 
     class Client {
@@ -235,6 +276,9 @@ namespace Hill {
         }
         auto write_to(int tid, int node_id, const byte_ptr_t &remote_ptr, const byte_ptr_t &msg, size_t msg_len) noexcept -> RDMAUtil::StatusPair;
         auto read_from(int tid, int node_id, const byte_ptr_t &remote_ptr, size_t msg_len) noexcept -> RDMAUtil::StatusPair;
+        // reads of any length, completed when returned. See RDMAContext::read_chunked
+        auto read_chunked(int tid, int node_id, const byte_ptr_t &remote_ptr, size_t msg_len, byte_ptr_t out = nullptr)
+            noexcept -> RDMAUtil::StatusPair;
         auto poll_completion_once(int tid, int node_id) noexcept -> void;
         inline auto rdma_buf_as_char(int tid, int node_id) -> const char * {
             return server_connections[tid][node_id]->get_char_buf();
@@ -4,6 +4,9 @@ namespace Hill {
         auto LeafNode::insert(int tid, WAL::Logger *log,
                               Memory::Allocator *alloc,
                               Memory::RemoteMemoryAgent *agent,
+                              ValueLog::ValueLog *vlog,
+                              const KVPair::KeyCodec &codec,
+                              uint32_t version,
                               const char *k, size_t k_sz,
                               const char *v, size_t v_sz,
                               const hill_key_t *hk,
@@ -14,13 +17,14 @@ namespace Hill {
                 return {Enums::OpStatus::NeedSplit, nullptr};
             }
 
+            auto code = codec.encode(k, k_sz);
             int i = 0;
             for (i = 0; i < Constants::iNUM_HIGHKEY; i++) {
                 if (keys[i] == nullptr) {
                     break;
                 }
 
-                auto c = keys[i]->compare(k, k_sz);
+                auto c = codec.compare(codes[i], keys[i], code, k, k_sz);
                 if (c > 0) {
                     break;
                 }
@@ -30,48 +34,75 @@ namespace Hill {
                 }
             }
 
+            /*
+             * Memory that may run out is taken before the key is shifted in, so that a leaf never maps
+             * a key to the value of its neighbour and the insert can be re-dispatched once memory arrives
+             */
+            auto total = KVPair::ValueStamp::stamped_size_of(v_sz);
+            byte_ptr_t v_ptr = nullptr;
+            if (vlog && !agent) {
+                // the record in the value log carries the key, it is the redo record of this value
+                v_ptr = vlog->append(tid, hk, hv, version);
+                if (v_ptr == nullptr) {
+                    return {Enums::OpStatus::NoMemory, nullptr};
+                }
+                log->fence(tid);
+            } else if (agent) {
+                auto &v_entry = log->make_log(tid, WAL::Enums::Ops::Insert);
+                agent->allocate(tid, total, v_ptr);
+                if (v_ptr == nullptr) {
+                    return {Enums::OpStatus::NoMemory, nullptr};
+                }
+                log->publish(tid, v_entry, v_ptr);
+
+                Memory::RemotePointer rp(v_ptr);
+                auto &connection = agent->get_peer_connection(tid, rp.get_node());
+                auto buf = std::make_unique<byte_t[]>(total);
+                auto &t = KVPair::HillString::make_string(buf.get(), v, v_sz);
+                KVPair::ValueStamp::stamp(&t, version, k, k_sz);
+                // large values do not fit the registered buffer in one write
+                connection->write_chunked(rp.get_as<byte_ptr_t>(), reinterpret_cast<const_byte_ptr_t>(&t), total);
+            }
+
+            // version alone is the stamp of the value
+            VersionGuard _(this->version);
             for (int j = Constants::iNUM_HIGHKEY - 1; j > i; j--) {
                 fingerprints[j] = fingerprints[j - 1];
+                codes[j] = codes[j - 1];
                 keys[j] = keys[j - 1];
                 values[j] = values[j - 1];
                 value_sizes[j] = value_sizes[j - 1];
             }
 
-            auto &ptr = log->make_log(tid, WAL::Enums::Ops::Insert);
-            alloc->allocate(tid, sizeof(KVPair::HillStringHeader) + k_sz, ptr);
+            auto &k_entry = log->make_log(tid, WAL::Enums::Ops::Insert);
+            WAL::PendingEntry k_pending(*log, tid, k_entry);
+            byte_ptr_t ptr;
+            alloc->allocate(tid, KVPair::HillString::object_size_of(k_sz), ptr, &k_pending);
             auto fp = CityHash64(k, k_sz);
             memcpy(ptr, hk, hk->object_size());
+            log->persist(tid, ptr, hk->object_size());
+            // committed before linked, a crash in between leaks the key instead of dangling it
+            log->commit(tid);
             fingerprints[i] = fp;
+            codes[i] = code;
             keys[i] = reinterpret_cast<KVPair::HillString *>(ptr);
             // keys[i] = &KVPair::HillString::make_string(ptr, k, k_sz);
-            log->commit(tid);
 
             // crashing here is ok because valid keys can not find their corresponding values, so just roll
             // the keys
-            auto &v_ptr = log->make_log(tid, WAL::Enums::Ops::Insert);
-            auto total = sizeof(KVPair::HillStringHeader) + v_sz;
-            if (!agent) {
-                alloc->allocate(tid, total, v_ptr);
+            if (v_ptr == nullptr) {
+                auto &v_entry = log->make_log(tid, WAL::Enums::Ops::Insert);
+                WAL::PendingEntry v_pending(*log, tid, v_entry);
+                alloc->allocate(tid, total, v_ptr, &v_pending);
                 memcpy(v_ptr, hv, hv->object_size());
+                KVPair::ValueStamp::stamp(reinterpret_cast<hill_value_t *>(v_ptr), version, k, k_sz);
+                log->persist(tid, v_ptr, total);
+                log->commit(tid);
                 // KVPair::HillString::make_string(v_ptr, v, v_sz);
-                values[i] = Memory::PolymorphicPointer::make_polymorphic_pointer(v_ptr);
-                value_sizes[i] = total;
-            } else {
-                agent->allocate(tid, total, v_ptr);
-                if (v_ptr == nullptr) {
-                    return {Enums::OpStatus::NoMemory, nullptr};
-                }
-                values[i] = Memory::PolymorphicPointer::make_polymorphic_pointer(v_ptr);
-                value_sizes[i] = total;
-                auto &connection = agent->get_peer_connection(tid, values[i].remote_ptr().get_node());
-                auto buf = std::make_unique<byte_t[]>(total);
-
-                Memory::RemotePointer rp(v_ptr);
-                auto &t = KVPair::HillString::make_string(buf.get(), v, v_sz);
-                connection->post_write(rp.get_as<byte_ptr_t>(), t.raw_bytes(), total);
-                connection->poll_completion_once();
             }
-            log->commit(tid);
+            // a value written ahead of the key is committed along with the key
+            values[i] = Memory::PolymorphicPointer::make_polymorphic_pointer(v_ptr);
+            value_sizes[i] = total;
 
             return {Enums::OpStatus::Ok, values[i]};
         }
@@ -99,22 +130,27 @@ namespace Hill {
             std::cout << "\n\n";
         }
 
-        auto InnerNode::insert(const hill_key_t *split_key, PolymorphicNodePointer child) -> Enums::OpStatus {
+        auto InnerNode::insert(const KVPair::KeyCodec &codec, const hill_key_t *split_key, PolymorphicNodePointer child)
+            -> Enums::OpStatus
+        {
             if (is_full()) {
                 return Enums::OpStatus::NeedSplit;
             }
 
+            auto code = codec.encode(split_key->raw_chars(), split_key->size());
             int i;
             for (i = 0; i < Constants::iNUM_HIGHKEY; i++) {
-                if (keys[i] == nullptr || *split_key < *keys[i]) {
+                if (keys[i] == nullptr || codec.compare(codes[i], keys[i], code, split_key->raw_chars(), split_key->size()) > 0) {
                     break;
                 }
             }
 
             for (int j = Constants::iNUM_HIGHKEY - 1; j > i; j--) {
+                codes[j] = codes[j - 1];
                 keys[j] = keys[j - 1];
                 children[j + 1] = children[j];
             }
+            codes[i] = code;
             keys[i] = const_cast<hill_key_t *>(split_key);
             children[i + 1] = child;
             child.set_parent(this);
@@ -162,16 +198,24 @@ namespace Hill {
                            const hill_key_t *hk, const hill_value_t *hv)
             noexcept -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>
         {
+            // failed rather than thrown by the allocator inside a backend
+            if (too_large(k_sz, v_sz)) {
+                return {Enums::OpStatus::Failed, nullptr};
+            }
+
             auto node = traverse_node(k, k_sz);
 
             if (!node->is_full()) {
-                return node->insert(tid, logger, alloc, agent, k, k_sz, v, v_sz, hk, hv);
+                return node->insert(tid, logger, alloc, agent, vlog, codec, ++version, k, k_sz, v, v_sz, hk, hv);
             }
 
+            // readers racing with a split retry, they may be on either side of it
+            VersionGuard _(structure_version);
             auto [new_leaf, value] = split_leaf(tid, node, k, k_sz, v, v_sz, hk, hv);
             // root is a leaf
             if (!node->parent) {
                 auto new_root = InnerNode::make_inner();
+                new_root->codes[0] = new_leaf->codes[0];
                 new_root->keys[0] = new_leaf->keys[0];
                 new_root->children[0] = node;
                 new_root->children[1] = new_leaf;
@@ -188,20 +232,26 @@ namespace Hill {
                                const hill_key_t *hk, const hill_value_t *hv)
             -> std::pair<LeafNode *, Memory::PolymorphicPointer> {
 #ifdef __HILL_PINDEX__
-            auto &ptr = logger->make_log(tid, WAL::Enums::Ops::NodeSplit);
-            alloc->allocate(tid, sizeof(LeafNode), ptr);
+            auto &entry = logger->make_log(tid, WAL::Enums::Ops::NodeSplit);
+            WAL::PendingEntry pending(*logger, tid, entry);
+            byte_ptr_t ptr;
+            alloc->allocate(tid, sizeof(LeafNode), ptr, &pending);
 #else
             auto ptr = new byte_t[sizeof(LeafNode)];
 #endif
             auto n = LeafNode::make_leaf(ptr);
             n->parent = l->parent;
             n->next = l->next;
+#ifdef __HILL_PINDEX__
+            logger->commit(tid);
+#endif
             l->next = n;
             Memory::Util::mfence();
 
+            auto code = codec.encode(k, k_sz);
             int i = 0;
             for (; i < Constants::iNUM_HIGHKEY; i++) {
-                if (l->keys[i]->compare(k, k_sz) > 0) {
+                if (codec.compare(l->codes[i], l->keys[i], code, k, k_sz) > 0) {
                     break;
                 }
             }
@@ -212,6 +262,7 @@ namespace Hill {
             }
             for (int k = split; k < Constants::iNUM_HIGHKEY; k++) {
                 n->fingerprints[k - split] = l->fingerprints[k];
+                n->codes[k - split] = l->codes[k];
                 n->keys[k - split] = l->keys[k];
                 n->values[k - split] = l->values[k];
                 n->value_sizes[k - split] = l->value_sizes[k];
@@ -219,6 +270,7 @@ namespace Hill {
 
             for (int k = split; k < Constants::iNUM_HIGHKEY; k++) {
                 l->fingerprints[k] = 0;
+                l->codes[k] = 0;
                 l->keys[k] = nullptr;
                 l->values[k] = nullptr;
                 l->value_sizes[k] = 0;
@@ -226,9 +278,9 @@ namespace Hill {
 
             Memory::PolymorphicPointer ret_ptr;
             if (i < Constants::iNUM_HIGHKEY / 2) {
-                ret_ptr = l->insert(tid, logger, alloc, agent, k, k_sz, v, v_sz, hk, hv).second;
+                ret_ptr = l->insert(tid, logger, alloc, agent, vlog, codec, ++version, k, k_sz, v, v_sz, hk, hv).second;
             } else {
-                ret_ptr = n->insert(tid, logger, alloc, agent, k, k_sz, v, v_sz, hk, hv).second;
+                ret_ptr = n->insert(tid, logger, alloc, agent, vlog, codec, ++version, k, k_sz, v, v_sz, hk, hv).second;
             }
 
             // Here node split is done in terms of recovery, because inner nodes are reconstructed from
@@ -242,9 +294,10 @@ namespace Hill {
             right->parent = l->parent;
 
             auto split_pos = Constants::iDEGREE / 2;
+            auto code = codec.encode(splitkey->raw_chars(), splitkey->size());
             int i;
             for (i = 0; i < Constants::iNUM_HIGHKEY; i++) {
-                if (*splitkey < *l->keys[i]) {
+                if (codec.compare(l->codes[i], l->keys[i], code, splitkey->raw_chars(), splitkey->size()) > 0) {
                     break;
                 }
             }
@@ -255,6 +308,7 @@ namespace Hill {
                 right->children[0].set_parent(right);
                 int k;
                 for (k = i; k < Constants::iNUM_HIGHKEY; k++) {
+                    right->codes[k - i] = l->codes[k];
                     right->keys[k - i] = l->keys[k];
                     l->keys[k] = nullptr;
                     right->children[k - i + 1] = l->children[k + 1];
@@ -280,6 +334,7 @@ namespace Hill {
                 ret_split_key = l->keys[real_split_pos];
                 int k;
                 for (k = start; k < Constants::iNUM_HIGHKEY; k++) {
+                    right->codes[k - start] = l->codes[k];
                     right->keys[k - start] = l->keys[k];
                     l->keys[k] = nullptr;
                     right->children[k - start] = l->children[k];
@@ -290,7 +345,7 @@ namespace Hill {
                 right->children[k - start].set_parent(right);
                 l->children[k] = nullptr;
                 l->keys[real_split_pos] = nullptr;
-                target->insert(splitkey, child);
+                target->insert(codec, splitkey, child);
             }
             return {right, ret_split_key};
         }
@@ -303,7 +358,7 @@ namespace Hill {
             inner = new_leaf->parent;
             while(inner) {
                 if (!inner->is_full()) {
-                    inner->insert(splitkey, new_node);
+                    inner->insert(codec, splitkey, new_node);
                     new_node.set_parent(inner);
                     return Enums::OpStatus::Ok;
                 } else {
@@ -313,6 +368,7 @@ namespace Hill {
                     // root
                     if (!inner->parent) {
                         auto new_root = InnerNode::make_inner();
+                        new_root->codes[0] = codec.encode(splitkey->raw_chars(), splitkey->size());
                         new_root->keys[0] = splitkey;
                         inner->parent = new_root;
                         new_node.set_parent(new_root);
@@ -338,28 +394,90 @@ namespace Hill {
             return {nullptr, 0};
         }
 
+        auto OLFIT::optimistic_search(const char *k, size_t k_sz) const noexcept
+            -> std::optional<std::pair<Memory::PolymorphicPointer, size_t>>
+        {
+            for (int r = 0; r < Constants::iOPTIMISTIC_RETRIES; r++) {
+                auto structure = structure_version.stable_snapshot(Constants::iOPTIMISTIC_SPINS);
+                auto leaf = optimistic_traverse(k, k_sz, structure);
+                if (leaf == nullptr) {
+                    continue;
+                }
+
+                auto snapshot = leaf->version.stable_snapshot(Constants::iOPTIMISTIC_SPINS);
+                auto i = position_in(leaf, k, k_sz);
+                Memory::PolymorphicPointer value = nullptr;
+                size_t size = 0;
+                if (i != -1) {
+                    value = leaf->values[i];
+                    size = leaf->value_sizes[i];
+                }
+
+                if (leaf->version.validate(snapshot) && structure_version.validate(structure)) {
+                    return std::make_pair(value, size);
+                }
+            }
+            return {};
+        }
+
         auto OLFIT::update(int tid, const char *k, size_t k_sz, const char *v, size_t v_sz)
             noexcept -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>
         {
             auto [leaf, i] = get_pos_of(k, k_sz);
-            if (i == -1) {
+            if (i == -1 || too_large(k_sz, v_sz)) {
                 return {Enums::OpStatus::Failed, nullptr};
             }
 
-            auto &ptr = logger->make_log(tid, WAL::Enums::Ops::Update);
-            auto total = sizeof(KVPair::HillStringHeader) + v_sz;
+            if (vlog && !agent) {
+                auto ptr = vlog->append(tid, k, k_sz, v, v_sz, ++version);
+                if (ptr == nullptr) {
+                    return {Enums::OpStatus::NoMemory, nullptr};
+                }
+                logger->fence(tid);
+
+                auto old = leaf->values[i].get_as<byte_ptr_t>();
+                {
+                    VersionGuard _(leaf->version);
+                    leaf->values[i] = ptr;
+                    leaf->value_sizes[i] = KVPair::ValueStamp::stamped_size_of(v_sz);
+                }
+                reinterpret_cast<hill_value_t *>(old)->invalidate();
+                if (vlog->contains(old)) {
+                    vlog->free(old);
+                } else {
+                    // allocated before the value log is enabled
+                    auto &old_entry = logger->make_log(tid, WAL::Enums::Ops::Delete);
+                    logger->publish(tid, old_entry, old);
+                    alloc->free(tid, old);
+                    logger->commit(tid);
+                }
+                return {Enums::OpStatus::Ok, leaf->values[i]};
+            }
+
+            auto &entry = logger->make_log(tid, WAL::Enums::Ops::Update);
+            auto total = KVPair::ValueStamp::stamped_size_of(v_sz);
+            byte_ptr_t ptr;
             if (!agent) {
-                alloc->allocate(tid, total, ptr);
+                WAL::PendingEntry pending(*logger, tid, entry);
+                alloc->allocate(tid, total, ptr, &pending);
                 if (ptr == nullptr) {
                     return {Enums::OpStatus::NoMemory, nullptr};
                 }
 
-                KVPair::HillString::make_string(ptr, v, v_sz);
-                auto &old = logger->make_log(tid, WAL::Enums::Ops::Delete);
-                old = leaf->values[i].get_as<byte_ptr_t>();
-                leaf->values[i] = ptr;
-                leaf->value_sizes[i] = v_sz;
-                alloc->free(tid, old);
+                auto &t = KVPair::HillString::make_string(ptr, v, v_sz);
+                KVPair::ValueStamp::stamp(&t, ++version, k, k_sz);
+                logger->persist(tid, ptr, total);
+                logger->commit(tid);
+
+                auto &old_entry = logger->make_log(tid, WAL::Enums::Ops::Delete);
+                auto old = leaf->values[i].get_as<byte_ptr_t>();
+                logger->publish(tid, old_entry, old);
+                {
+                    VersionGuard _(leaf->version);
+                    leaf->values[i] = ptr;
+                    leaf->value_sizes[i] = total;
+                }
+                free_local_value(tid, old);
 
                 logger->commit(tid);
             } else {
@@ -367,25 +485,41 @@ namespace Hill {
                 if (ptr == nullptr) {
                     return {Enums::OpStatus::NoMemory, nullptr};
                 }
+                logger->publish(tid, entry, ptr);
 
-                auto &old = logger->make_log(tid, WAL::Enums::Ops::Delete);
-                old = leaf->values[i].remote_ptr().raw_ptr();
+                auto &old_entry = logger->make_log(tid, WAL::Enums::Ops::Delete);
+                auto old = leaf->values[i].remote_ptr().raw_ptr();
+                logger->publish(tid, old_entry, old);
 
                 auto r = leaf->values[i];
-                leaf->values[i] = ptr;
-                leaf->value_sizes[i] = v_sz;
+                {
+                    VersionGuard _(leaf->version);
+                    leaf->values[i] = ptr;
+                    leaf->value_sizes[i] = total;
+                }
 
                 auto &connection = agent->get_peer_connection(tid, leaf->values[i].remote_ptr().get_node());
                 auto buf = std::make_unique<byte_t[]>(total);
                 auto &t = KVPair::HillString::make_string(buf.get(), v, v_sz);
+                KVPair::ValueStamp::stamp(&t, ++version, k, k_sz);
 
                 Memory::RemotePointer rp(ptr);
-                connection->post_write(rp.get_as<byte_ptr_t>(), t.raw_bytes(), total);
-                connection->poll_completion_once() ;
+                // large values do not fit the registered buffer in one write
+                connection->write_chunked(rp.get_as<byte_ptr_t>(), reinterpret_cast<const_byte_ptr_t>(&t), total);
 
                 if (r.is_local()) {
-                    alloc->free(tid, old);
+                    free_local_value(tid, old);
                 } else {
+                    // clients may still read the old value with one-sided reads
+                    KVPair::HillStringHeader invalid {
+                        .valid = 0,
+                        .length = 0,
+                    };
+                    auto &old_connection = agent->get_peer_connection(tid, r.remote_ptr().get_node());
+                    old_connection->post_write(r.get_as<byte_ptr_t>(), reinterpret_cast<uint8_t *>(&invalid),
+                                               sizeof(KVPair::HillStringHeader));
+                    old_connection->poll_completion_once();
+
                     auto remote = r.remote_ptr();
                     agent->free(tid, remote);
                 }
@@ -396,15 +530,38 @@ namespace Hill {
             return {Enums::OpStatus::Ok, leaf->values[i]};
         }
 
+        auto OLFIT::read(int tid, const char *k, size_t k_sz) noexcept -> std::optional<std::string> {
+            auto [v, v_sz] = search(k, k_sz);
+            if (v == nullptr) {
+                return {};
+            }
+
+            if (v.is_local()) {
+                auto value = v.get_as<hill_value_t *>();
+                return std::string(value->raw_chars(), value->size());
+            }
+
+            auto buf = std::make_unique<byte_t[]>(v_sz);
+            auto &connection = agent->get_peer_connection(tid, v.remote_ptr().get_node());
+            if (connection->read_chunked(v.get_as<byte_ptr_t>(), v_sz, buf.get()).first != RDMAUtil::Status::Ok) {
+                return {};
+            }
+            auto value = reinterpret_cast<hill_value_t *>(buf.get());
+            return std::string(value->raw_chars(), value->size());
+        }
+
         auto OLFIT::remove(int tid, const char *k, size_t k_sz) noexcept -> Enums::OpStatus {
             auto [leaf, i] = get_pos_of(k, k_sz);
             if (i == -1) {
                 return Enums::OpStatus::Failed;
             }
 
+            // the key is freed in place, readers that may have seen it retry
+            VersionGuard _(leaf->version);
             if (leaf->values[i].is_remote()) {
-                auto &ptr = logger->make_log(tid, WAL::Enums::Ops::Delete);
-                ptr = reinterpret_cast<byte_ptr_t>(leaf->keys[i]);
+                auto &entry = logger->make_log(tid, WAL::Enums::Ops::Delete);
+                auto ptr = reinterpret_cast<byte_ptr_t>(leaf->keys[i]);
+                logger->publish(tid, entry, ptr);
                 // we only need to remember the key here because leaf node is a natural log recording both key and value
                 leaf->keys[i]->invalidate();
 
@@ -421,30 +578,46 @@ namespace Hill {
                 leaf->keys[i]->invalidate();
                 alloc->free(tid, ptr);
             } else {
-                auto &ptr = logger->make_log(tid, WAL::Enums::Ops::Delete);
-                ptr = reinterpret_cast<byte_ptr_t>(leaf->keys[i]);
+                auto &entry = logger->make_log(tid, WAL::Enums::Ops::Delete);
+                auto ptr = reinterpret_cast<byte_ptr_t>(leaf->keys[i]);
+                logger->publish(tid, entry, ptr);
                 auto vp = reinterpret_cast<byte_ptr_t>(leaf->values[i].local_ptr());
                 leaf->values[i].get_as<KVPair::HillString *>()->invalidate();
                 leaf->keys[i]->invalidate();
-                alloc->free(tid, vp);
+                free_local_value(tid, vp);
                 alloc->free(tid, ptr);
             }
             logger->commit(tid);
             return Enums::OpStatus::Ok;
         }
 
+        auto OLFIT::relocate(const char *k, size_t k_sz, const byte_ptr_t &old, const byte_ptr_t &copy) noexcept -> bool {
+            auto [leaf, i] = get_pos_of(k, k_sz);
+            if (i == -1 || !leaf->values[i].is_local() || leaf->values[i].get_as<byte_ptr_t>() != old) {
+                return false;
+            }
+
+            {
+                VersionGuard _(leaf->version);
+                leaf->values[i] = copy;
+            }
+            Memory::Util::flush(&leaf->values[i], sizeof(Memory::PolymorphicPointer));
+            return true;
+        }
+
         auto OLFIT::scan(const char *k, size_t k_sz, size_t num) -> std::vector<ScanHolder> {
             std::vector<ScanHolder> ret;
             ret.reserve(num);
 
             auto leaf = traverse_node(k, k_sz);
+            auto code = codec.encode(k, k_sz);
             auto cursor = 0;
             for (; cursor < Constants::iNUM_HIGHKEY; cursor++) {
                 if (leaf->keys[cursor] == nullptr) {
                     leaf = leaf->next;
                     break;
                 }
-                if (leaf->keys[cursor]->compare(k, k_sz) >= 0)
+                if (codec.compare(leaf->codes[cursor], leaf->keys[cursor], code, k, k_sz) >= 0)
                     break;
             }
 
@@ -452,7 +625,8 @@ namespace Hill {
                 for (; cursor < Constants::iNUM_HIGHKEY && num > 0; cursor++) {
                     if (leaf->keys[cursor] == nullptr)
                         break;
-                    ret.emplace_back(leaf->keys[cursor], leaf->values[cursor]);
+                    ret.emplace_back(leaf->keys[cursor], leaf->codes[cursor], leaf->values[cursor],
+                                     leaf->value_sizes[cursor]);
                     --num;
                 }
 
@@ -3,6 +3,7 @@
 #include "memory_manager/memory_manager.hpp"
 #include "remote_memory/remote_memory.hpp"
 #include "wal/wal.hpp"
+#include "value_log/value_log.hpp"
 #include "kv_pair/kv_pair.hpp"
 #include "misc/misc.hpp"
 #include "coloring/coloring.hpp"
@@ -26,6 +27,10 @@ namespace Hill {
             static constexpr int iDEGREE = 16;
             static constexpr int iNUM_HIGHKEY = iDEGREE - 1;
 #endif
+            // optimistic reads give up after this many conflicts with the owner
+            static constexpr int iOPTIMISTIC_RETRIES = 8;
+            // how long an optimistic read waits for an ongoing write before counting a conflict
+            static constexpr int iOPTIMISTIC_SPINS = 1024;
         }
 
         namespace Enums {
@@ -46,15 +51,78 @@ namespace Hill {
             };
         }
 
+        /*
+         * Version of a node as in OLFIT. Only the owner thread of an index writes, so there is no
+         * latch, a write just makes the version odd and then even again. Readers on other threads
+         * take a snapshot, read and then validate that the version is even and unchanged
+         */
+        struct NodeVersion {
+            std::atomic_uint64_t word;
+
+            inline auto reset() noexcept -> void {
+                word.store(0, std::memory_order_relaxed);
+            }
+
+            inline auto begin_write() noexcept -> void {
+                word.store(word.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+
+            inline auto end_write() noexcept -> void {
+                word.store(word.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            inline auto snapshot() const noexcept -> uint64_t {
+                return word.load(std::memory_order_acquire);
+            }
+
+            // wait a while for an ongoing write, the result may still be odd
+            inline auto stable_snapshot(int spins) const noexcept -> uint64_t {
+                auto ret = snapshot();
+                while ((ret & 1) && spins-- > 0) {
+                    asm volatile("pause":::"memory");
+                    ret = snapshot();
+                }
+                return ret;
+            }
+
+            inline auto validate(uint64_t snap) const noexcept -> bool {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return (snap & 1) == 0 && word.load(std::memory_order_relaxed) == snap;
+            }
+        };
+
+        // a node is being written during the lifetime of a guard
+        class VersionGuard {
+        public:
+            VersionGuard(NodeVersion &v) : version(v) {
+                version.begin_write();
+            }
+            ~VersionGuard() {
+                version.end_write();
+            }
+            VersionGuard(const VersionGuard &) = delete;
+            VersionGuard(VersionGuard &&) = delete;
+            auto operator=(const VersionGuard &) -> VersionGuard & = delete;
+            auto operator=(VersionGuard &&) -> VersionGuard & = delete;
+
+        private:
+            NodeVersion &version;
+        };
+
         // these two structure has similar memory layout for runtime polymorphism, change it with caution
         struct InnerNode;
         struct LeafNode {
             InnerNode *parent;
             uint64_t fingerprints[Constants::iNUM_HIGHKEY];
+            // see KVPair::KeyCodec, ordering is mostly decided without touching keys
+            uint64_t codes[Constants::iNUM_HIGHKEY];
             hill_key_t *keys[Constants::iNUM_HIGHKEY];
             Memory::PolymorphicPointer values[Constants::iNUM_HIGHKEY];
             size_t value_sizes[Constants::iNUM_HIGHKEY];
             LeafNode *next;
+            // guards slots of this leaf, splits are guarded by the structure version of the tree
+            NodeVersion version;
 
             LeafNode() = delete;
             // All nodes are on PM, not in heap or stack
@@ -71,9 +139,11 @@ namespace Hill {
                     tmp->values[i] = nullptr;
                     tmp->value_sizes[i] = 0;
                     tmp->fingerprints[i] = 0;
+                    tmp->codes[i] = 0;
                 }
                 tmp->parent = nullptr;
                 tmp->next = nullptr;
+                tmp->version.reset();
                 return tmp;
             }
 
@@ -82,6 +152,7 @@ namespace Hill {
             }
 
             auto insert(int tid, WAL::Logger *log, Memory::Allocator *alloc, Memory::RemoteMemoryAgent *agent,
+                        ValueLog::ValueLog *vlog, const KVPair::KeyCodec &codec, uint32_t version,
                         const char *k, size_t k_sz, const char *v, size_t v_sz,
                         const hill_key_t *hk, const hill_value_t *hv)
                 -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>;
@@ -161,6 +232,7 @@ namespace Hill {
          */
         struct InnerNode {
             InnerNode *parent;
+            uint64_t codes[Constants::iNUM_HIGHKEY];
             hill_key_t *keys[Constants::iNUM_HIGHKEY];
             PolymorphicNodePointer children[Constants::iDEGREE];
 
@@ -175,6 +247,7 @@ namespace Hill {
             static auto make_inner() -> InnerNode * {
                 auto tmp = new InnerNode;
                 for (int i = 0; i < Constants::iNUM_HIGHKEY; i++) {
+                    tmp->codes[i] = 0;
                     tmp->keys[i] = nullptr;
                     tmp->children[i] = nullptr;
                 }
@@ -188,15 +261,25 @@ namespace Hill {
             }
 
             // this child should be on the right of split_key
-            auto insert(const hill_key_t *split_key, PolymorphicNodePointer child) -> Enums::OpStatus;
+            auto insert(const KVPair::KeyCodec &codec, const hill_key_t *split_key, PolymorphicNodePointer child)
+                -> Enums::OpStatus;
             auto dump() const noexcept -> void;
         };
 
         struct ScanHolder {
             KVPair::HillString *key;
+            // copied from the leaf so that merging rarely dereferences keys
+            uint64_t code;
             Memory::PolymorphicPointer value_ptr;
+            // stamped size of the value, as recorded in the leaf
+            size_t value_size;
+
+            ScanHolder(KVPair::HillString *k, uint64_t c, Memory::PolymorphicPointer &p, size_t sz = 0)
+                : key(k), code(c), value_ptr(p), value_size(sz) {};
 
-            ScanHolder(KVPair::HillString *k, Memory::PolymorphicPointer &p) : key(k), value_ptr(p) {};
+            inline auto compare(const ScanHolder &rhs, const KVPair::KeyCodec &codec) const noexcept -> int {
+                return codec.compare(code, key, rhs.code, rhs.key->raw_chars(), rhs.key->size());
+            }
             ~ScanHolder() = default;
             ScanHolder(const ScanHolder &) = default;
             ScanHolder(ScanHolder &&) = default;
@@ -208,11 +291,13 @@ namespace Hill {
         public:
             // for convenience of testing
             OLFIT(int tid, Memory::Allocator *alloc_, WAL::Logger *logger_)
-                : root(nullptr), alloc(alloc_), logger(logger_), agent(nullptr) {
+                : root(nullptr), alloc(alloc_), logger(logger_), agent(nullptr), vlog(nullptr), version(0) {
                 // NodeSplit is also for new root node creation
-                auto &ptr = logger->make_log(tid, WAL::Enums::Ops::NodeSplit);
+                auto &entry = logger->make_log(tid, WAL::Enums::Ops::NodeSplit);
                 // crashing here is ok, because no memory allocation is done;
-                alloc->allocate(tid, sizeof(LeafNode), ptr);
+                WAL::PendingEntry pending(*logger, tid, entry);
+                byte_ptr_t ptr;
+                alloc->allocate(tid, sizeof(LeafNode), ptr, &pending);
                 /*
                  * crash here is ok, allocation is done. Crash in the allocation function
                  * is fine because on recovery, the allocator scans memory regions to restore
@@ -256,9 +341,17 @@ namespace Hill {
                 noexcept -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>;
             
             auto search(const char *k, size_t k_sz) const noexcept -> std::pair<Memory::PolymorphicPointer, size_t>;
+            /*
+             * The same as search, but safe to call from threads other than the owner. Returns
+             * nothing if the owner keeps modifying what is read, then the caller should ask the owner
+             */
+            auto optimistic_search(const char *k, size_t k_sz) const noexcept
+                -> std::optional<std::pair<Memory::PolymorphicPointer, size_t>>;
             auto update(int tid, const char *k, size_t k_sz, const char *v, size_t v_sz)
                 noexcept -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>;
             auto remove(int tid, const char *k, size_t k_sz) noexcept -> Enums::OpStatus;
+            // copy the value of k, a remote value is read by the agent. Only for the owner thread
+            auto read(int tid, const char *k, size_t k_sz) noexcept -> std::optional<std::string>;
             auto scan(const char *k, size_t k_sz, size_t num) -> std::vector<ScanHolder>;
             
             inline auto get_root() const noexcept -> PolymorphicNodePointer {
@@ -268,6 +361,23 @@ namespace Hill {
             inline auto enable_agent(Memory::RemoteMemoryAgent *agent_) -> void {
                 agent = agent_;
             }
+
+            // local values are appended to vlog afterwards, values allocated before are still valid
+            inline auto enable_value_log(ValueLog::ValueLog *vlog_) -> void {
+                vlog = vlog_;
+            }
+
+            // should be called before any insertion, codes of different codecs are not comparable
+            inline auto enable_key_codec(const KVPair::KeyCodec &codec_) -> void {
+                codec = codec_;
+            }
+
+            inline auto get_key_codec() const noexcept -> const KVPair::KeyCodec & {
+                return codec;
+            }
+
+            // point k to the copy of its value made by the value log cleaner, see ValueLog::clean
+            auto relocate(const char *k, size_t k_sz, const byte_ptr_t &old, const byte_ptr_t &copy) noexcept -> bool;
             auto dump() const noexcept -> void;
 
         private:
@@ -275,6 +385,29 @@ namespace Hill {
             Memory::Allocator *alloc;
             WAL::Logger *logger;
             Memory::RemoteMemoryAgent *agent;
+            ValueLog::ValueLog *vlog;
+            KVPair::KeyCodec codec;
+            // stamps of values written by this index, only the owner thread modifies an index
+            uint32_t version;
+            // odd while nodes are split, i.e., while inner nodes and the root are modified
+            NodeVersion structure_version;
+
+            // keys and local values are allocated in pages, remote memory and the value log hold larger values
+            inline auto too_large(size_t k_sz, size_t v_sz) const noexcept -> bool {
+                constexpr auto max = Memory::Allocator::max_allocation();
+                return KVPair::HillString::object_size_of(k_sz) > max ||
+                    (!agent && !vlog && KVPair::ValueStamp::stamped_size_of(v_sz) > max);
+            }
+
+            // readers holding ptr fail validation once it is invalidated, see KVPair::ValueStamp
+            inline auto free_local_value(int tid, byte_ptr_t &ptr) -> void {
+                reinterpret_cast<hill_value_t *>(ptr)->invalidate();
+                if (vlog && vlog->contains(ptr)) {
+                    vlog->free(ptr);
+                } else {
+                    alloc->free(tid, ptr);
+                }
+            }
 
             auto traverse_node(const char *k, size_t k_sz) const noexcept -> LeafNode * {
                 if (root.is_leaf()) {
@@ -292,34 +425,68 @@ namespace Hill {
                 return current.get_as<LeafNode *>();
             }
 
+            /*
+             * Descend as traverse_node, but a child is followed only if the structure is unchanged
+             * since snapshot, so that a torn pointer is never dereferenced. Returns nullptr on conflicts
+             */
+            auto optimistic_traverse(const char *k, size_t k_sz, uint64_t snapshot) const noexcept -> LeafNode * {
+                PolymorphicNodePointer current = root;
+                while (!current.is_leaf()) {
+                    if (!structure_version.validate(snapshot) || current.is_null()) {
+                        return nullptr;
+                    }
+                    current = find_next(current.get_as<InnerNode *>(), k, k_sz);
+                }
+                return structure_version.validate(snapshot) ? current.get_as<LeafNode *>() : nullptr;
+            }
+
             auto get_pos_of(const char *k, size_t k_sz) const noexcept -> std::pair<LeafNode *, int> {
                 auto leaf = traverse_node(k, k_sz);
+                return {leaf, position_in(leaf, k, k_sz)};
+            }
+
+            // each slot is read once, thus it is also safe for optimistic readers
+            auto position_in(const LeafNode *leaf, const char *k, size_t k_sz) const noexcept -> int {
+                // exact codes identify keys, neither hashing nor key bodies are needed
+                if (auto code = codec.encode(k, k_sz); codec.is_exact(code)) {
+                    for (int i = 0; i < Constants::iNUM_HIGHKEY; i++) {
+                        if (leaf->keys[i] == nullptr) {
+                            return -1;
+                        }
+
+                        if (leaf->codes[i] == code) {
+                            return i;
+                        }
+                    }
+                    return -1;
+                }
+
                 auto fp = CityHash64(k, k_sz);
-                int i = 0;
-                for (i = 0; i < Constants::iNUM_HIGHKEY; i++) {
-                    if (leaf->keys[i] == nullptr) {
-                        return {leaf, -1};
+                for (int i = 0; i < Constants::iNUM_HIGHKEY; i++) {
+                    auto key = leaf->keys[i];
+                    if (key == nullptr) {
+                        return -1;
                     }
 
                     if (leaf->fingerprints[i] != fp) {
                         continue;
                     }
 
-                    if (leaf->keys[i]->compare(k, k_sz) == 0) {
-                        return {leaf, i};
+                    if (key->compare(k, k_sz) == 0) {
+                        return i;
                     }
                 }
-                return {nullptr, -1};
+                return -1;
             }
 
             // follow the original paper of OLFIT, OT
             auto find_next(InnerNode *current, const char *k, size_t k_sz) const noexcept -> PolymorphicNodePointer {
-                PolymorphicNodePointer ret;
+                auto code = codec.encode(k, k_sz);
                 hill_key_t *tmp = nullptr;
                 int i;
                 for (i = 0; i < Constants::iNUM_HIGHKEY; i++) {
                     tmp = current->keys[i];
-                    if (tmp == nullptr || tmp->compare(k, k_sz) > 0) {
+                    if (tmp == nullptr || codec.compare(current->codes[i], tmp, code, k, k_sz) > 0) {
                             return current->children[i];                                
                     }
                 }
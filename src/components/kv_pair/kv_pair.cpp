@@ -1 +1,128 @@
 #include "kv_pair.hpp"
+
+#include <nmmintrin.h>
+
+namespace Hill {
+    namespace KVPair {
+        namespace {
+            // software fallback, reflected polynomial 0x82f63b78
+            struct CRC32CTable {
+                uint32_t entries[256];
+
+                CRC32CTable() {
+                    for (uint32_t i = 0; i < 256; i++) {
+                        uint32_t c = i;
+                        for (int j = 0; j < 8; j++) {
+                            c = (c >> 1) ^ ((c & 1) ? 0x82f63b78U : 0);
+                        }
+                        entries[i] = c;
+                    }
+                }
+            };
+            const CRC32CTable crc32c_table;
+
+            auto crc32c_software(uint32_t crc, const uint8_t *bytes, size_t size) noexcept -> uint32_t {
+                for (size_t i = 0; i < size; i++) {
+                    crc = crc32c_table.entries[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+                }
+                return crc;
+            }
+
+            __attribute__((target("sse4.2")))
+            auto crc32c_hardware(uint32_t crc, const uint8_t *bytes, size_t size) noexcept -> uint32_t {
+                uint64_t c = crc;
+                for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+                    uint64_t word;
+                    memcpy(&word, bytes, sizeof(word));
+                    c = _mm_crc32_u64(c, word);
+                }
+
+                for (; size > 0; --size, ++bytes) {
+                    c = _mm_crc32_u8(c, *bytes);
+                }
+                return c;
+            }
+        }
+
+        auto ValueStamp::crc32c(uint32_t crc, const void *bytes, size_t size) noexcept -> uint32_t {
+            static const bool hardware = __builtin_cpu_supports("sse4.2");
+            auto b = reinterpret_cast<const uint8_t *>(bytes);
+            return hardware ? crc32c_hardware(crc, b, size) : crc32c_software(crc, b, size);
+        }
+
+        auto ValueStamp::checksum_of(uint32_t version, const char *k, size_t k_sz, const void *header, size_t h_sz,
+                                     const void *content, size_t c_sz) noexcept -> uint32_t
+        {
+            auto crc = crc32c(~0U, &version, sizeof(version));
+            crc = crc32c(crc, k, k_sz);
+            crc = crc32c(crc, header, h_sz);
+            return ~crc32c(crc, content, c_sz);
+        }
+
+        auto ValueStamp::validate(const_byte_ptr_t bytes, size_t len, const char *k, size_t k_sz) noexcept -> bool {
+            if (len < HillString::object_size_of(0) + sizeof(ValueStamp)) {
+                return false;
+            }
+
+            auto value = reinterpret_cast<const HillString *>(bytes);
+            // the extended length is only there if the header says so
+            if (!value->is_valid() || (value->is_extended() && len < HillString::object_size_of(Constants::uEXTENDED_LENGTH))) {
+                return false;
+            }
+
+            if (value->object_size() + sizeof(ValueStamp) > len) {
+                return false;
+            }
+
+            ValueStamp stamp;
+            memcpy(&stamp, bytes + value->object_size(), sizeof(stamp));
+            return stamp.checksum == checksum_of(stamp.version, k, k_sz, value);
+        }
+
+        auto KeyCodec::detect(const std::vector<std::string> &samples) -> KeyCodec {
+            if (samples.empty()) {
+                return KeyCodec();
+            }
+
+            auto common = samples[0].size();
+            for (auto &s : samples) {
+                common = std::min(common, s.size());
+                for (size_t i = 0; i < common; i++) {
+                    if (s[i] != samples[0][i]) {
+                        common = i;
+                        break;
+                    }
+                }
+            }
+
+            // digits shared by all samples belong to the numeric part, e.g., user1000 and user1001
+            while (common > 0 && isdigit(samples[0][common - 1])) {
+                --common;
+            }
+
+            auto ret = make_numeric_codec(samples[0].substr(0, common));
+            for (auto &s : samples) {
+                if (ret.encode(s.c_str(), s.size()) == 0) {
+                    return KeyCodec();
+                }
+            }
+            return ret;
+        }
+
+        auto KeyCodec::decode(uint64_t code) const -> std::string {
+            if (!numeric || code == 0) {
+                return "";
+            }
+
+            auto ret = prefix;
+            auto rank = code - 1;
+            for (size_t i = 0; i < Constants::uMAX_CODED_DIGITS && rank != 0; i++) {
+                rank -= 1;
+                auto block = Constants::uSHORTER_THAN[Constants::uMAX_CODED_DIGITS - i];
+                ret.push_back('0' + rank / block);
+                rank %= block;
+            }
+            return ret;
+        }
+    }
+}
@@ -2,11 +2,28 @@
 #define __HILL__KV_PAIR__KV_PAIR__
 #include "memory_manager/memory_manager.hpp"
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace Hill {
     namespace KVPair {
         using namespace ::Hill::Memory::TypeAliases;
 
+        namespace Constants {
+            // digit strings of at most this many digits are ranked within 64 bits
+            static constexpr size_t uMAX_CODED_DIGITS = 19;
+            // number of digit strings shorter than n digits, including the empty one
+            static constexpr uint64_t uSHORTER_THAN[uMAX_CODED_DIGITS + 1] = {
+                0UL, 1UL, 11UL, 111UL, 1111UL, 11111UL, 111111UL, 1111111UL, 11111111UL, 111111111UL,
+                1111111111UL, 11111111111UL, 111111111111UL, 1111111111111UL, 11111111111111UL,
+                111111111111111UL, 1111111111111111UL, 11111111111111111UL, 111111111111111111UL,
+                1111111111111111111UL,
+            };
+            // a header of this length is followed by a 32-bit length, for values of 32KB or more
+            static constexpr size_t uEXTENDED_LENGTH = 0x7fff;
+            static constexpr size_t uMAX_STRING_SIZE = UINT32_MAX;
+        }
+
         struct HillString;
         namespace TypeAliases {
             using hill_key_t = HillString;
@@ -21,17 +38,51 @@ namespace Hill {
         /*
          * This is a simple compact string implementation
          * The length field should be copied to the index to avoid unnecessary PM accesses
+         *
+         * Strings of uEXTENDED_LENGTH bytes or more are extended, the 15-bit length is set to
+         * uEXTENDED_LENGTH and the real length is stored as a uint32_t before the content
          */
         struct HillString {
             HillStringHeader header;
             // not [0] so no warning. 
             byte_t content[1];
 
-            static auto make_string(const byte_ptr_t &chunk, const_byte_ptr_t bytes, size_t size) -> HillString & {
+            static inline auto is_extended_size(size_t size) noexcept -> bool {
+                return size >= Constants::uEXTENDED_LENGTH;
+            }
+
+            static inline auto header_size_of(size_t size) noexcept -> size_t {
+                return sizeof(HillStringHeader) + (is_extended_size(size) ? sizeof(uint32_t) : 0);
+            }
+
+            // bytes to allocate for a string of given size
+            static inline auto object_size_of(size_t size) noexcept -> size_t {
+                return header_size_of(size) + size;
+            }
+
+            /*
+             * Write only the header of a string of given size to chunk, returns the header size.
+             * Content should be written right after the returned size
+             */
+            static auto make_header(const byte_ptr_t &chunk, size_t size) noexcept -> size_t {
                 auto ret = reinterpret_cast<HillString *>(chunk);
-                ret->header.length = size;
-                memcpy(&ret->content, bytes, size);
                 ret->header.valid = 1;
+                if (!is_extended_size(size)) {
+                    ret->header.length = size;
+                    return sizeof(HillStringHeader);
+                }
+
+                ret->header.length = Constants::uEXTENDED_LENGTH;
+                uint32_t extended = size;
+                memcpy(&ret->content, &extended, sizeof(extended));
+                return sizeof(HillStringHeader) + sizeof(uint32_t);
+            }
+
+            static auto make_string(const byte_ptr_t &chunk, const_byte_ptr_t bytes, size_t size) -> HillString & {
+                auto ret = reinterpret_cast<HillString *>(chunk);
+                ret->header.valid = 0;
+                memcpy(chunk + header_size_of(size), bytes, size);
+                make_header(chunk, size);
                 return *ret;
             }
 
@@ -39,86 +90,73 @@ namespace Hill {
                 return make_string(chunk, reinterpret_cast<const_byte_ptr_t>(bytes), size);
             }
 
-            auto compare(const char *rhs, size_t r_sz) const noexcept -> int {
-                auto chars = raw_chars();
-                auto bound = std::min(size(), r_sz);
-                if (auto ret = strncmp(chars, rhs, bound); ret != 0) {
+            /*
+             * Keys are binary safe, thus memcmp instead of strncmp. Shorter keys are smaller on
+             * a tie of common bytes
+             */
+            static inline auto compare(const char *lhs, size_t l_sz, const char *rhs, size_t r_sz) noexcept -> int {
+                if (auto ret = memcmp(lhs, rhs, std::min(l_sz, r_sz)); ret != 0) {
                     return ret;
-                } else {
-                    return size() - r_sz;
                 }
+                return (l_sz > r_sz) - (l_sz < r_sz);
             }
 
-            auto operator==(const HillString &rhs) const noexcept -> bool {
-                if (header.length != rhs.header.length) {
-                    return false;
-                }
-                
-                for (size_t i = 0; i < header.length; i++) {
-                    if (content[i] != rhs.content[i]) {
-                        return false;                        
-                    }
+            /*
+             * The first 8 bytes of a key packed in big endian and padded with 0, so comparing two
+             * prefixes as integers agrees with comparing the keys whenever the prefixes differ.
+             * Equal prefixes tell nothing, the key bodies have to be compared
+             */
+            static inline auto prefix_of(const char *bytes, size_t size) noexcept -> uint64_t {
+                uint64_t ret = 0;
+                memcpy(&ret, bytes, std::min(size, sizeof(uint64_t)));
+                return __builtin_bswap64(ret);
+            }
+
+            // compare two keys whose prefixes are known, the body of lhs is only touched on a tie
+            static inline auto compare(uint64_t l_prefix, const HillString *lhs,
+                                       uint64_t r_prefix, const char *rhs, size_t r_sz) noexcept -> int
+            {
+                if (l_prefix != r_prefix) {
+                    return l_prefix < r_prefix ? -1 : 1;
                 }
-                return true;
+                return compare(lhs->raw_chars(), lhs->size(), rhs, r_sz);
             }
 
-            auto operator!=(const HillString &rhs) const noexcept -> bool {
-                return !(*this == rhs);
+            auto compare(const char *rhs, size_t r_sz) const noexcept -> int {
+                return compare(raw_chars(), size(), rhs, r_sz);
             }
 
-            auto operator<(const HillString &rhs) const noexcept -> bool {
-                for (size_t i = 0; i < std::min(header.length, rhs.header.length); i++) {
-                    if (content[i] > rhs.content[i]) {
-                        return false;
-                    }
+            auto compare(const HillString &rhs) const noexcept -> int {
+                return compare(raw_chars(), size(), rhs.raw_chars(), rhs.size());
+            }
 
-                    if (content[i] < rhs.content[i]) {
-                        return true;
-                    }
-                }
+            inline auto prefix() const noexcept -> uint64_t {
+                return prefix_of(raw_chars(), size());
+            }
 
-                return header.length < rhs.header.length;
+            auto operator==(const HillString &rhs) const noexcept -> bool {
+                return size() == rhs.size() && memcmp(raw_bytes(), rhs.raw_bytes(), size()) == 0;
             }
 
-            auto operator>(const HillString &rhs) const noexcept -> bool {
-                for (size_t i = 0; i < std::min(header.length, rhs.header.length); i++) {
-                    if (content[i] > rhs.content[i]) {
-                        return true;
-                    }
+            auto operator!=(const HillString &rhs) const noexcept -> bool {
+                return !(*this == rhs);
+            }
 
-                    if (content[i] < rhs.content[i]) {
-                        return false;
-                    }
-                }
+            auto operator<(const HillString &rhs) const noexcept -> bool {
+                return compare(rhs) < 0;
+            }
 
-                return header.length > rhs.header.length;
+            auto operator>(const HillString &rhs) const noexcept -> bool {
+                return compare(rhs) > 0;
             }
 
             auto operator<=(const HillString &rhs) const noexcept -> bool {
-                for (size_t i = 0; i < std::min(header.length, rhs.header.length); i++) {
-                    if (content[i] < rhs.content[i]) {
-                        return true;
-                    }
-                    
-                    if (content[i] > rhs.content[i]) {
-                        return false;
-                    }
-                }
-                return header.length <= rhs.header.length;
+                return compare(rhs) <= 0;
             }
 
             auto operator>=(const HillString &rhs) const noexcept -> bool {
-                for (size_t i = 0; i < std::min(header.length, rhs.header.length); i++) {
-                    if (content[i] > rhs.content[i]) {
-                        return true;
-                    }
-                    
-                    if (content[i] < rhs.content[i]) {
-                        return false;
-                    }
-                }
-                return header.length >= rhs.header.length;
-            }            
+                return compare(rhs) >= 0;
+            }
 
             inline auto is_valid() const noexcept -> bool {
                 return header.valid;
@@ -132,12 +170,16 @@ namespace Hill {
                 header.valid = 0;
             }
 
+            inline auto is_extended() const noexcept -> bool {
+                return header.length == Constants::uEXTENDED_LENGTH;
+            }
+
             inline auto raw_bytes() const noexcept -> const_byte_ptr_t {
-                return &content[0];
+                return is_extended() ? &content[sizeof(uint32_t)] : &content[0];
             }
 
             inline auto raw_chars() const noexcept -> const char * {
-                return reinterpret_cast<const char *>(&content[0]);
+                return reinterpret_cast<const char *>(raw_bytes());
             }
 
             inline auto to_string() const noexcept -> std::string {
@@ -145,18 +187,32 @@ namespace Hill {
             }
 
             inline auto size() const noexcept -> size_t {
-                return header.length;
+                if (!is_extended()) {
+                    return header.length;
+                }
+
+                uint32_t extended;
+                memcpy(&extended, &content, sizeof(extended));
+                return extended;
             }
 
             // size of the whole HillString object including header and all content
             inline auto object_size() const noexcept -> size_t {
-                return header.length + sizeof(header);
+                return size() + sizeof(header) + (is_extended() ? sizeof(uint32_t) : 0);
             }
 
+            // an extended string stays extended when shrunk so that its content does not move
             inline auto inplace_update(const_byte_ptr_t bytes, size_t size) noexcept -> bool {
-                if (size > header.length)
+                if (size > this->size())
                     return false;
 
+                if (is_extended()) {
+                    uint32_t extended = size;
+                    memcpy(&content[sizeof(uint32_t)], bytes, size);
+                    memcpy(&content, &extended, sizeof(extended));
+                    return true;
+                }
+
                 memcpy(&content, bytes, size);
                 header.length = size;
                 return true;
@@ -172,6 +228,143 @@ namespace Hill {
             auto operator=(const HillString &) = delete;
             auto operator=(HillString &&) = delete;
         };
+
+        /*
+         * A stored value is followed by a stamp so that a value fetched by a one-sided RDMA read
+         * can be validated without the server CPU.
+         * | HillString | ValueStamp |
+         *
+         * Updates are out-of-place and a freed value is invalidated, yet a client holding a cached
+         * pointer may still read a chunk that is being reused. The checksum is a CRC32C over the
+         * version, the key and the value, so a torn value or a value of another key fails validation
+         */
+        struct ValueStamp {
+            uint32_t version;
+            uint32_t checksum;
+
+            // bytes to allocate for a stamped value of given size
+            static inline auto stamped_size_of(size_t v_sz) noexcept -> size_t {
+                return HillString::object_size_of(v_sz) + sizeof(ValueStamp);
+            }
+
+            static inline auto of(const HillString *value) noexcept -> ValueStamp * {
+                return reinterpret_cast<ValueStamp *>(reinterpret_cast<uint64_t>(value) + value->object_size());
+            }
+
+            static auto crc32c(uint32_t crc, const void *bytes, size_t size) noexcept -> uint32_t;
+            // the value is given as its header and its content in case they are not contiguous yet
+            static auto checksum_of(uint32_t version, const char *k, size_t k_sz, const void *header, size_t h_sz,
+                                    const void *content, size_t c_sz) noexcept -> uint32_t;
+
+            static inline auto checksum_of(uint32_t version, const char *k, size_t k_sz, const HillString *value)
+                noexcept -> uint32_t
+            {
+                auto h_sz = value->object_size() - value->size();
+                return checksum_of(version, k, k_sz, value, h_sz, value->raw_bytes(), value->size());
+            }
+
+            // the stamp is written right after the value, the caller persists the stamped size
+            static auto stamp(HillString *value, uint32_t version, const char *k, size_t k_sz) noexcept
+                -> ValueStamp &
+            {
+                auto ret = of(value);
+                ret->version = version;
+                ret->checksum = checksum_of(version, k, k_sz, value);
+                return *ret;
+            }
+
+            /*
+             * Validate len bytes read from a value pointer. False if the value is invalidated, torn,
+             * longer than what is read, or not of key k
+             */
+            static auto validate(const_byte_ptr_t bytes, size_t len, const char *k, size_t k_sz) noexcept -> bool;
+        };
+
+        /*
+         * A key codec maps a key to an 8-byte code kept next to the key pointer in index nodes.
+         *
+         * The default codec uses HillString::prefix_of, so codes only order keys when they differ.
+         * A numeric codec targets keys made of a fixed prefix and at most uMAX_CODED_DIGITS decimal
+         * digits, e.g., YCSB keys. Such a key is coded as 1 + the rank of its digits among all digit
+         * strings of bounded length in byte order, thus two coded keys are compared by their codes
+         * alone and equal codes mean equal keys. Other keys are coded as 0 and compared in full.
+         *
+         * Codes of different codecs are not comparable, an index uses one codec for its lifetime.
+         */
+        class KeyCodec {
+        public:
+            KeyCodec() : numeric(false) {};
+            ~KeyCodec() = default;
+            KeyCodec(const KeyCodec &) = default;
+            KeyCodec(KeyCodec &&) = default;
+            auto operator=(const KeyCodec &) -> KeyCodec & = default;
+            auto operator=(KeyCodec &&) -> KeyCodec & = default;
+
+            static auto make_numeric_codec(const std::string &prefix) -> KeyCodec {
+                KeyCodec ret;
+                ret.numeric = true;
+                ret.prefix = prefix;
+                return ret;
+            }
+
+            // a numeric codec if all samples are a common prefix followed by codable digits
+            static auto detect(const std::vector<std::string> &samples) -> KeyCodec;
+
+            inline auto encode(const char *k, size_t k_sz) const noexcept -> uint64_t {
+                if (!numeric) {
+                    return HillString::prefix_of(k, k_sz);
+                }
+
+                auto p_sz = prefix.size();
+                if (k_sz < p_sz || k_sz - p_sz > Constants::uMAX_CODED_DIGITS || memcmp(k, prefix.data(), p_sz) != 0) {
+                    return 0;
+                }
+
+                uint64_t rank = 0;
+                for (size_t i = p_sz; i < k_sz; i++) {
+                    uint64_t d = k[i] - '0';
+                    if (d > 9) {
+                        return 0;
+                    }
+                    rank += 1 + d * Constants::uSHORTER_THAN[Constants::uMAX_CODED_DIGITS - (i - p_sz)];
+                }
+                return rank + 1;
+            }
+
+            // the original key of a code made by a numeric codec
+            auto decode(uint64_t code) const -> std::string;
+
+            inline auto compare(uint64_t l_code, const HillString *lhs, uint64_t r_code, const char *rhs, size_t r_sz)
+                const noexcept -> int
+            {
+                // prefixes decide only when they differ, numeric codes decide unless a key is not coded
+                if (numeric ? l_code == 0 || r_code == 0 : l_code == r_code) {
+                    return HillString::compare(lhs->raw_chars(), lhs->size(), rhs, r_sz);
+                }
+
+                if (l_code == r_code) {
+                    return 0;
+                }
+                return l_code < r_code ? -1 : 1;
+            }
+
+            // equal exact codes mean equal keys
+            inline auto is_exact(uint64_t code) const noexcept -> bool {
+                return numeric && code != 0;
+            }
+
+            inline auto is_numeric() const noexcept -> bool {
+                return numeric;
+            }
+
+            inline auto get_prefix() const noexcept -> const std::string & {
+                return prefix;
+            }
+
+        private:
+            bool numeric;
+            std::string prefix;
+        };
     }
 }
 #endif
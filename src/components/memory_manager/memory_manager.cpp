@@ -8,8 +8,10 @@ namespace Hill {
          * when it resides on PM
          */
         std::mutex allocator_global_lock;
-        auto Page::allocate(size_t size, byte_ptr_t &ptr) noexcept -> void {
-            auto unavailable = header.header_cursor + sizeof(RecordHeader) + size > header.record_cursor;
+        auto Page::allocate(size_t size, byte_ptr_t &ptr, AllocationListener *listener) noexcept -> void {
+            // records is 8-bit wide
+            auto unavailable = header.header_cursor + sizeof(RecordHeader) + size > header.record_cursor ||
+                header.records == 0xff;
             if (unavailable) {
                 ptr = nullptr;
                 return;
@@ -20,15 +22,21 @@ namespace Hill {
             ptr = tmp_ptr + snapshot.record_cursor - size;
 
             // order here matters, we exploit x86 write order to wipe out fences
-            ++snapshot.records;
-            ++snapshot.valid;
             snapshot.record_cursor -= size;
-            auto record_header = get_headers();
+            auto record_header = get_headers() + snapshot.records;
             record_header->offset = snapshot.record_cursor;
+            HILL_CRASH_POINT("page.allocate.record");
+            ++snapshot.records;
+            ++snapshot.valid;
             snapshot.header_cursor += sizeof(RecordHeader);
 
+            if (listener) {
+                listener->on_allocate(ptr);
+            }
+
             // atomic write, fence required
             header = snapshot;
+            HILL_CRASH_POINT("page.allocate.header");
         }
 
         // Delete rarely occurs, we put some heavy work in it
@@ -67,15 +75,17 @@ namespace Hill {
                     auto begin = header.freelist;
                     auto end = header.freelist;
                     for (size_t i = 0; i < Constants::uPREALLOCATION; i++) {
-                        if (end) {
+                        if (end->next) {
                             end = end->next;
                         }
                     }
 
                     // on recovery, should check
                     header.thread_free_lists[id] = begin;
+                    HILL_CRASH_POINT("allocator.preallocate.reuse");
                     header.freelist = end->next;
                     end->next = nullptr;
+                    HILL_CRASH_POINT("allocator.preallocate.cut");
                 } else {
                     // from global heap
                     auto tmp = header.cursor;
@@ -86,19 +96,27 @@ namespace Hill {
                     }
                     Page::make_page(reinterpret_cast<byte_ptr_t>(tmp), nullptr);
                     Util::mfence();
+                    HILL_CRASH_POINT("allocator.preallocate.pages");
                     // on recovery, should check if any thread_free_list
                     // matches cursor, if so, cursor should be incremented
                     header.thread_free_lists[id] =  header.cursor;
                     Util::mfence();
+                    HILL_CRASH_POINT("allocator.preallocate.claim");
                     header.cursor += Constants::uPREALLOCATION + 1; // next usable page
+                    HILL_CRASH_POINT("allocator.preallocate.advance");
                 }
             }
         }
 #endif
 
-        auto Allocator::allocate(int id, size_t size, byte_ptr_t &ptr) -> void {
+        auto Allocator::allocate(int id, size_t size, byte_ptr_t &ptr, AllocationListener *listener) -> void {
 #ifdef __HILL_LOG_ALLOCATOR__
+            // the offset is on PM, memory before it is never handed out again after a recovery
             ptr = header.base + header.offset.fetch_add(size);
+            HILL_CRASH_POINT("allocator.log.bump");
+            if (listener) {
+                listener->on_allocate(ptr);
+            }
 #else
             if (size > Constants::uPAGE_SIZE) {
                 throw std::invalid_argument("Object size too large");
@@ -108,7 +126,7 @@ namespace Hill {
             auto page = header.thread_busy_pages[id];
             // on start, or the page is on busy_list but freed(an allocation followed by a free)
             if (page)  {
-                page->allocate(size, ptr);
+                page->allocate(size, ptr, listener);
                 if (ptr != nullptr) {
                     header.consumed += size;
                     return;
@@ -125,19 +143,24 @@ namespace Hill {
 
             // on recovery
             header.thread_busy_pages[id] = header.thread_free_lists[id];
+            HILL_CRASH_POINT("allocator.allocate.busy");
             header.thread_free_lists[id] = header.thread_free_lists[id]->next;
             Util::mfence();
+            HILL_CRASH_POINT("allocator.allocate.unlink");
             header.thread_busy_pages[id]->next = nullptr;
             Util::mfence();
 
-            header.thread_busy_pages[id]->allocate(size, ptr);
+            header.thread_busy_pages[id]->allocate(size, ptr, listener);
             header.consumed += size;
 #endif
         }
 
-        auto Allocator::allocate_for_remote(byte_ptr_t &ptr) -> void {
+        auto Allocator::allocate_for_remote(byte_ptr_t &ptr, AllocationListener *listener) -> void {
 #ifdef __HILL_LOG_ALLOCATOR__
             ptr = header.base + header.offset.fetch_add(Constants::uREMOTE_REGION_SIZE);
+            if (listener) {
+                listener->on_allocate(ptr);
+            }
 #else
             {
                 std::scoped_lock<std::mutex> _(allocator_global_lock);
@@ -150,6 +173,9 @@ namespace Hill {
                     return;
                 } else {
                     ptr = reinterpret_cast<byte_ptr_t>(header.cursor);
+                    if (listener) {
+                        listener->on_allocate(ptr);
+                    }
                     header.cursor += remote_pages;
                 }
             }
@@ -191,12 +217,16 @@ namespace Hill {
         auto Allocator::free(int id, byte_ptr_t &ptr) -> void {
             if (!ptr)
                 return;
-
+#ifdef __HILL_LOG_ALLOCATOR__
+            // a log allocator never reuses memory, and ptr has no page header to update
+            (void)id;
+#else
             // auto page = reinterpret_cast<Page *>(reinterpret_cast<uint64_t>(ptr) & Constants::uPAGE_MASK);
             auto page = Page::get_page(ptr);
             // on recovery, should check
             header.to_be_freed[id] = page;
             Util::mfence();
+            HILL_CRASH_POINT("allocator.free.mark");
             if (--page->header.valid == 0) {
                 page->reset_cursor();
                 if (header.thread_busy_pages[id] == page) {
@@ -205,10 +235,12 @@ namespace Hill {
                 }
 
                 page->next = header.thread_free_lists[id];
+                HILL_CRASH_POINT("allocator.free.link");
                 header.thread_free_lists[id] = page;
             }
 
             header.to_be_freed[id] = nullptr;
+#endif
         }
 
         auto Allocator::recover() -> Enums::AllocatorRecoveryStatus {
@@ -218,11 +250,51 @@ namespace Hill {
 
             recover_pending_list();
             recover_global_heap();
+            recover_global_free_list();
             recover_free_lists();
             // recover_pending_list();
             recover_to_be_freed();
 
             return Enums::AllocatorRecoveryStatus::Ok;
         }
+
+#ifndef __HILL_LOG_ALLOCATOR__
+        auto Allocator::collect_free_pages() const noexcept -> std::optional<std::unordered_set<const Page *>> {
+            std::unordered_set<const Page *> ret;
+            auto limit = header.base + header.total_size / Constants::uPAGE_SIZE;
+            auto walk = [&](const Page *p) -> bool {
+                for (; p != nullptr; p = p->next) {
+                    if (p < header.base || p >= header.cursor || p >= limit ||
+                        reinterpret_cast<uint64_t>(p) % Constants::uPAGE_SIZE != 0) {
+                        return false;
+                    }
+
+                    // linked twice or a cycle
+                    if (!ret.insert(p).second) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            if (!walk(header.freelist)) {
+                return {};
+            }
+
+            for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
+                if (!walk(header.thread_free_lists[i])) {
+                    return {};
+                }
+            }
+
+            // a pending page is the busy page of an unregistered thread
+            for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
+                if (ret.count(header.thread_busy_pages[i]) != 0 || ret.count(header.thread_pending_pages[i]) != 0) {
+                    return {};
+                }
+            }
+            return ret;
+        }
+#endif
     }
 }
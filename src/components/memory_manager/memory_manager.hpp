@@ -1,11 +1,14 @@
 #ifndef __HILL__MEMORY_MANAGER__MEMORY_MANAGER__
 #define __HILL__MEMORY_MANAGER__MEMORY_MANAGER__
 #include "config/config.hpp"
+#include "crash_test/crash_test.hpp"
 
 #include <optional>
+#include <unordered_set>
 #include <cstring>
 #include <mutex>
 #include <atomic>
+#include <limits>
 
 
 #if defined(__HILL_DEBUG__) || defined(__HILL_INFO__)
@@ -67,6 +70,23 @@ namespace Hill {
             inline void mfence(void) {
                 asm volatile("mfence":::"memory");
             }
+
+            inline void sfence(void) {
+                asm volatile("sfence":::"memory");
+            }
+
+            /*
+             * Write back cache lines covering [addr, addr + size) without waiting. Multiple
+             * flushes can share one sfence, which is the whole point of separating the two
+             */
+            inline void flush(const void *addr, size_t size) {
+#ifdef __HILL_PMEM__
+                pmem_flush(addr, size);
+#else
+                (void)addr;
+                (void)size;
+#endif
+            }
         }
         /*
          * A Page(16KB) is the basic memory alloction granularity, more
@@ -99,8 +119,21 @@ namespace Hill {
          *
          */
 
-        /* !!!NEVER INHERIT FROM ANY OTHER STRUCT OR CLASS!!! */
         using namespace TypeAliases;
+
+        /*
+         * Told the address of an allocation after it is carved out and before the allocator commits
+         * it, e.g., to publish the address to a log entry. A crash after the commit then never leaks
+         * memory the log does not know of
+         */
+        class AllocationListener {
+        public:
+            virtual auto on_allocate(const byte_ptr_t &ptr) noexcept -> void = 0;
+        protected:
+            ~AllocationListener() = default;
+        };
+
+        /* !!!NEVER INHERIT FROM ANY OTHER STRUCT OR CLASS!!! */
         struct RecordHeader {
             uint16_t offset;
         };
@@ -135,11 +168,16 @@ namespace Hill {
                 return *page_ptr;
             }
 
+            // the largest object an empty page holds
+            static constexpr auto max_allocation() noexcept -> size_t {
+                return sizeof(Page) - sizeof(Page *) - sizeof(PageHeader) - sizeof(RecordHeader);
+            }
+
             static auto get_page(const byte_ptr_t &ptr) -> Page * {
                 return reinterpret_cast<Page *>(reinterpret_cast<uint64_t>(ptr) & Constants::uPAGE_MASK);
             }
 
-            auto allocate(size_t size, byte_ptr_t &ptr) noexcept -> void;
+            auto allocate(size_t size, byte_ptr_t &ptr, AllocationListener *listener = nullptr) noexcept -> void;
             auto free(byte_ptr_t &ptr) noexcept -> void;
 
             inline auto get_headers() noexcept -> RecordHeader * {
@@ -152,6 +190,7 @@ namespace Hill {
             }
 
             inline auto reset_cursor() noexcept -> void {
+                header.records = 0;
                 header.header_cursor = sizeof(PageHeader);
                 header.record_cursor = sizeof(Page) - sizeof(Page *);
 #ifdef PMEM
@@ -183,11 +222,7 @@ namespace Hill {
 
         class Allocator {
         public:
-#ifdef __HILL_LOG_ALLOCATOR__
-            Allocator() = default;
-#else
             Allocator() = delete;
-#endif
             ~Allocator() = default;
             Allocator(const Allocator &) = delete;
             Allocator(Allocator &&) = delete;
@@ -195,19 +230,18 @@ namespace Hill {
             auto operator=(Allocator &&) -> Allocator & = delete;
 
             static auto make_allocator(const byte_ptr_t &base, size_t size) -> Allocator * {
-#ifdef __HILL_LOG_ALLOCATOR__
-                auto allocator = new Allocator;
-                auto aligned = reinterpret_cast<Page *>(reinterpret_cast<uint64_t>(base + sizeof(AllocatorHeader)) & Constants::uPAGE_MASK);
-                allocator->header.base = reinterpret_cast<byte_ptr_t>(aligned + 1);
-                allocator->header.offset = 0;
-#else
-
+                // the log allocator keeps its header on PM as well, so that it is recovered the same way
                 auto allocator = reinterpret_cast<Allocator *>(base);
                 allocator->header.magic = Constants::uALLOCATOR_MAGIC;
                 allocator->header.total_size = size;
                 allocator->header.freelist = nullptr;
 
                 auto aligned = reinterpret_cast<Page *>(reinterpret_cast<uint64_t>(base + sizeof(AllocatorHeader)) & Constants::uPAGE_MASK);
+#ifdef __HILL_LOG_ALLOCATOR__
+                allocator->header.base = reinterpret_cast<byte_ptr_t>(aligned + 1);
+                allocator->header.offset = 0;
+                allocator->header.cursor = nullptr;
+#else
                 allocator->header.base = reinterpret_cast<Page *>(aligned + 1);
                 allocator->header.cursor = allocator->header.base;
 #endif
@@ -217,7 +251,7 @@ namespace Hill {
                     allocator->header.thread_busy_pages[i] = nullptr;
                     allocator->header.to_be_freed[i] = nullptr;
                     allocator->header.in_use[i] = false;
-                    allocator->header.write_cache[i] = reinterpret_cast<Page *>(new byte_t[sizeof(Constants::uPAGE_SIZE)]);
+                    allocator->header.write_cache[i] = reinterpret_cast<Page *>(new byte_t[Constants::uPAGE_SIZE]);
                     allocator->header.write_cache[i]->next = nullptr;
                 }
                 allocator->header.consumed = 0;
@@ -232,6 +266,9 @@ namespace Hill {
                 case Enums::AllocatorRecoveryStatus::Ok:
                     for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
                         allocator->header.in_use[i] = false;
+                        // DRAM buffers of the previous run are gone
+                        allocator->header.write_cache[i] = reinterpret_cast<Page *>(new byte_t[Constants::uPAGE_SIZE]);
+                        allocator->header.write_cache[i]->next = nullptr;
                     }
                     return allocator;
                 case Enums::AllocatorRecoveryStatus::Corrupted:
@@ -247,7 +284,11 @@ namespace Hill {
                 allocator->header.freelist = nullptr;
 
                 auto aligned = reinterpret_cast<Page *>(reinterpret_cast<uint64_t>(base + sizeof(AllocatorHeader)) & Constants::uPAGE_MASK);
-#ifndef __HILL_LOG_ALLOCATOR__
+#ifdef __HILL_LOG_ALLOCATOR__
+                allocator->header.base = reinterpret_cast<byte_ptr_t>(aligned + 1);
+                allocator->header.offset = 0;
+                allocator->header.cursor = nullptr;
+#else
                 allocator->header.base = reinterpret_cast<Page *>(aligned + 1);
                 allocator->header.cursor = allocator->header.base;
 #endif
@@ -257,15 +298,27 @@ namespace Hill {
                     allocator->header.thread_busy_pages[i] = nullptr;
                     allocator->header.to_be_freed[i] = nullptr;
                     allocator->header.in_use[i] = false;
+                    allocator->header.write_cache[i] = reinterpret_cast<Page *>(new byte_t[Constants::uPAGE_SIZE]);
+                    allocator->header.write_cache[i]->next = nullptr;
                 }
+                allocator->header.consumed = 0;
                 return allocator;
             }
 
             auto register_thread() noexcept -> std::optional<int>;
             auto unregister_thread(int id) noexcept -> void;
 
-            auto allocate(int id, size_t size, byte_ptr_t &ptr) -> void;
-            auto allocate_for_remote(byte_ptr_t &ptr) -> void;
+            // the largest object allocate accepts
+            static constexpr auto max_allocation() noexcept -> size_t {
+#ifdef __HILL_LOG_ALLOCATOR__
+                return std::numeric_limits<size_t>::max();
+#else
+                return Page::max_allocation();
+#endif
+            }
+
+            auto allocate(int id, size_t size, byte_ptr_t &ptr, AllocationListener *listener = nullptr) -> void;
+            auto allocate_for_remote(byte_ptr_t &ptr, AllocationListener *listener = nullptr) -> void;
             auto free(int id, byte_ptr_t &ptr) -> void;
             auto drain(int id) -> void;
 
@@ -274,6 +327,20 @@ namespace Hill {
                 return header.consumed.load();
             }
 
+#ifdef __HILL_LOG_ALLOCATOR__
+            // whether ptr is in what has been handed out, a log allocator never reuses it. Only for tests
+            auto is_allocated(const byte_ptr_t ptr) const noexcept -> bool {
+                return ptr >= header.base && ptr < header.base + header.offset.load();
+            }
+#else
+            /*
+             * Walk the global free list and thread free lists, and return pages linked in them. Nothing
+             * is returned if a list is broken: a cycle, a page out of the heap or linked twice, or a busy
+             * or pending page that is also free. Only for tests
+             */
+            auto collect_free_pages() const noexcept -> std::optional<std::unordered_set<const Page *>>;
+#endif
+
         private:
             struct AllocatorHeader {
                 uint64_t magic;
@@ -312,10 +379,10 @@ namespace Hill {
             auto recover_global_free_list() -> void {
                 for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
                     // on-going allocation is detected
-                    if (header.thread_free_lists[i] == header.freelist) {
+                    if (header.freelist != nullptr && header.thread_free_lists[i] == header.freelist) {
                         auto end = header.freelist;
                         for (size_t i = 0; i < Constants::uPREALLOCATION; i++) {
-                            if (end) {
+                            if (end->next) {
                                 end = end->next;
                             }
                         }
@@ -329,7 +396,8 @@ namespace Hill {
             auto recover_free_lists() -> void {
                 for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
                     // on-going allocation
-                    if (header.thread_busy_pages[i] == header.thread_free_lists[i]) {
+                    if (header.thread_busy_pages[i] != nullptr &&
+                        header.thread_busy_pages[i] == header.thread_free_lists[i]) {
                         header.thread_free_lists[i] = header.thread_free_lists[i]->next;
                         header.thread_busy_pages[i]->next = nullptr;
                     }
@@ -339,7 +407,8 @@ namespace Hill {
             auto recover_global_heap() -> void {
                 for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
                     if (header.thread_free_lists[i] == header.cursor) {
-                        header.cursor += Constants::uPREALLOCATION;
+                        // the 1 is for current page, see preallocate
+                        header.cursor += Constants::uPREALLOCATION + 1;
                     }
                 }
             }
@@ -347,7 +416,8 @@ namespace Hill {
             auto recover_pending_list() -> void {
                 // on-going unregisteration
                 for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
-                    if (header.thread_pending_pages[i] == header.thread_busy_pages[i]) {
+                    if (header.thread_pending_pages[i] != nullptr &&
+                        header.thread_pending_pages[i] == header.thread_busy_pages[i]) {
                         header.thread_busy_pages[i]->next = header.thread_free_lists[i];
                         header.thread_free_lists[i] = header.thread_busy_pages[i];
                         header.thread_busy_pages[i] = nullptr;
@@ -358,12 +428,19 @@ namespace Hill {
 
             auto recover_to_be_freed() -> void {
                 for (int i = 0; i < Constants::iTHREAD_LIST_NUM; i++) {
-                    if (header.to_be_freed[i]->next != nullptr) {
-                        // freelists may have changed during recovery
-                        header.to_be_freed[i]->next = header.thread_free_lists[i];
-                        header.thread_free_lists[i] = header.to_be_freed[i];
-                        header.to_be_freed[i] = nullptr;
+                    auto page = header.to_be_freed[i];
+                    if (page == nullptr) {
+                        continue;
+                    }
+
+                    // an emptied page was not linked yet, freelists may have changed during recovery
+                    if (page->header.valid == 0 && page != header.thread_free_lists[i] &&
+                        page != header.thread_busy_pages[i]) {
+                        page->reset_cursor();
+                        page->next = header.thread_free_lists[i];
+                        header.thread_free_lists[i] = page;
                     }
+                    header.to_be_freed[i] = nullptr;
                 }
             }
 
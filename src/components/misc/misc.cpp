@@ -1,5 +1,7 @@
 #include "misc.hpp"
 
+#include <poll.h>
+
 namespace Hill {
     namespace Misc {
         int make_socket(bool is_server, int socket_port) {
@@ -64,6 +66,14 @@ namespace Hill {
             return accept4(sockfd, NULL, NULL, SOCK_NONBLOCK);
         }
 
+        bool wait_readable(int sockfd, int timeout_ms) {
+            struct pollfd pfd;
+            pfd.fd = sockfd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            return poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN);
+        }
+
         int send_all(int sockfd, void *buf, size_t count) {
             ssize_t sent = 0;
             ssize_t ret = 0;
@@ -18,6 +18,11 @@
 
 namespace Hill {
     namespace Misc {
+        namespace Constants {
+            // accept loops wait this long for a connection, it only bounds how late a stop is noticed
+            static constexpr int iACCEPT_WAIT_MS = 100;
+        }
+
         /*
          * Socket related functions. Here I don't use trailing return type because
          * these functions manipulate low-level OS interfaces.
@@ -28,6 +33,8 @@ namespace Hill {
         int connect_socket(int sockfd, int socket_port, const char *server);
         int accept_blocking(int sockfd);
         int accept_nonblocking(int sockfd);
+        // wait until a connection or data arrives at sockfd, false on timeout
+        bool wait_readable(int sockfd, int timeout_ms);
 
         int send_all(int sockfd, void *buf, size_t count);
         int recv_all(int sockfd, void *buf, size_t count);
@@ -0,0 +1,124 @@
+#include "placement.hpp"
+#include "config_reader/config_reader.hpp"
+
+#include <sstream>
+
+#include <sched.h>
+#include <numa.h>
+
+namespace Hill {
+    namespace Placement {
+        auto CPUSet::make_cpu_set(const std::string &spec) -> std::optional<CPUSet> {
+            CPUSet ret;
+            ret.spec = spec;
+
+            if (spec.rfind("numa:", 0) == 0) {
+                if (numa_available() == -1) {
+                    std::cerr << ">> Error: NUMA is not available for placement " << spec << "\n";
+                    return {};
+                }
+
+                ret.numa_node = atoi(spec.c_str() + 5);
+                if (ret.numa_node < 0 || ret.numa_node > numa_max_node()) {
+                    std::cerr << ">> Error: no NUMA node for placement " << spec << "\n";
+                    return {};
+                }
+
+                auto mask = numa_allocate_cpumask();
+                if (numa_node_to_cpus(ret.numa_node, mask) == 0) {
+                    for (size_t c = 0; c < mask->size; c++) {
+                        if (numa_bitmask_isbitset(mask, c)) {
+                            ret.cpus.push_back(c);
+                        }
+                    }
+                }
+                numa_free_cpumask(mask);
+            } else {
+                std::stringstream in(spec);
+                std::string range;
+                while (std::getline(in, range, ',')) {
+                    int first, last;
+                    auto dash = range.find('-');
+                    try {
+                        first = std::stoi(range.substr(0, dash));
+                        last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    } catch (...) {
+                        std::cerr << ">> Error: invalid placement " << spec << "\n";
+                        return {};
+                    }
+
+                    for (int c = first; c <= last && c < CPU_SETSIZE; c++) {
+                        ret.cpus.push_back(c);
+                    }
+                }
+            }
+
+            if (ret.cpus.empty()) {
+                std::cerr << ">> Error: placement " << spec << " has no CPU\n";
+                return {};
+            }
+            return ret;
+        }
+
+        auto Placement::make_placement(const std::string &content) -> Placement {
+            Placement ret;
+            const char *names[] = {"frontend", "backend", "service"};
+            for (int i = 0; i < 3; i++) {
+                if (auto spec = ConfigReader::read_placement(content, names[i]); spec.has_value()) {
+                    if (auto set = CPUSet::make_cpu_set(spec.value()); set.has_value()) {
+                        ret.sets[i] = std::move(set.value());
+                    }
+                }
+            }
+            return ret;
+        }
+
+        auto Placement::apply(Enums::Role role, int index) const noexcept -> bool {
+            if (!apply(pthread_self(), role, index)) {
+                return false;
+            }
+
+            // memory preference can only be set by the thread itself
+            if (auto node = get(role).numa_node; node != -1) {
+                numa_set_preferred(node);
+            }
+            return true;
+        }
+
+        auto Placement::apply(pthread_t thread, Enums::Role role, int index) const noexcept -> bool {
+            const auto &set = get(role);
+            if (set.empty()) {
+                return false;
+            }
+
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            if (role == Enums::Role::Service || set.numa_node != -1) {
+                for (auto c : set.cpus) {
+                    CPU_SET(c, &mask);
+                }
+            } else {
+                CPU_SET(set.cpus[index % set.cpus.size()], &mask);
+            }
+
+            if (auto err = pthread_setaffinity_np(thread, sizeof(mask), &mask); err != 0) {
+                std::cerr << ">> Error: failed to apply placement " << set.spec << ", errno is " << err << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        auto Placement::dump() const noexcept -> void {
+            const char *names[] = {"frontend", "backend", "service"};
+            for (int i = 0; i < 3; i++) {
+                std::cout << "---->> " << names[i] << " placement: ";
+                if (sets[i].empty()) {
+                    std::cout << "unpinned\n";
+                    continue;
+                }
+
+                std::cout << sets[i].spec << " (" << sets[i].cpus.size() << " CPUs)\n";
+            }
+        }
+    }
+}
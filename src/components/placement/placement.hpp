@@ -0,0 +1,80 @@
+#ifndef __HILL__PLACEMENT__PLACEMENT__
+#define __HILL__PLACEMENT__PLACEMENT__
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <iostream>
+
+#include <pthread.h>
+
+/*
+ * Where threads of a node run
+ *
+ * Threads are grouped by roles. Frontends are eRPC threads, backends are workers owning
+ * indices, and services are all other background threads, i.e., the eRPC listener, the
+ * memory monitor, RDMA connection checkers, the WAL checkpointer and the value log cleaner.
+ *
+ * Each role is placed on a CPU list like "0-3,8", or on a NUMA node like "numa:1". With a
+ * CPU list the i-th thread of a role is pinned to the i-th CPU (wrapping around), because
+ * frontends and backends spin and should never share or switch cores. With a NUMA node a
+ * thread may run on any CPU of the node and prefers its memory. Services are never pinned
+ * to a single CPU, they share the whole list of their role.
+ *
+ * A role that is not placed is left to the scheduler
+ */
+namespace Hill {
+    namespace Placement {
+        namespace Enums {
+            enum class Role {
+                Frontend,
+                Backend,
+                Service,
+            };
+        }
+
+        // CPUs of one role, empty if the role is not placed
+        struct CPUSet {
+            std::vector<int> cpus;
+            // the NUMA node the CPUs are taken from, -1 if they are listed directly
+            int numa_node;
+            std::string spec;
+
+            CPUSet() : numa_node(-1) {}
+
+            // "0-3,8" or "numa:1", nothing if spec is malformed or names no online CPU
+            static auto make_cpu_set(const std::string &spec) -> std::optional<CPUSet>;
+
+            inline auto empty() const noexcept -> bool {
+                return cpus.empty();
+            }
+        };
+
+        class Placement {
+        public:
+            Placement() = default;
+            ~Placement() = default;
+            Placement(const Placement &) = default;
+            Placement(Placement &&) = default;
+            auto operator=(const Placement &) -> Placement & = default;
+            auto operator=(Placement &&) -> Placement & = default;
+
+            // read placement_frontend, placement_backend and placement_service in a config file
+            static auto make_placement(const std::string &content) -> Placement;
+
+            // pin the calling thread as the index-th thread of role, false if the role is not placed
+            auto apply(Enums::Role role, int index = 0) const noexcept -> bool;
+            auto apply(pthread_t thread, Enums::Role role, int index = 0) const noexcept -> bool;
+
+            inline auto get(Enums::Role role) const noexcept -> const CPUSet & {
+                return sets[static_cast<int>(role)];
+            }
+
+            auto dump() const noexcept -> void;
+
+        private:
+            CPUSet sets[3];
+        };
+    }
+}
+#endif
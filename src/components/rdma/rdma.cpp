@@ -179,6 +179,38 @@ namespace Hill {
             return post_send_helper(ptr, msg, msg_len, IBV_WR_RDMA_WRITE, local_offset);
         }
 
+        auto RDMAContext::read_chunked(const byte_ptr_t &ptr, size_t msg_len, byte_ptr_t out) noexcept -> StatusPair {
+            const size_t chunk = mr->length;
+            // every chunk lands in the buffer, so only a message fitting in it can be left there
+            if (out == nullptr && msg_len > chunk) {
+                return {Status::InvalidArguments, 0};
+            }
+
+            for (size_t offset = 0; offset < msg_len; offset += chunk) {
+                auto len = std::min(chunk, msg_len - offset);
+                if (auto ret = post_read(ptr + offset, len); ret.first != Status::Ok) {
+                    return ret;
+                }
+                poll_completion_once();
+                if (out) {
+                    memcpy(out + offset, buf, len);
+                }
+            }
+            return {Status::Ok, 0};
+        }
+
+        auto RDMAContext::write_chunked(const byte_ptr_t &ptr, const uint8_t *msg, size_t msg_len) noexcept -> StatusPair {
+            const size_t chunk = mr->length;
+            for (size_t offset = 0; offset < msg_len; offset += chunk) {
+                auto len = std::min(chunk, msg_len - offset);
+                if (auto ret = post_write(ptr + offset, msg + offset, len); ret.first != Status::Ok) {
+                    return ret;
+                }
+                poll_completion_once();
+            }
+            return {Status::Ok, 0};
+        }
+
         auto RDMAContext::post_recv_to(size_t msg_len, size_t offset) -> StatusPair {
             struct ibv_sge sg;
             struct ibv_recv_wr wr;
@@ -140,6 +140,15 @@ namespace Hill {
 
             auto post_recv_to(size_t msg_len, size_t offset = 0) -> StatusPair;
 
+            /*
+             * Read or write messages larger than the registered buffer. The message is split into
+             * chunks of the buffer size and each chunk is polled before the next one is posted since
+             * a queue pair only holds one outstanding send. A read chunk is copied to out if given,
+             * otherwise the message is left in the buffer and should fit in it
+             */
+            auto read_chunked(const byte_ptr_t &ptr, size_t msg_len, byte_ptr_t out = nullptr) noexcept -> StatusPair;
+            auto write_chunked(const byte_ptr_t &ptr, const uint8_t *msg, size_t msg_len) noexcept -> StatusPair;
+
             /*
              * A set of poll_completion functions. 
              * poll_completion_once(): just to check if a completion is generated
@@ -0,0 +1,53 @@
+#ifndef __HILL__STORE__BATCH__BATCH__
+#define __HILL__STORE__BATCH__BATCH__
+
+#include "kv_pair/kv_pair.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Entries of a batched request
+ *
+ * A batched request carries n entries of | hill_key_t key | hill_value_t value |, or of keys
+ * only for searches, back to back. The server answers every key on its own, so a client keeps
+ * the request buffer and, if some keys are answered Busy, packs their entries to the front and
+ * sends the same buffer again with only those keys.
+ */
+namespace Hill {
+    namespace Store {
+        namespace Batch {
+            using namespace KVPair::TypeAliases;
+
+            static inline auto entry_size(const uint8_t *entry, bool with_value) noexcept -> size_t {
+                auto ret = reinterpret_cast<const hill_key_t *>(entry)->object_size();
+                if (with_value) {
+                    ret += reinterpret_cast<const hill_value_t *>(entry + ret)->object_size();
+                }
+                return ret;
+            }
+
+            /*
+             * keep(i) is called once for every entry in order, the kept ones are packed to the front
+             * of entries in the same order. Returns the end of the packed entries
+             */
+            template<typename F>
+            static inline auto repack(uint8_t *entries, uint32_t num, bool with_values, F &&keep) -> uint8_t * {
+                auto packed = entries;
+                auto entry = entries;
+                for (uint32_t i = 0; i < num; i++) {
+                    auto size = entry_size(entry, with_values);
+                    if (keep(i)) {
+                        if (packed != entry) {
+                            memmove(packed, entry, size);
+                        }
+                        packed += size;
+                    }
+                    entry += size;
+                }
+                return packed;
+            }
+        }
+    }
+}
+#endif
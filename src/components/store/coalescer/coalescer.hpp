@@ -0,0 +1,75 @@
+#ifndef __HILL__STORE__COALESCER__COALESCER__
+#define __HILL__STORE__COALESCER__COALESCER__
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Searches coalesced within a group of a backend
+ *
+ * Searches of the same key drained together are run once and the others copy the result,
+ * which is what hot keys hammered by every frontend look like. Messages of a group are known by
+ * their index in it and the searches run so far are kept with the hashes of their keys. A write
+ * to a key ends the reuse so that searches after it see the new value. Hashes only filter, the
+ * caller compares the keys themselves, and a write drops every search sharing its hash.
+ */
+namespace Hill {
+    namespace Store {
+        template<size_t N>
+        class SearchCoalescer {
+        public:
+            static constexpr size_t npos = N;
+
+            SearchCoalescer() : num(0) {}
+            ~SearchCoalescer() = default;
+            SearchCoalescer(const SearchCoalescer &) = delete;
+            SearchCoalescer(SearchCoalescer &&) = delete;
+            auto operator=(const SearchCoalescer &) -> SearchCoalescer & = delete;
+            auto operator=(SearchCoalescer &&) -> SearchCoalescer & = delete;
+
+            // a new group starts
+            auto reset() noexcept -> void {
+                num = 0;
+            }
+
+            auto empty() const noexcept -> bool {
+                return num == 0;
+            }
+
+            // the search run for a key of hash, same(m) tells if the m-th message has the key. npos if none
+            template<typename F>
+            auto leader_of(uint64_t hash, F &&same) const -> size_t {
+                for (size_t r = 0; r < num; r++) {
+                    if (hashes[r] == hash && same(readers[r])) {
+                        return readers[r];
+                    }
+                }
+                return npos;
+            }
+
+            // the m-th message is a search just run, later ones of its key copy its result
+            auto lead(size_t m, uint64_t hash) noexcept -> void {
+                readers[num] = m;
+                hashes[num++] = hash;
+            }
+
+            // a write to a key of hash, searches after it are run again
+            auto written(uint64_t hash) noexcept -> void {
+                size_t kept = 0;
+                for (size_t r = 0; r < num; r++) {
+                    if (hashes[r] != hash) {
+                        readers[kept] = readers[r];
+                        hashes[kept++] = hashes[r];
+                    }
+                }
+                num = kept;
+            }
+
+        private:
+            size_t readers[N];
+            uint64_t hashes[N];
+            size_t num;
+        };
+    }
+}
+#endif
@@ -0,0 +1,62 @@
+#ifndef __HILL__STORE__GROUP_SEQ__GROUP_SEQ__
+#define __HILL__STORE__GROUP_SEQ__GROUP_SEQ__
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+/*
+ * Publication of the WAL groups of one backend
+ *
+ * A backend writes the values of a group into its index before the group is committed, so
+ * threads searching the index without the owner must not return them yet. The sequence is
+ * odd while a group with writes is open, as in a seqlock. A search is trusted only if the
+ * sequence is even and unchanged across it, otherwise the owner runs it after the group.
+ */
+namespace Hill {
+    namespace Store {
+        class GroupSeq {
+        public:
+            GroupSeq() : seq(0) {}
+            ~GroupSeq() = default;
+            GroupSeq(const GroupSeq &) = delete;
+            GroupSeq(GroupSeq &&) = delete;
+            auto operator=(const GroupSeq &) -> GroupSeq & = delete;
+            auto operator=(GroupSeq &&) -> GroupSeq & = delete;
+
+            // owner, before the first write of a group
+            inline auto open() noexcept -> void {
+                seq.fetch_add(1);
+            }
+
+            // owner, after the group is committed
+            inline auto close() noexcept -> void {
+                seq.fetch_add(1);
+            }
+
+            /*
+             * any thread, search returns a std::optional and is dropped along with what it found if
+             * a group is open or published meanwhile
+             */
+            template<typename F>
+            inline auto read(F &&search) const noexcept -> decltype(search()) {
+                auto before = seq.load(std::memory_order_acquire);
+                if (before & 1) {
+                    return {};
+                }
+
+                auto ret = search();
+                // what the search read is ordered before the second load
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) != before) {
+                    return {};
+                }
+                return ret;
+            }
+
+        private:
+            std::atomic_uint64_t seq;
+        };
+    }
+}
+#endif
@@ -0,0 +1,157 @@
+#include "hot_cache.hpp"
+#include "city/city.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace Hill {
+    namespace Store {
+        HotCache::HotCache() : recorded(0) {
+            slots = std::make_unique<HotSlot[]>(Constants::uHOT_CACHE_SLOTS);
+            sketch = std::make_unique<std::atomic_uint8_t[]>(Constants::uSKETCH_WIDTH * Constants::iSKETCH_DEPTH);
+            for (size_t i = 0; i < Constants::uSKETCH_WIDTH * Constants::iSKETCH_DEPTH; i++) {
+                sketch[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        auto HotCache::get(const char *k, size_t k_sz, byte_ptr_t out, Memory::PolymorphicPointer &ptr) noexcept -> size_t {
+            if (k_sz > Constants::uHOT_KEY_SIZE) {
+                return 0;
+            }
+
+            auto hash = hash_of(k, k_sz);
+            record(hash);
+
+            auto &slot = slot_of(hash);
+            auto version = slot.version.load(std::memory_order_acquire);
+            if ((version & 1) || slot.hash != hash) {
+                return 0;
+            }
+
+            auto size = slot.value_size;
+            if (slot.key_size != k_sz || size > Constants::uHOT_VALUE_SIZE || memcmp(slot.key, k, k_sz) != 0) {
+                return 0;
+            }
+            memcpy(out, slot.value, size);
+            auto found = slot.ptr;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != version) {
+                return 0;
+            }
+            ptr = found;
+            return size;
+        }
+
+        auto HotCache::ticket(const char *k, size_t k_sz) const noexcept -> std::optional<uint64_t> {
+            if (k_sz > Constants::uHOT_KEY_SIZE) {
+                return {};
+            }
+
+            auto hash = hash_of(k, k_sz);
+            auto &slot = slot_of(hash);
+            auto ret = slot.version.load(std::memory_order_acquire);
+            // only a hint, a victim changing meanwhile fails the admission
+            auto victim = slot.hash;
+            if ((ret & 1) || victim == hash) {
+                return {};
+            }
+
+            auto frequency = estimate(hash);
+            if (victim == 0 ? frequency < Constants::uADMIT_FREQUENCY : frequency <= estimate(victim)) {
+                return {};
+            }
+            return ret;
+        }
+
+        auto HotCache::admit(uint64_t ticket, const char *k, size_t k_sz, const Memory::PolymorphicPointer &ptr,
+                             const_byte_ptr_t value, size_t v_sz) noexcept -> bool
+        {
+            if ((ticket & 1) || k_sz > Constants::uHOT_KEY_SIZE || v_sz == 0 || v_sz > Constants::uHOT_VALUE_SIZE) {
+                return false;
+            }
+
+            auto hash = hash_of(k, k_sz);
+            auto &slot = slot_of(hash);
+            if (!slot.version.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire)) {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot.hash = hash;
+            slot.ptr = ptr;
+            slot.key_size = k_sz;
+            slot.value_size = v_sz;
+            memcpy(slot.key, k, k_sz);
+            memcpy(slot.value, value, v_sz);
+            slot.version.store(ticket + 2, std::memory_order_release);
+            return true;
+        }
+
+        auto HotCache::invalidate(const char *k, size_t k_sz) noexcept -> void {
+            auto hash = hash_of(k, k_sz);
+            auto &slot = slot_of(hash);
+
+            // the version is bumped even if k is not cached to fail admissions racing with this
+            auto version = slot.version.load(std::memory_order_relaxed);
+            while ((version & 1) || !slot.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+                version = slot.version.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            if (slot.hash == hash) {
+                slot.hash = 0;
+                slot.ptr = nullptr;
+            }
+            slot.version.store(version + 2, std::memory_order_release);
+        }
+
+        auto HotCache::hash_of(const char *k, size_t k_sz) noexcept -> uint64_t {
+            auto ret = CityHash64(k, k_sz);
+            return ret == 0 ? 1 : ret;
+        }
+
+        auto HotCache::counter_of(uint64_t hash, int row) const noexcept -> std::atomic_uint8_t & {
+            // rows take different bits of the hash mixed by different odd multipliers
+            static constexpr uint64_t seeds[] = {
+                0x9e3779b97f4a7c15UL, 0xc2b2ae3d27d4eb4fUL, 0x165667b19e3779f9UL, 0xd6e8feb86659fd93UL,
+            };
+            auto h = (hash * seeds[row % 4]) >> 32;
+            return sketch[row * Constants::uSKETCH_WIDTH + (h & (Constants::uSKETCH_WIDTH - 1))];
+        }
+
+        auto HotCache::record(uint64_t hash) noexcept -> void {
+            uint8_t min = Constants::uSKETCH_MAX;
+            for (int r = 0; r < Constants::iSKETCH_DEPTH; r++) {
+                min = std::min(min, counter_of(hash, r).load(std::memory_order_relaxed));
+            }
+            if (min == Constants::uSKETCH_MAX) {
+                return;
+            }
+
+            // conservative update, lost increments of racing searches are fine for an estimate
+            for (int r = 0; r < Constants::iSKETCH_DEPTH; r++) {
+                auto &c = counter_of(hash, r);
+                if (c.load(std::memory_order_relaxed) == min) {
+                    c.store(min + 1, std::memory_order_relaxed);
+                }
+            }
+
+            auto n = recorded.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (n % Constants::uSKETCH_STEP == 0) {
+                auto start = (n / Constants::uSKETCH_STEP % Constants::uSKETCH_CHUNKS) * Constants::uSKETCH_CHUNK;
+                for (auto i = start; i < start + Constants::uSKETCH_CHUNK; i++) {
+                    sketch[i].store(sketch[i].load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        auto HotCache::estimate(uint64_t hash) const noexcept -> uint8_t {
+            uint8_t ret = Constants::uSKETCH_MAX;
+            for (int r = 0; r < Constants::iSKETCH_DEPTH; r++) {
+                ret = std::min(ret, counter_of(hash, r).load(std::memory_order_relaxed));
+            }
+            return ret;
+        }
+    }
+}
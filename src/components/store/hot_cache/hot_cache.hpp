@@ -0,0 +1,121 @@
+#ifndef __HILL__STORE__HOT_CACHE__HOT_CACHE__
+#define __HILL__STORE__HOT_CACHE__HOT_CACHE__
+
+#include "remote_memory/remote_memory.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+/*
+ * DRAM cache of hot values of a node
+ *
+ * Under skewed load the same few values are read from PM by every search, and once more by
+ * the one-sided read of the client. Hot values are copied here and searches hitting them are
+ * answered with the value inlined in the response, touching neither PM nor the index.
+ *
+ * Slots are direct mapped by the hash of a key and guarded by a seqlock, so eRPC threads read
+ * them without writing shared lines. A count-min sketch of small saturating counters estimates how
+ * often keys are searched. A key is admitted only if it is estimated hotter than the key in
+ * its slot, thus one-off searches never evict hot values. Counters are halved periodically, a
+ * small chunk every few increments, so that the estimates follow shifting hotspots.
+ *
+ * The owning backend invalidates a key after it changes the value. Admission is a race with
+ * that, thus a searcher takes a ticket before searching the index and the admission fails if
+ * the slot is invalidated or otherwise written after the ticket is taken.
+ */
+namespace Hill {
+    namespace Store {
+        using namespace Memory::TypeAliases;
+
+        namespace Constants {
+            // a power of 2
+#ifdef __HILL_DEBUG__
+            static constexpr size_t uHOT_CACHE_SLOTS = 1UL << 8;
+#else
+            static constexpr size_t uHOT_CACHE_SLOTS = 1UL << 16;
+#endif
+            // larger keys and stamped values are never cached
+            static constexpr size_t uHOT_KEY_SIZE = 64;
+            static constexpr size_t uHOT_VALUE_SIZE = 256;
+
+            static constexpr size_t uSKETCH_WIDTH = uHOT_CACHE_SLOTS * 4;
+            static constexpr int iSKETCH_DEPTH = 4;
+            // every counter is halved once in this many increments
+            static constexpr uint64_t uSKETCH_PERIOD = uSKETCH_WIDTH * 8;
+            // a chunk of counters is halved at a time, so no search pays for the whole sketch
+            static constexpr size_t uSKETCH_CHUNK = 64;
+            static constexpr size_t uSKETCH_CHUNKS = uSKETCH_WIDTH * iSKETCH_DEPTH / uSKETCH_CHUNK;
+            static constexpr uint64_t uSKETCH_STEP = uSKETCH_PERIOD / uSKETCH_CHUNKS;
+            static_assert(uSKETCH_STEP > 0, "the sketch should be halved in chunks");
+            static constexpr uint8_t uSKETCH_MAX = 15;
+            // how many searches an empty slot requires before a key is admitted
+            static constexpr uint8_t uADMIT_FREQUENCY = 2;
+        }
+
+        struct HotSlot {
+            // odd while the slot is being written
+            std::atomic_uint64_t version;
+            // the hash of the cached key, 0 if the slot is empty
+            uint64_t hash;
+            Memory::PolymorphicPointer ptr;
+            uint32_t key_size;
+            uint32_t value_size;
+            char key[Constants::uHOT_KEY_SIZE];
+            byte_t value[Constants::uHOT_VALUE_SIZE];
+
+            HotSlot() : version(0), hash(0), ptr(nullptr), key_size(0), value_size(0) {}
+        };
+
+        class HotCache {
+        public:
+            HotCache();
+            ~HotCache() = default;
+            HotCache(const HotCache &) = delete;
+            HotCache(HotCache &&) = delete;
+            auto operator=(const HotCache &) -> HotCache & = delete;
+            auto operator=(HotCache &&) -> HotCache & = delete;
+
+            static auto make_hot_cache() -> std::unique_ptr<HotCache> {
+                return std::make_unique<HotCache>();
+            }
+
+            /*
+             * Record a search of k and copy its stamped value to out, which holds at least
+             * uHOT_VALUE_SIZE bytes. Returns the size of the value, 0 if k is not cached
+             */
+            auto get(const char *k, size_t k_sz, byte_ptr_t out, Memory::PolymorphicPointer &ptr) noexcept -> size_t;
+
+            // taken before searching the index, nothing if k is not hot enough to be admitted
+            auto ticket(const char *k, size_t k_sz) const noexcept -> std::optional<uint64_t>;
+
+            /*
+             * Cache the stamped value of k found by a search after taking the ticket. Fails if the
+             * value does not fit or the slot is written since the ticket
+             */
+            auto admit(uint64_t ticket, const char *k, size_t k_sz, const Memory::PolymorphicPointer &ptr,
+                       const_byte_ptr_t value, size_t v_sz) noexcept -> bool;
+
+            // called by the owner of k after the value of k is changed or removed
+            auto invalidate(const char *k, size_t k_sz) noexcept -> void;
+
+        private:
+            std::unique_ptr<HotSlot[]> slots;
+            std::unique_ptr<std::atomic_uint8_t[]> sketch;
+            // only counters that change are counted, so saturated hot keys write nothing shared
+            std::atomic_uint64_t recorded;
+
+            inline auto slot_of(uint64_t hash) const noexcept -> HotSlot & {
+                return slots[hash & (Constants::uHOT_CACHE_SLOTS - 1)];
+            }
+
+            // a zero hash marks empty slots
+            static auto hash_of(const char *k, size_t k_sz) noexcept -> uint64_t;
+
+            auto record(uint64_t hash) noexcept -> void;
+            auto estimate(uint64_t hash) const noexcept -> uint8_t;
+            auto counter_of(uint64_t hash, int row) const noexcept -> std::atomic_uint8_t &;
+        };
+    }
+}
+#endif
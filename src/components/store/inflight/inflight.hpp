@@ -0,0 +1,80 @@
+#ifndef __HILL__STORE__INFLIGHT__INFLIGHT__
+#define __HILL__STORE__INFLIGHT__INFLIGHT__
+
+#include "boost/lockfree/queue.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Messages of one frontend in flight
+ *
+ * An eRPC handler takes a message, hands it to a backend and returns without waiting. The
+ * backend, or a thread that stole the message, completes it to the queue of its frontend, and
+ * the frontend responds when it drains the queue between eRPC events. There are only N
+ * messages, so the queue never overflows, and a frontend with all of them in flight drains
+ * completions until one is free again.
+ */
+namespace Hill {
+    namespace Store {
+        template<typename T, size_t N>
+        class Inflight {
+        public:
+            Inflight() {
+                free.reserve(N);
+                for (auto &i : items) {
+                    free.push_back(&i);
+                }
+            }
+            ~Inflight() = default;
+            Inflight(const Inflight &) = delete;
+            Inflight(Inflight &&) = delete;
+            auto operator=(const Inflight &) -> Inflight & = delete;
+            auto operator=(Inflight &&) -> Inflight & = delete;
+
+            // frontend, poll is called while every message is in flight, it should release some
+            template<typename P>
+            auto acquire(P &&poll) -> T * {
+                while (free.empty()) {
+                    poll();
+                }
+
+                auto ret = free.back();
+                free.pop_back();
+                return ret;
+            }
+
+            // frontend, after the message is responded
+            auto release(T *item) -> void {
+                free.push_back(item);
+            }
+
+            // any thread done with a message of this frontend
+            auto complete(T *item) noexcept -> void {
+                while (!completions.push(item));
+            }
+
+            // frontend, hands every completed message to f, returns how many
+            template<typename F>
+            auto drain(F &&f) -> size_t {
+                size_t ret = 0;
+                T *item;
+                while (completions.pop(item)) {
+                    f(item);
+                    ++ret;
+                }
+                return ret;
+            }
+
+            auto in_flight() const noexcept -> size_t {
+                return N - free.size();
+            }
+
+        private:
+            T items[N];
+            std::vector<T *> free;
+            boost::lockfree::queue<T *, boost::lockfree::capacity<N>> completions;
+        };
+    }
+}
+#endif
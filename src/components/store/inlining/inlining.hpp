@@ -0,0 +1,66 @@
+#ifndef __HILL__STORE__INLINING__INLINING__
+#define __HILL__STORE__INLINING__INLINING__
+
+#include "kv_pair/kv_pair.hpp"
+
+#include <cstring>
+#include <string>
+
+/*
+ * Values inlined in Search responses
+ *
+ * A search answers a pointer and the stamped size of the value, and the client reads the value
+ * by a one-sided read. A small local value is cheaper to copy into the response than to read
+ * in another round trip, so the server copies it, the client validates the copy by its stamp
+ * and skips the read. A value the client can not validate is read as if it were not inlined.
+ */
+namespace Hill {
+    namespace Store {
+        namespace Constants {
+            // stamped values up to this size are copied into Search responses, larger ones are read by clients
+            static constexpr size_t uINLINE_VALUE_SIZE = 128;
+        }
+
+        namespace Inlining {
+            using namespace Memory::TypeAliases;
+
+            /*
+             * copies the stamped value of size bytes of key k at local to out if it is at most limit
+             * bytes, returns the bytes copied and 0 if it is not inlined. The value may be freed by an
+             * update meanwhile, so the copy is validated by its stamp
+             */
+            static inline auto copy(byte_ptr_t out, const_byte_ptr_t local, size_t size, size_t limit,
+                                    const char *k, size_t k_sz) noexcept -> size_t
+            {
+                if (local == nullptr || size > limit) {
+                    return 0;
+                }
+
+                memcpy(out, local, size);
+                if (!KVPair::ValueStamp::validate(out, size, k, k_sz)) {
+                    return 0;
+                }
+                return size;
+            }
+
+            /*
+             * the inlined bytes of a response of resp_size bytes, nullptr if there are none or if the
+             * response is cut short
+             */
+            static inline auto received(const_byte_ptr_t resp, size_t resp_size, const_byte_ptr_t inlined,
+                                        size_t inlined_size) noexcept -> const_byte_ptr_t
+            {
+                if (inlined_size == 0 || size_t(inlined - resp) + inlined_size > resp_size) {
+                    return nullptr;
+                }
+                return inlined;
+            }
+
+            // whether the client takes the inlined value of size stamped bytes instead of reading it
+            static inline auto usable(const_byte_ptr_t inlined, size_t size, const std::string &key) noexcept -> bool {
+                return inlined != nullptr && KVPair::ValueStamp::validate(inlined, size, key.c_str(), key.size());
+            }
+        }
+    }
+}
+#endif
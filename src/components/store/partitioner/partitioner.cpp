@@ -0,0 +1,36 @@
+#include "partitioner.hpp"
+#include "city/city.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+namespace Hill {
+    namespace Store {
+        auto Partitioner::make_range_partitioner(int num, std::vector<std::string> samples) -> Partitioner {
+            if (num <= 1 || samples.empty()) {
+                return make_hash_partitioner(num);
+            }
+
+            Partitioner ret;
+            ret.num = num;
+            ret.ordered = true;
+
+            // strings compare bytes as unsigned chars, the same as HillString
+            std::sort(samples.begin(), samples.end());
+            for (int i = 1; i < num; i++) {
+                ret.boundaries.push_back(samples[samples.size() * i / num]);
+            }
+            return ret;
+        }
+
+        auto Partitioner::partition_of(const char *k, size_t k_sz) const noexcept -> int {
+            if (!ordered) {
+                return CityHash64(k, k_sz) % num;
+            }
+
+            // number of boundaries not greater than k
+            auto it = std::upper_bound(boundaries.begin(), boundaries.end(), std::string_view(k, k_sz));
+            return it - boundaries.begin();
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __HILL__STORE__PARTITIONER__PARTITIONER__
+#define __HILL__STORE__PARTITIONER__PARTITIONER__
+
+#include <string>
+#include <vector>
+
+/*
+ * Mapping keys of a node to its backend workers
+ *
+ * By default keys are hashed, so every range query has to visit all workers and merge
+ * their results. A range partitioner splits the key space into contiguous sub-ranges in
+ * byte order, the order of indices, so that a short scan visits one or two workers and
+ * needs no merging.
+ *
+ * Sub-ranges are cut at quantiles of sample keys. Samples taken from accessed keys,
+ * rather than stored keys, give hot regions narrower sub-ranges and thus balance load
+ * instead of key counts. Each worker still owns its index exclusively, so boundaries are
+ * fixed once workers are launched.
+ */
+namespace Hill {
+    namespace Store {
+        class Partitioner {
+        public:
+            Partitioner() : num(1), ordered(false) {}
+            ~Partitioner() = default;
+            Partitioner(const Partitioner &) = default;
+            Partitioner(Partitioner &&) = default;
+            auto operator=(const Partitioner &) -> Partitioner & = default;
+            auto operator=(Partitioner &&) -> Partitioner & = default;
+
+            static auto make_hash_partitioner(int num) -> Partitioner {
+                Partitioner ret;
+                ret.num = num;
+                return ret;
+            }
+
+            // samples may repeat a key to weigh it
+            static auto make_range_partitioner(int num, std::vector<std::string> samples) -> Partitioner;
+
+            auto partition_of(const char *k, size_t k_sz) const noexcept -> int;
+
+            // true if partition i only holds keys smaller than those of partition i + 1
+            inline auto is_ordered() const noexcept -> bool {
+                return ordered;
+            }
+
+            inline auto get_num_partitions() const noexcept -> int {
+                return num;
+            }
+
+            // the first key of partition i + 1 is boundaries[i]
+            inline auto get_boundaries() const noexcept -> const std::vector<std::string> & {
+                return boundaries;
+            }
+
+        private:
+            int num;
+            bool ordered;
+            std::vector<std::string> boundaries;
+        };
+    }
+}
+#endif
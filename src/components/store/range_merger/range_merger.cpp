@@ -2,8 +2,9 @@
 namespace Hill {
     namespace Store {
         auto Merger::merge(size_t total) -> std::vector<Indexing::ScanHolder> {
-            auto cmp = [](scanholder_iter_ptr_pair &lhs, scanholder_iter_ptr_pair &rhs) -> bool {
-                return *(*lhs.first)->key >= *(*rhs.first)->key;
+            // cached codes decide most comparisons, keys are only read on a tie
+            auto cmp = [&](scanholder_iter_ptr_pair &lhs, scanholder_iter_ptr_pair &rhs) -> bool {
+                return (*lhs.first)->compare(**rhs.first, codec) > 0;
             };
             
             std::priority_queue<scanholder_iter_ptr_pair,
@@ -18,17 +19,15 @@ namespace Hill {
 
             std::vector<Indexing::ScanHolder> ret;
 
-            scanholder_iter_ptr p;
-            while(total > 0) {
-                p = heap.top().first;
-                if (*p == *heap.top().second) {
-                    heap.pop();
-                    continue;
-                }
-                ret.push_back(**p);
+            while(total > 0 && !heap.empty()) {
+                auto [p, end] = heap.top();
                 heap.pop();
-                ++(*p);
+                ret.push_back(**p);
                 --total;
+                // an iterator is advanced only when out of the heap, otherwise the heap is broken
+                if (++(*p) != *end) {
+                    heap.push({p, end});
+                }
             }
 
             return ret;
@@ -17,10 +17,13 @@ namespace Hill {
             auto operator=(const Merger &) -> Merger& = delete;
             auto operator=(Merger &&) -> Merger& = delete;
 
-            static auto make_merger(std::vector<std::vector<Indexing::ScanHolder>> &ranges)
+            // codec should be the one of the indices producing ranges
+            static auto make_merger(std::vector<std::vector<Indexing::ScanHolder>> &ranges,
+                                    const KVPair::KeyCodec &codec = KVPair::KeyCodec())
                 -> std::unique_ptr<Merger>
             {
                 auto ret = std::make_unique<Merger>();
+                ret->codec = codec;
                 
                 for (auto &vec : ranges) {
                     ret->iters.push_back(vec.begin());
@@ -39,6 +42,7 @@ namespace Hill {
             
             std::vector<std::vector<Indexing::ScanHolder>::iterator> iters;
             std::vector<std::vector<Indexing::ScanHolder>::iterator> ends;
+            KVPair::KeyCodec codec;
         };
     }
 }
@@ -0,0 +1,90 @@
+#ifndef __HILL__STORE__RANGE_PAGE__RANGE_PAGE__
+#define __HILL__STORE__RANGE_PAGE__RANGE_PAGE__
+
+#include "kv_pair/kv_pair.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+/*
+ * Pages of range responses
+ *
+ * A page is | uint32_t n | uint8_t more | n x (hill_key_t | trailer) |, keys are in order and
+ * every trailer is of the same size. A page holds as many keys as fit and sets more if some
+ * wanted keys are left out. The client then asks again from the smallest key greater than the
+ * last one it got, which is that key followed by a NUL byte, for the keys it still wants.
+ */
+namespace Hill {
+    namespace Store {
+        namespace RangePage {
+            using namespace KVPair::TypeAliases;
+
+            static constexpr size_t uHEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+            /*
+             * number of the n entries fitting in limit bytes after used ones, entry_size(i) is the
+             * size of the i-th one. used is increased by their sizes
+             */
+            template<typename F>
+            static inline auto fit(size_t n, size_t limit, size_t &used, F &&entry_size) -> size_t {
+                size_t ret = 0;
+                for (; ret < n; ret++) {
+                    auto size = entry_size(ret);
+                    if (used + size > limit) {
+                        break;
+                    }
+                    used += size;
+                }
+                return ret;
+            }
+
+            static inline auto write_header(uint8_t *buf, uint32_t num, bool more) noexcept -> uint8_t * {
+                *reinterpret_cast<uint32_t *>(buf) = num;
+                buf += sizeof(uint32_t);
+                *reinterpret_cast<uint8_t *>(buf) = more;
+                return buf + sizeof(uint8_t);
+            }
+
+            /*
+             * visit(key, trailer) is called for every entry of a page in order, more is set to the
+             * flag of the page. Returns the last key, nullptr for an empty page
+             */
+            template<typename F>
+            static inline auto read(const uint8_t *buf, size_t trailer_size, bool &more, F &&visit)
+                -> const hill_key_t *
+            {
+                auto num = *reinterpret_cast<const uint32_t *>(buf);
+                buf += sizeof(uint32_t);
+                more = *reinterpret_cast<const uint8_t *>(buf);
+                buf += sizeof(uint8_t);
+
+                const hill_key_t *last = nullptr;
+                for (uint32_t i = 0; i < num; i++) {
+                    auto key = reinterpret_cast<const hill_key_t *>(buf);
+                    buf += key->object_size();
+                    visit(key, buf);
+                    buf += trailer_size;
+                    last = key;
+                }
+                return last;
+            }
+
+            /*
+             * num keys of a page are counted off remaining, returns whether the next page is asked
+             * for. A page without keys ends the range even if more is set, nothing else would fit
+             */
+            static inline auto advance(size_t &remaining, size_t num, bool more) noexcept -> bool {
+                remaining -= std::min(num, remaining);
+                return more && num != 0 && remaining != 0;
+            }
+
+            // the smallest key greater than last
+            static inline auto next_key(const hill_key_t *last, std::string &cursor) -> void {
+                cursor.assign(last->raw_chars(), last->size());
+                cursor.push_back('\0');
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,198 @@
+#ifndef __HILL__STORE__RING__RING__
+#define __HILL__STORE__RING__RING__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+ * Single-producer single-consumer ring
+ *
+ * An MPMC queue shared by all frontends makes every push and pop a CAS on the same head
+ * and tail. Instead, each (frontend, backend) pair gets its own ring, so the producer only
+ * writes the tail and the consumer only writes the head. Both indices live on their own
+ * cache lines together with a stale copy of the other side's index, so that the other
+ * side's line is only touched when the ring looks full or empty.
+ */
+namespace Hill {
+    namespace Store {
+        namespace Constants {
+            static constexpr size_t uCACHE_LINE_SIZE = 64;
+        }
+
+        template<typename T, size_t N>
+        class SPSCRing {
+            static_assert(N != 0 && (N & (N - 1)) == 0, "Ring capacity should be a power of 2");
+        public:
+            SPSCRing() : head(0), cached_tail(0), tail(0), cached_head(0) {}
+            ~SPSCRing() = default;
+            SPSCRing(const SPSCRing &) = delete;
+            SPSCRing(SPSCRing &&) = delete;
+            auto operator=(const SPSCRing &) -> SPSCRing & = delete;
+            auto operator=(SPSCRing &&) -> SPSCRing & = delete;
+
+            // producer side, returns false if the ring is full
+            auto push(const T &item) noexcept -> bool {
+                auto t = tail.load(std::memory_order_relaxed);
+                if (t - cached_head == N) {
+                    cached_head = head.load(std::memory_order_acquire);
+                    if (t - cached_head == N) {
+                        return false;
+                    }
+                }
+                slots[t & (N - 1)] = item;
+                tail.store(t + 1, std::memory_order_release);
+                return true;
+            }
+
+            // consumer side, returns false if the ring is empty
+            auto pop(T &item) noexcept -> bool {
+                return pop(&item, 1) == 1;
+            }
+
+            // consumer side, pops at most max items into out and returns the number popped
+            auto pop(T *out, size_t max) noexcept -> size_t {
+                auto h = head.load(std::memory_order_relaxed);
+                if (cached_tail - h < max) {
+                    cached_tail = tail.load(std::memory_order_acquire);
+                }
+
+                auto num = cached_tail - h;
+                if (num > max) {
+                    num = max;
+                }
+                for (size_t i = 0; i < num; i++) {
+                    out[i] = slots[(h + i) & (N - 1)];
+                }
+                if (num != 0) {
+                    head.store(h + num, std::memory_order_release);
+                }
+                return num;
+            }
+
+            // only a hint when called by neither side
+            inline auto empty() const noexcept -> bool {
+                return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+            }
+
+            static constexpr auto capacity() noexcept -> size_t {
+                return N;
+            }
+
+        private:
+            // written by the consumer
+            alignas(Constants::uCACHE_LINE_SIZE) std::atomic_size_t head;
+            size_t cached_tail;
+
+            // written by the producer
+            alignas(Constants::uCACHE_LINE_SIZE) std::atomic_size_t tail;
+            size_t cached_head;
+
+            alignas(Constants::uCACHE_LINE_SIZE) T slots[N];
+        };
+
+        /*
+         * Lets a consumer that found nothing sleep on a futex until a producer pushes
+         *
+         * The consumer announces that it parks and checks its queues once more, a producer checks
+         * the announcement after pushing. Both sides fence in between, so either the consumer sees
+         * the item or the producer sees the announcement and wakes it. Producers pay one fence and
+         * one load of a line that is only written when the consumer parks.
+         */
+        class Parker {
+            static_assert(sizeof(std::atomic_uint32_t) == sizeof(uint32_t), "A futex word is 32 bits");
+        public:
+            Parker() : word(0), parked(false) {}
+            ~Parker() = default;
+            Parker(const Parker &) = delete;
+            Parker(Parker &&) = delete;
+            auto operator=(const Parker &) -> Parker & = delete;
+            auto operator=(Parker &&) -> Parker & = delete;
+
+            // consumer side, sleeps at most timeout_us unless ready() holds once parking is announced
+            template<typename F>
+            auto park(F &&ready, uint64_t timeout_us) noexcept -> void {
+                auto seen = word.load(std::memory_order_acquire);
+                parked.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!ready()) {
+                    struct timespec timeout;
+                    timeout.tv_sec = timeout_us / 1000000;
+                    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+                    // returns at once if a producer bumped the word since seen
+                    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, seen, &timeout,
+                            nullptr, 0);
+                }
+                parked.store(false, std::memory_order_relaxed);
+            }
+
+            // producer side after pushing, returns true if the consumer is parked and woken
+            auto unpark() noexcept -> bool {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!parked.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                word.fetch_add(1, std::memory_order_release);
+                syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+                return true;
+            }
+
+        private:
+            alignas(Constants::uCACHE_LINE_SIZE) std::atomic_uint32_t word;
+            std::atomic_bool parked;
+        };
+
+        /*
+         * Run at most max items of a queue shared with its owner. The first item try_run refuses is
+         * pushed back for the owner and stealing stops there, since the items behind it most likely
+         * fail for the same reason. Returns the number of items run
+         */
+        template<typename Queue, typename F>
+        auto steal_from(Queue &queue, size_t max, F &&try_run) noexcept -> size_t {
+            typename Queue::value_type item;
+            size_t ret = 0;
+            for (size_t n = 0; n < max && queue.pop(item); n++) {
+                if (!try_run(item)) {
+                    while (!queue.push(item));
+                    break;
+                }
+                ++ret;
+            }
+            return ret;
+        }
+
+        /*
+         * The peer other than self with the deepest backlog, only if it is at least min. Returns -1
+         * if no peer is that far behind
+         */
+        static inline auto pick_victim(const std::atomic_int *backlogs, int num, int self, int min) noexcept -> int {
+            int ret = -1;
+            int deepest = min - 1;
+            for (int i = 0; i < num; i++) {
+                if (i == self) {
+                    continue;
+                }
+                if (auto backlog = backlogs[i].load(std::memory_order_relaxed); backlog > deepest) {
+                    ret = i;
+                    deepest = backlog;
+                }
+            }
+            return ret;
+        }
+
+        /*
+         * Whether a search is shared with thieves instead of queued to its owner. Thieves would run it
+         * before writes of the same sender still queued to the owner, and an owner that keeps up
+         * runs it sooner itself
+         */
+        static inline auto shares_search(int inflight_writes, int backlog, int min) noexcept -> bool {
+            return inflight_writes == 0 && backlog >= min;
+        }
+    }
+}
+#endif
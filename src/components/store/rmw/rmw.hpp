@@ -0,0 +1,86 @@
+#ifndef __HILL__STORE__RMW__RMW__
+#define __HILL__STORE__RMW__RMW__
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/*
+ * Value computation of read-modify-write operations
+ *
+ * The server reads the current value, computes the new one here and writes it back in the
+ * same backend, so no other write to the key comes in between. Nothing here touches the
+ * index, so the arithmetic is tested without a store.
+ */
+namespace Hill {
+    namespace Store {
+        namespace RMW {
+            enum class Outcome {
+                Ok,
+                // the expected value of a CompareAndSwap is not the current one
+                Mismatch,
+                // malformed operand, or a FetchAdd on a value that is not a counter
+                Invalid,
+            };
+
+            // operand of CompareAndSwap, the value is replaced by desired only if it equals expected
+            static inline auto make_cas_operand(const std::string &expected, const std::string &desired) -> std::string {
+                uint32_t n = expected.size();
+                std::string ret(reinterpret_cast<const char *>(&n), sizeof(n));
+                return ret.append(expected).append(desired);
+            }
+
+            /*
+             * operand is | uint32_t n | n bytes expected | desired |, see make_cas_operand
+             * desired is set on Ok
+             */
+            static inline auto compare_and_swap(const std::string &old, const char *operand, size_t operand_size,
+                                                std::string &desired) -> Outcome
+            {
+                uint32_t n;
+                if (operand_size < sizeof(n)) {
+                    return Outcome::Invalid;
+                }
+                memcpy(&n, operand, sizeof(n));
+                if (operand_size - sizeof(n) < n) {
+                    return Outcome::Invalid;
+                }
+
+                auto expected = operand + sizeof(n);
+                if (old.size() != n || memcmp(old.data(), expected, n) != 0) {
+                    return Outcome::Mismatch;
+                }
+                desired.assign(expected + n, operand_size - sizeof(n) - n);
+                return Outcome::Ok;
+            }
+
+            /*
+             * old and operand are both 8-byte counters, desired is set on Ok
+             * two's complement, a counter wraps around instead of failing
+             */
+            static inline auto fetch_add(const std::string &old, const char *operand, size_t operand_size,
+                                         std::string &desired) -> Outcome
+            {
+                uint64_t counter, delta;
+                if (old.size() != sizeof(counter) || operand_size != sizeof(delta)) {
+                    return Outcome::Invalid;
+                }
+                memcpy(&counter, old.data(), sizeof(counter));
+                memcpy(&delta, operand, sizeof(delta));
+                counter += delta;
+                desired.assign(reinterpret_cast<const char *>(&counter), sizeof(counter));
+                return Outcome::Ok;
+            }
+
+            static inline auto append(const std::string &old, const char *operand, size_t operand_size,
+                                      std::string &desired) -> Outcome
+            {
+                desired.reserve(old.size() + operand_size);
+                desired.assign(old);
+                desired.append(operand, operand_size);
+                return Outcome::Ok;
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,120 @@
+#ifndef __HILL__STORE__STALLED__STALLED__
+#define __HILL__STORE__STALLED__STALLED__
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+
+/*
+ * Writes of one frontend waiting for remote memory
+ *
+ * Each backend partition asks for its own remote memory, so writes are parked per partition.
+ * A write to a partition that is short of memory either asks for it, waits for a request
+ * already made, or is answered Busy once the partition has parked enough writes. A partition
+ * never waits for the memory of another one, thus every starved partition gets a request.
+ *
+ * Only the frontend touches the parked writes. The memory monitor reads which partitions
+ * need memory and clears them once memory is offered, then the frontend dispatches the
+ * parked writes again.
+ */
+namespace Hill {
+    namespace Store {
+        namespace Enums {
+            enum class Admission {
+                // memory is already asked for, park the write
+                Stall,
+                // ask for memory, then park the write
+                Request,
+                // too many writes are parked, answer Busy
+                Reject,
+            };
+        }
+
+        template<typename T, int P, size_t Bound>
+        class StalledWrites {
+        public:
+            StalledWrites() : num_stalled(0) {
+                for (auto &n : needs) {
+                    n = false;
+                }
+            }
+            ~StalledWrites() = default;
+            StalledWrites(const StalledWrites &) = delete;
+            StalledWrites(StalledWrites &&) = delete;
+            auto operator=(const StalledWrites &) -> StalledWrites & = delete;
+            auto operator=(StalledWrites &&) -> StalledWrites & = delete;
+
+            // frontend, what to do with a write to partition p that is short of memory
+            auto admit(int p) const noexcept -> Enums::Admission {
+                if (queues[p].size() >= Bound) {
+                    return Enums::Admission::Reject;
+                }
+                return needs[p].load() ? Enums::Admission::Stall : Enums::Admission::Request;
+            }
+
+            // frontend, memory of p is asked for, the monitor sees it after this
+            auto request(int p) noexcept -> void {
+                needs[p] = true;
+            }
+
+            auto stall(int p, const T &item) -> void {
+                queues[p].push_back(item);
+                ++num_stalled;
+            }
+
+            // monitor
+            auto needs_memory(int p) const noexcept -> bool {
+                return needs[p].load();
+            }
+
+            auto needs_memory() const noexcept -> bool {
+                for (auto &n : needs) {
+                    if (n.load()) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // monitor, memory of p is offered
+            auto offered(int p) noexcept -> void {
+                needs[p] = false;
+            }
+
+            /*
+             * frontend, for every partition whose memory is offered, released(p) is called once,
+             * then resume(item) for each of its parked writes in order
+             */
+            template<typename R, typename F>
+            auto drain(R &&released, F &&resume) -> void {
+                if (num_stalled == 0) {
+                    return;
+                }
+
+                for (int p = 0; p < P; p++) {
+                    if (queues[p].empty() || needs[p].load()) {
+                        continue;
+                    }
+
+                    released(p);
+                    num_stalled -= queues[p].size();
+                    while (!queues[p].empty()) {
+                        auto item = queues[p].front();
+                        queues[p].pop_front();
+                        resume(item);
+                    }
+                }
+            }
+
+            auto size() const noexcept -> size_t {
+                return num_stalled;
+            }
+
+        private:
+            std::atomic_bool needs[P];
+            std::deque<T> queues[P];
+            size_t num_stalled;
+        };
+    }
+}
+#endif
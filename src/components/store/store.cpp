@@ -16,9 +16,19 @@ namespace Hill {
             }
 
             num_launched_threads = num_threads;
+            if (partition_samples.empty()) {
+                partitioner = Partitioner::make_hash_partitioner(num_threads);
+            } else {
+                partitioner = Partitioner::make_range_partitioner(num_threads, partition_samples);
+#if defined(__HILL_DEBUG__) || defined(__HILL_INFO__)
+                std::cout << ">> Keys are range partitioned by " << partition_samples.size() << " samples\n";
+#endif
+            }
             int i;
             for (i = 0; i < num_threads; i++) {
                 std::thread([&](int btid) {
+                    // pinned before anything is allocated so that DRAM of this thread is local
+                    server->get_placement().apply(Placement::Enums::Role::Backend, btid);
                     tid_lock.lock();
                     auto atid = server->get_allocator()->register_thread();
                     if (!atid.has_value()) {
@@ -40,65 +50,186 @@ namespace Hill {
                     std::cout << ">> Launching background thread " << btid << "\n";
 #endif
 
-                    Indexing::OLFIT olfit(atid.value(), server->get_allocator(), server->get_logger());
+                    olfits[btid] = std::make_unique<Indexing::OLFIT>(atid.value(), server->get_allocator(), server->get_logger());
+                    auto &olfit = *olfits[btid];
+                    olfit.enable_key_codec(server->get_key_codec());
                     leaves[btid] = olfit.get_root().get_as<Indexing::LeafNode *>();
-                    while (is_launched) {
-                        IncomeMessage *msg;
-                        if (req_queues[btid].pop(msg)) {
-                            switch (msg->input.op) {
-                            case Enums::RPCOperations::Update: {
-                                auto [status, value_ptr] = olfit.update(tid, msg->input.key, msg->input.key_size,
-                                                                        msg->input.value, msg->input.value_size);
-                                msg->output.value = value_ptr;
-                                msg->output.status.store(status);
-                                // update here is not atomic but it's ok,
-                                // because we just send temporal values to other servers and get_consumed is atomic
-                                // so we wouldn't have INCORRECT values
-                                server->get_node()->available_pm = server->get_node()->total_pm - server->get_allocator()->get_consumed();
+                    indexes[btid] = &olfit;
+#ifdef __HILL_VALUE_LOG__
+                    auto vlog = server->get_value_log();
+                    olfit.enable_value_log(vlog);
+                    // only this thread modifies olfit, so victims of this thread are relocated here
+                    auto relocate = [&](const char *k, size_t k_sz, const byte_ptr_t &old, const byte_ptr_t &copy) {
+                        if (!olfit.relocate(k, k_sz, old, copy)) {
+                            return false;
+                        }
+                        hot_cache->invalidate(k, k_sz);
+                        return true;
+                    };
+#endif
+
+                    auto execute = [&](IncomeMessage *msg) -> Indexing::Enums::OpStatus {
+                        switch (msg->input.op) {
+                        case Enums::RPCOperations::Update: {
+                            auto [status, value_ptr] = olfit.update(tid, msg->input.key, msg->input.key_size,
+                                                                    msg->input.value, msg->input.value_size);
+                            msg->output.value = value_ptr;
+                            // after the index, so that a search missing the cache finds the new value
+                            if (status == Indexing::Enums::OpStatus::Ok) {
+                                hot_cache->invalidate(msg->input.key, msg->input.key_size);
                             }
-                                break;
-                            case Enums::RPCOperations::Insert: {
-                                auto [status, value_ptr] = olfit.insert(tid, msg->input.key, msg->input.key_size,
-                                                                        msg->input.value, msg->input.value_size,
-                                                                        msg->input.hkey, msg->input.hvalue);
-                                msg->output.value = value_ptr;
-                                msg->output.status.store(status);
-
-                                server->get_node()->available_pm = server->get_node()->total_pm - server->get_allocator()->get_consumed();
+                            // update here is not atomic but it's ok,
+                            // because we just send temporal values to other servers and get_consumed is atomic
+                            // so we wouldn't have INCORRECT values
+                            server->get_node()->available_pm = server->get_node()->total_pm - server->get_allocator()->get_consumed();
+                            return status;
+                        }
+                        case Enums::RPCOperations::CompareAndSwap:
+                        case Enums::RPCOperations::FetchAdd:
+                        case Enums::RPCOperations::Append: {
+                            auto status = modify(olfit, tid, msg);
+                            if (status == Indexing::Enums::OpStatus::Ok) {
+                                hot_cache->invalidate(msg->input.key, msg->input.key_size);
                             }
-                                break;
-                            case Enums::RPCOperations::Search: {
-                                auto [v, v_sz] = olfit.search(msg->input.key, msg->input.key_size);
-                                if (v == nullptr) {
-                                    msg->output.value = nullptr;
-                                    msg->output.status.store(Indexing::Enums::OpStatus::Failed);
-                                    break;
-                                }
-                                msg->output.value = v;
-                                msg->output.value_size = v_sz;
-                                msg->output.status.store(Indexing::Enums::OpStatus::Ok);
+                            server->get_node()->available_pm = server->get_node()->total_pm - server->get_allocator()->get_consumed();
+                            return status;
+                        }
+                        case Enums::RPCOperations::Insert: {
+                            auto [status, value_ptr] = olfit.insert(tid, msg->input.key, msg->input.key_size,
+                                                                    msg->input.value, msg->input.value_size,
+                                                                    msg->input.hkey, msg->input.hvalue);
+                            msg->output.value = value_ptr;
+
+                            server->get_node()->available_pm = server->get_node()->total_pm - server->get_allocator()->get_consumed();
+                            return status;
+                        }
+                        case Enums::RPCOperations::Search: {
+                            auto [v, v_sz] = olfit.search(msg->input.key, msg->input.key_size);
+                            if (v == nullptr) {
+                                msg->output.value = nullptr;
+                                return Indexing::Enums::OpStatus::Failed;
                             }
-                                break;
-                            case Enums::RPCOperations::Range: {
-                                auto vec = olfit.scan(msg->input.key, msg->input.key_size, msg->input.value_size);
-                                msg->output.values = std::move(vec);
-                                if (vec.size() != 0) {
-                                    msg->output.status.store(Indexing::Enums::OpStatus::Ok);
-                                } else {
-                                    msg->output.status.store(Indexing::Enums::OpStatus::Failed);
-                                }
+                            msg->output.value = v;
+                            msg->output.value_size = v_sz;
+                            return Indexing::Enums::OpStatus::Ok;
+                        }
+                        case Enums::RPCOperations::Range: {
+                            msg->output.values = olfit.scan(msg->input.key, msg->input.key_size, msg->input.value_size);
+                            if (msg->output.values.size() != 0) {
+                                return Indexing::Enums::OpStatus::Ok;
+                            }
+                            return Indexing::Enums::OpStatus::Failed;
+                        }
+                        case Enums::RPCOperations::CallForMemory:
+                            olfit.enable_agent(msg->input.agent);
+                            return Indexing::Enums::OpStatus::Ok;
+                        default:
+                            return Indexing::Enums::OpStatus::Failed;
+                        }
+                    };
+
+                    /*
+                     * Drain up to iGROUP_COMMIT_SIZE messages and run them as one WAL group, so that
+                     * the whole batch is made durable by a single fence. Statuses are published only
+                     * after the group ends because eRPC handlers acknowledge as soon as they see one.
+                     */
+                    IncomeMessage *batch[Constants::iGROUP_COMMIT_SIZE];
+                    Indexing::Enums::OpStatus statuses[Constants::iGROUP_COMMIT_SIZE];
+
+                    // searches of the same key drained together are run once
+                    SearchCoalescer<Constants::iGROUP_COMMIT_SIZE> coalescer;
+                    auto execute_coalesced = [&](size_t m) {
+                        auto msg = batch[m];
+                        auto op = msg->input.op;
+                        if (op != Enums::RPCOperations::Search && !(Enums::writes(op) && !coalescer.empty())) {
+                            statuses[m] = execute(msg);
+                            return;
+                        }
+
+                        auto hash = CityHash64(msg->input.key, msg->input.key_size);
+                        if (op != Enums::RPCOperations::Search) {
+                            coalescer.written(hash);
+                            statuses[m] = execute(msg);
+                            return;
+                        }
+
+                        auto leader = coalescer.leader_of(hash, [&](size_t r) {
+                            return batch[r]->input.key_size == msg->input.key_size &&
+                                memcmp(batch[r]->input.key, msg->input.key, msg->input.key_size) == 0;
+                        });
+                        if (leader != coalescer.npos) {
+                            msg->output.value = batch[leader]->output.value;
+                            msg->output.value_size = batch[leader]->output.value_size;
+                            statuses[m] = statuses[leader];
+                            return;
+                        }
+
+                        statuses[m] = execute(msg);
+                        coalescer.lead(m, hash);
+                    };
+                    auto logger = server->get_logger();
+                    int cursor = 0;
+                    int idle = 0;
+                    while (is_launched) {
+                        size_t num = 0;
+                        for (int p = 0; p < Constants::iNUM_PRODUCERS && num < Constants::iGROUP_COMMIT_SIZE; p++) {
+                            auto &ring = req_rings[(cursor + p) % Constants::iNUM_PRODUCERS][btid];
+                            num += ring.pop(batch + num, Constants::iGROUP_COMMIT_SIZE - num);
+                        }
+                        // the next round starts from another producer so that none of them starves
+                        cursor = (cursor + 1) % Constants::iNUM_PRODUCERS;
+                        while (num < Constants::iGROUP_COMMIT_SIZE && shared_searches[btid].pop(batch[num])) {
+                            ++num;
+                        }
+                        backlogs[btid].store(num, std::memory_order_relaxed);
+
+                        if (num == 0) {
+                            if (steal(btid)) {
+                                idle = 0;
+                                continue;
                             }
-                                break;
-                            case Enums::RPCOperations::CallForMemory:
-                                olfit.enable_agent(msg->input.agent);
-                                msg->output.status.store(Indexing::Enums::OpStatus::Ok);
-                                break;
-                            default:
-                                msg->output.status.store(Indexing::Enums::OpStatus::Failed);
-                                break;
+#ifdef __HILL_VALUE_LOG__
+                            vlog->clean(tid, relocate);
+#endif
+                            // spinning covers short gaps of a busy node, an idle one leaves the core
+                            if (++idle == Constants::iIDLE_ROUNDS) {
+                                idle = 0;
+                                parkers[btid].park([&] { return !is_launched || has_work(btid); },
+                                                   Constants::uPARK_TIMEOUT_US);
+                            }
+                            continue;
+                        }
+                        idle = 0;
+
+                        // optimistic readers of this partition back off until the group is published
+                        bool writes = false;
+                        for (size_t m = 0; m < num && !writes; m++) {
+                            writes = Enums::writes(batch[m]->input.op);
+                        }
+                        if (writes) {
+                            group_seqs[btid].open();
+                        }
+                        logger->begin_group(tid);
+                        coalescer.reset();
+                        for (size_t m = 0; m < num; m++) {
+                            execute_coalesced(m);
+                        }
+                        logger->end_group(tid);
+                        if (writes) {
+                            group_seqs[btid].close();
+                        }
+
+                        for (size_t m = 0; m < num; m++) {
+                            auto from = batch[m]->input.from;
+                            batch[m]->output.status.store(statuses[m]);
+                            // the frontend responds when it drains its completions
+                            if (from != nullptr) {
+                                from->messages.complete(batch[m]);
                             }
                         }
                     }
+                    // frontends may still hold the tree, it is freed with the server
+                    indexes[btid] = nullptr;
                 }, i).detach();
             }
 
@@ -119,6 +250,7 @@ namespace Hill {
             }
 
             std::thread t([&, sock]() {
+                server->get_placement().apply(Placement::Enums::Role::Service);
                 while(is_launched) {
                     auto socket = Misc::accept_blocking(sock);
 
@@ -130,7 +262,7 @@ namespace Hill {
                         shutdown(socket, 0);
                         continue;
                     }
-                    sleep(1);
+                    Misc::wait_readable(sock, Misc::Constants::iACCEPT_WAIT_MS);
                 }
             });
             t.detach();
@@ -140,29 +272,48 @@ namespace Hill {
 
         auto StoreServer::launch_one_memory_monitor_thread() -> bool {
             std::thread t([&] {
+                server->get_placement().apply(Placement::Enums::Role::Service);
                 auto rm_rpc =  new erpc::Rpc<erpc::CTransport>(this->nexus, reinterpret_cast<void *>(this),
                                                                Memory::Constants::iTHREAD_LIST_NUM,
                                                                RPCWrapper::ghost_sm_handler);
                 IncomeMessage msg;
                 while(this->is_launched) {
+                    {
+                        // woken by frontends asking for memory, the timeout only notices a missed stop
+                        std::unique_lock<std::mutex> l(this->monitor_lock);
+                        this->monitor_cv.wait_for(l, std::chrono::seconds(1), [&] {
+                            return !this->is_launched || this->needs_memory();
+                        });
+                    }
+
                     for (auto &i : this->contexts) {
                         if (i == nullptr)
                             continue;
 
-                        if (i->need_memory.load() == true) {
-                            auto ptr = check_available_mem(rm_rpc, *i, this->index_ids[i->thread_id]);
-                            server->get_agent()->add_region(this->index_ids[i->thread_id], ptr);
+                        // every starved partition gets its own memory
+                        for (int p = 0; p < Memory::Constants::iTHREAD_LIST_NUM; p++) {
+                            if (!i->stalled.needs_memory(p)) {
+                                continue;
+                            }
+
+                            auto start = std::chrono::steady_clock::now();
+                            auto ptr = check_available_mem(rm_rpc, *i, p);
+                            server->get_agent()->add_region(p, ptr);
 
                             msg.input.op = Enums::RPCOperations::CallForMemory;
                             msg.input.agent = server->get_agent();
-                            while(!i->queues[this->index_ids[i->thread_id]].push(&msg));
+                            msg.output.status = Indexing::Enums::OpStatus::Unkown;
+                            auto &ring = this->req_rings[Constants::iMONITOR_PRODUCER][p];
+                            while(!ring.push(&msg));
+                            this->parkers[p].unpark();
 
                             while(msg.output.status.load() == Indexing::Enums::OpStatus::Unkown);
 
-                            i->need_memory.store(false);
+                            i->stalled.offered(p);
+                            auto elapsed = std::chrono::steady_clock::now() - start;
+                            this->retry_after_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
                         }
                     }
-                    sleep(1);
                 }
             });
             t.detach();
@@ -170,6 +321,75 @@ namespace Hill {
             return true;
         }
 
+        auto StoreServer::has_work(int btid) noexcept -> bool {
+            for (int p = 0; p < Constants::iNUM_PRODUCERS; p++) {
+                if (!req_rings[p][btid].empty()) {
+                    return true;
+                }
+            }
+            // peers that are behind are not work, dispatch wakes a parked thief when it shares a search
+            return !shared_searches[btid].empty();
+        }
+
+        auto StoreServer::steal(int btid) -> bool {
+            auto victim = pick_victim(backlogs, num_launched_threads, btid, Constants::iSTEAL_BACKLOG);
+            if (victim == -1) {
+                return false;
+            }
+
+            auto index = indexes[victim].load();
+            if (index == nullptr) {
+                return false;
+            }
+
+            bool refused = false;
+            auto done = steal_from(shared_searches[victim], Constants::iSTEAL_BATCH, [&](IncomeMessage *msg) {
+                auto found = search_published(victim, index, msg->input.key, msg->input.key_size);
+                // the owner keeps modifying the leaf, it runs the search when it drains the queue
+                if (!found.has_value()) {
+                    refused = true;
+                    return false;
+                }
+
+                auto [v, v_sz] = found.value();
+                msg->output.value = v;
+                msg->output.value_size = v_sz;
+                msg->output.status.store(v == nullptr ? Indexing::Enums::OpStatus::Failed : Indexing::Enums::OpStatus::Ok);
+                msg->input.from->messages.complete(msg);
+                return true;
+            });
+            if (refused) {
+                parkers[victim].unpark();
+            }
+            // a thief that only hands searches back is idle, it should park rather than spin on them
+            return done != 0;
+        }
+
+        auto StoreServer::search_published(int partition, const Indexing::OLFIT *index, const char *k, size_t k_sz)
+            const noexcept -> std::optional<std::pair<Memory::PolymorphicPointer, size_t>>
+        {
+            return group_seqs[partition].read([&] {
+                return index->optimistic_search(k, k_sz);
+            });
+        }
+
+        auto StoreServer::wake_monitor() -> void {
+            // the partition is marked before, so the monitor either sees it or is waiting and gets notified
+            {
+                std::scoped_lock<std::mutex> _(monitor_lock);
+            }
+            monitor_cv.notify_one();
+        }
+
+        auto StoreServer::needs_memory() const noexcept -> bool {
+            for (auto &i : contexts) {
+                if (i != nullptr && i->stalled.needs_memory()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         auto StoreServer::register_erpc_handler_thread() noexcept -> std::optional<std::thread> {
             if (!is_launched) {
                 return {};
@@ -178,12 +398,13 @@ namespace Hill {
             auto tid = server->register_thread();
 
             return std::thread([&] (int tid) {
+                this->server->get_placement().apply(Placement::Enums::Role::Frontend, tid);
                 ServerContext s_ctx;
                 s_ctx.thread_id = tid;
                 s_ctx.self = this;
                 s_ctx.node_id = this->server->get_node()->node_id;
                 s_ctx.server = this->server.get();
-                s_ctx.queues = this->req_queues;
+                s_ctx.queues = this->req_rings[tid];
                 s_ctx.num_launched_threads = this->num_launched_threads;
 
                 s_ctx.handle_sampler = new HandleSampler(10000);
@@ -200,8 +421,16 @@ namespace Hill {
 
                 this->contexts[tid] = &s_ctx;
 
-                while(true) {
-                    s_ctx.rpc->run_event_loop(2000);
+                // handlers only dispatch, responses are sent once backends complete
+                auto report = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+                // stopped frontends are joined before the server and the trees they search are freed
+                while(this->is_launched) {
+                    s_ctx.rpc->run_event_loop_once();
+                    poll_completions(&s_ctx);
+                    if (std::chrono::steady_clock::now() < report) {
+                        continue;
+                    }
+                    report = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
 #ifdef __HILL_INFO__
                     std::cout << ">> Insert breakdown: "; s_ctx.handle_sampler->report_insert(); std::cout << "\n";
                     std::cout << ">> Search breakdown: "; s_ctx.handle_sampler->report_search(); std::cout << "\n";
@@ -210,10 +439,37 @@ namespace Hill {
 #endif
                 }
 
+                this->contexts[tid] = nullptr;
                 this->server->unregister_thread(tid);
             }, tid);
         }
 
+        auto StoreServer::parse_partition_samples(const std::string &config) -> bool {
+            auto content = Misc::file_as_string(config);
+            if (!content.has_value()) {
+                return false;
+            }
+
+            auto file = ConfigReader::read_partition_samples(content.value());
+            if (!file.has_value()) {
+                return false;
+            }
+
+            std::ifstream in(file.value());
+            if (!in) {
+                std::cerr << ">> Error: can't open partition samples " << file.value() << "\n";
+                return false;
+            }
+
+            std::string line;
+            while (std::getline(in, line)) {
+                if (!line.empty()) {
+                    partition_samples.push_back(line);
+                }
+            }
+            return !partition_samples.empty();
+        }
+
         auto StoreServer::use_agent() noexcept -> void {
 
         }
@@ -326,6 +582,98 @@ namespace Hill {
             reinterpret_cast<ServerContext *>(tag)->is_done = true;
         }
 
+        auto StoreServer::acquire_message(ServerContext *ctx) -> IncomeMessage * {
+            // every message is in flight, responding to some of them returns their messages
+            auto msg = ctx->messages.acquire([&] {
+                poll_completions(ctx);
+            });
+            msg->reset();
+            msg->input.from = ctx;
+            return msg;
+        }
+
+        auto StoreServer::release_message(ServerContext *ctx, IncomeMessage *msg) -> void {
+            ctx->messages.release(msg);
+        }
+
+        auto StoreServer::dispatch(ServerContext *ctx, IncomeMessage *msg) -> void {
+            msg->output.status = Indexing::Enums::OpStatus::Unkown;
+            auto self = ctx->self;
+            auto partition = msg->input.partition;
+            // counted down in poll_completions, a write answered NoMemory is counted again when dispatched again
+            if (Enums::writes(msg->input.op)) {
+                ++ctx->inflight_writes[partition];
+            }
+            if (msg->input.op == Enums::RPCOperations::Search &&
+                shares_search(ctx->inflight_writes[partition], self->backlogs[partition].load(std::memory_order_relaxed),
+                              Constants::iSTEAL_BACKLOG) &&
+                self->shared_searches[partition].push(msg)) {
+                // the owner is busy, one parked backend is enough to help it
+                for (int i = 0; i < ctx->num_launched_threads; i++) {
+                    if (i != int(partition) && self->parkers[i].unpark()) {
+                        break;
+                    }
+                }
+                return;
+            }
+            // a full shared queue means thieves do not keep up either, the owner takes it then
+            while(!ctx->queues[partition].push(msg));
+            self->parkers[partition].unpark();
+        }
+
+        auto StoreServer::request_memory(ServerContext *ctx, IncomeMessage *msg) -> void {
+            auto partition = msg->input.partition;
+            auto admission = ctx->stalled.admit(partition);
+            // the eRPC thread never waits for remote memory, writes beyond the bound are retried by clients
+            if (admission == Enums::Admission::Reject) {
+                reject(ctx, msg);
+                return;
+            }
+
+            // one request per frontend thread and partition, later messages wait for the same one
+            if (admission == Enums::Admission::Request) {
+                // released when the memory monitor is done, so that other frontends do not ask twice
+                if (!ctx->self->agent_locks[partition].try_lock()) {
+                    // another frontend is asking for memory of this partition
+                    reject(ctx, msg);
+                    return;
+                }
+                if (msg->output.status.load() != Indexing::Enums::OpStatus::NoMemory &&
+                    ctx->server->get_agent()->available(partition)) {
+                    // memory is offered while waiting for the lock
+                    ctx->self->agent_locks[partition].unlock();
+                    dispatch(ctx, msg);
+                    return;
+                }
+#ifdef __HILL_INFO__
+                std::cout << "Fthread " << ctx->thread_id << " asking for remote memory for Bthread " << partition << "\n";
+#endif
+                ctx->stalled.request(partition);
+                ctx->self->wake_monitor();
+            }
+            ctx->stalled.stall(partition, msg);
+        }
+
+        auto StoreServer::reject(ServerContext *ctx, IncomeMessage *msg) -> void {
+            msg->output.status = Indexing::Enums::OpStatus::Retry;
+            respond(ctx, msg);
+        }
+
+        auto StoreServer::poll_completions(ServerContext *ctx) -> void {
+            ctx->messages.drain([&](IncomeMessage *msg) {
+                if (Enums::writes(msg->input.op)) {
+                    --ctx->inflight_writes[msg->input.partition];
+                }
+                respond(ctx, msg);
+            });
+
+            ctx->stalled.drain([&](int partition) {
+                ctx->self->agent_locks[partition].unlock();
+            }, [&](IncomeMessage *stalled) {
+                dispatch(ctx, stalled);
+            });
+        }
+
         auto StoreServer::insert_handler(erpc::ReqHandle *req_handle, void *context) -> void {
             auto ctx = reinterpret_cast<ServerContext *>(context);
             auto server = ctx->server;
@@ -345,19 +693,19 @@ namespace Hill {
 #ifdef __HILL_SAMPLE__
             }
 #endif
-            IncomeMessage msg;
-            msg.input.key = key->raw_chars();
-            msg.input.key_size = key->size();
-            msg.input.value = value->raw_chars();
-            msg.input.value_size = value->size();
-            msg.input.op = type;
+            auto msg = acquire_message(ctx);
+            msg->input.req_handle = req_handle;
+            msg->input.key = key->raw_chars();
+            msg->input.key_size = key->size();
+            msg->input.value = value->raw_chars();
+            msg->input.value_size = value->size();
+            msg->input.op = type;
 
-            msg.input.hkey = key;
-            msg.input.hvalue = value;
+            msg->input.hkey = key;
+            msg->input.hvalue = value;
 
-            msg.output.status = Indexing::Enums::OpStatus::Unkown;
             // this is fast we do not need to sample
-            auto pos = CityHash64(msg.input.key, msg.input.key_size) % ctx->num_launched_threads;
+            msg->input.partition = ctx->self->partitioner.partition_of(msg->input.key, msg->input.key_size);
             auto allowed = Constants::dNODE_CAPPACITY_LIMIT * server->get_node()->total_pm;
             bool insufficient = false;
 #ifdef __HILL_SAMPLE__
@@ -365,85 +713,15 @@ namespace Hill {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::CAP_CHECK);
 #endif
                 insufficient = server->get_allocator()->get_consumed() >= allowed &&
-                    !server->get_agent()->available(pos);
-                if (insufficient) {
-                    ctx->self->agent_locks[pos].lock();
-                    insufficient = server->get_allocator()->get_consumed() >= allowed &&
-                        !server->get_agent()->available(pos);
-
-                    if (insufficient) {
-#ifdef __HILL_INFO__
-                        std::cout << "Fthread " << ctx->thread_id << " asking for remote memory for Bthread " << pos << "\n";
-#endif
-                        ctx->self->index_ids[ctx->thread_id] = pos;
-                        ctx->self->contexts[ctx->thread_id]->need_memory = true;
-
-                        while(ctx->self->contexts[ctx->thread_id]->need_memory);
-
-                    }
-                    ctx->self->agent_locks[pos].unlock();
-                }
+                    !server->get_agent()->available(msg->input.partition);
 #ifdef __HILL_SAMPLE__
             }
 #endif
-        retry:
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::INDEXING);
-#endif
-                while(!ctx->queues[pos].push(&msg));
-
-                while(msg.output.status.load() == Indexing::Enums::OpStatus::Unkown);
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-            auto &resp = req_handle->pre_resp_msgbuf;
-            constexpr auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + sizeof(Memory::PolymorphicPointer);
-            ctx->rpc->resize_msg_buffer(&resp, total_msg_size);
-
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP_MSG);
-#endif
-
-                *reinterpret_cast<Enums::RPCOperations *>(resp.buf) = Enums::RPCOperations::Insert;
-                auto offset = sizeof(Enums::RPCOperations);
-                switch(msg.output.status.load()){
-                case Indexing::Enums::OpStatus::Ok:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Ok;
-                    break;
-                case Indexing::Enums::OpStatus::NoMemory:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::NoMemory;
-                    // agent's memory is available but not sufficient;
-                    ctx->self->agent_locks[pos].lock();
-                    ctx->self->index_ids[ctx->thread_id] = pos;
-                    ctx->self->contexts[ctx->thread_id]->need_memory = true;
-
-                    while(ctx->self->contexts[ctx->thread_id]->need_memory);
-                    ctx->self->agent_locks[pos].unlock();
-
-                    goto retry;
-                default:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Failed;
-                    break;
-                }
-
-                offset += sizeof(Enums::RPCStatus);
-                *reinterpret_cast<Memory::PolymorphicPointer *>(resp.buf + offset) = msg.output.value;
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP);
-#endif
-                ctx->rpc->enqueue_response(req_handle, &resp);
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-            if (msg.output.status.load() == Indexing::Enums::OpStatus::Failed) {
-                std::cout << "Inserting " << key->to_string() << " failed\n";
+            if (insufficient) {
+                request_memory(ctx, msg);
+                return;
             }
+            dispatch(ctx, msg);
         }
 
         auto StoreServer::update_handler(erpc::ReqHandle *req_handle, void *context) -> void {
@@ -465,15 +743,15 @@ namespace Hill {
 #ifdef __HILL_SAMPLE__
             }
 #endif
-            IncomeMessage msg;
-            msg.input.key = key->raw_chars();
-            msg.input.key_size = key->size();
-            msg.input.value = value->raw_chars();
-            msg.input.value_size = value->size();
-            msg.input.op = type;
+            auto msg = acquire_message(ctx);
+            msg->input.req_handle = req_handle;
+            msg->input.key = key->raw_chars();
+            msg->input.key_size = key->size();
+            msg->input.value = value->raw_chars();
+            msg->input.value_size = value->size();
+            msg->input.op = type;
 
-            msg.output.status = Indexing::Enums::OpStatus::Unkown;
-            auto pos = CityHash64(msg.input.key, msg.input.key_size) % ctx->num_launched_threads;
+            msg->input.partition = ctx->self->partitioner.partition_of(msg->input.key, msg->input.key_size);
             auto allowed = Constants::dNODE_CAPPACITY_LIMIT * server->get_node()->total_pm;
             bool insufficient = false;
 #ifdef __HILL_SAMPLE__
@@ -481,84 +759,15 @@ namespace Hill {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::CAP_CHECK);
 #endif
                 insufficient = server->get_allocator()->get_consumed() >= allowed &&
-                    !server->get_agent()->available(pos);
-                if (insufficient) {
-                    ctx->self->agent_locks[pos].lock();
-                    insufficient = server->get_allocator()->get_consumed() >= allowed &&
-                        !server->get_agent()->available(pos);
-
-                    if (insufficient) {
-#ifdef __HILL_INFO__
-                        std::cout << "Fthread " << ctx->thread_id << " asking for remote memory for Bthread " << pos << "\n";
-#endif
-                        ctx->self->index_ids[ctx->thread_id] = pos;
-                        ctx->self->contexts[ctx->thread_id]->need_memory = true;
-
-                        while(ctx->self->contexts[ctx->thread_id]->need_memory);
-
-                    }
-                    ctx->self->agent_locks[pos].unlock();
-                }
+                    !server->get_agent()->available(msg->input.partition);
 #ifdef __HILL_SAMPLE__
             }
 #endif
-        retry:
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::INDEXING);
-#endif
-                while(!ctx->queues[pos].push(&msg));
-
-                while(msg.output.status.load() == Indexing::Enums::OpStatus::Unkown);
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-            auto &resp = req_handle->pre_resp_msgbuf;
-            constexpr auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + sizeof(Memory::PolymorphicPointer);
-            ctx->rpc->resize_msg_buffer(&resp, total_msg_size);
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP_MSG);
-#endif
-                *reinterpret_cast<Enums::RPCOperations *>(resp.buf) = Enums::RPCOperations::Update;
-                auto offset = sizeof(Enums::RPCOperations);
-
-                switch(msg.output.status.load()){
-                case Indexing::Enums::OpStatus::Ok:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Ok;
-                    break;
-                case Indexing::Enums::OpStatus::NoMemory:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::NoMemory;
-                    // agent's memory is available but not sufficient;
-                    ctx->self->agent_locks[pos].lock();
-                    ctx->self->index_ids[ctx->thread_id] = pos;
-                    ctx->self->contexts[ctx->thread_id]->need_memory = true;
-
-                    while(ctx->self->contexts[ctx->thread_id]->need_memory);
-                    ctx->self->agent_locks[pos].unlock();
-
-                    goto retry;
-                default:
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Failed;
-                    break;
-                }
-
-                offset += sizeof(Enums::RPCStatus);
-                *reinterpret_cast<Memory::PolymorphicPointer *>(resp.buf + offset) = msg.output.value;
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-#ifdef __HILL_SAMPLE__
-            {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP);
-#endif
-                ctx->rpc->enqueue_response(req_handle, &resp);
-#ifdef __HILL_SAMPLE__
-            }
-#endif
-            if (msg.output.status.load() == Indexing::Enums::OpStatus::Failed) {
-                std::cout << "Updating " << key->to_string() << " failed\n";
+            if (insufficient) {
+                request_memory(ctx, msg);
+                return;
             }
+            dispatch(ctx, msg);
         }
 
         auto StoreServer::search_handler(erpc::ReqHandle *req_handle, void *context) -> void {
@@ -579,52 +788,143 @@ namespace Hill {
 #ifdef __HILL_SAMPLE__
             }
 #endif
-            IncomeMessage msg;
-            msg.input.key = key->raw_chars();
-            msg.input.key_size = key->size();
-            msg.input.op = type;
-            msg.output.status = Indexing::Enums::OpStatus::Unkown;
+            UNUSED(value);
+            auto msg = acquire_message(ctx);
+            msg->input.req_handle = req_handle;
+            msg->input.key = key->raw_chars();
+            msg->input.key_size = key->size();
+            msg->input.op = type;
+            msg->input.partition = ctx->self->partitioner.partition_of(msg->input.key, msg->input.key_size);
+            if (search_in_place(ctx, msg)) {
+                return;
+            }
+            dispatch(ctx, msg);
+        }
+
+        auto StoreServer::search_in_place(ServerContext *ctx, IncomeMessage *msg) -> bool {
+            // the backend runs the search after the write, as the client sent them
+            if (ctx->inflight_writes[msg->input.partition] != 0) {
+                return false;
+            }
+
+            auto index = ctx->self->indexes[msg->input.partition].load();
+            if (index == nullptr) {
+                return false;
+            }
 
-            auto pos = CityHash64(msg.input.key, msg.input.key_size) % ctx->num_launched_threads;
+            // entries of a batched response carry no values
+            auto hot_cache = ctx->self->hot_cache.get();
+            auto inlinable = msg->input.batch == nullptr;
+            std::optional<uint64_t> ticket;
+            if (inlinable) {
+                Memory::PolymorphicPointer ptr;
+                if (auto size = hot_cache->get(msg->input.key, msg->input.key_size, msg->output.inlined, ptr); size != 0) {
+                    msg->output.value = ptr;
+                    msg->output.value_size = size;
+                    msg->output.inlined_size = size;
+                    msg->output.status = Indexing::Enums::OpStatus::Ok;
+                    respond(ctx, msg);
+                    return true;
+                }
+                ticket = hot_cache->ticket(msg->input.key, msg->input.key_size);
+            }
+
+            std::optional<std::pair<Memory::PolymorphicPointer, size_t>> found;
 #ifdef __HILL_SAMPLE__
             {
-                SampleRecorder<uint64_t> _(sampler, HandleSampler::INDEXING);
+                SampleRecorder<uint64_t> _(ctx->handle_sampler->search_sampler, HandleSampler::INDEXING);
 #endif
-                while(!ctx->queues[pos].push(&msg));
-
-                while(msg.output.status.load() == Indexing::Enums::OpStatus::Unkown);
+                found = ctx->self->search_published(msg->input.partition, index, msg->input.key, msg->input.key_size);
 #ifdef __HILL_SAMPLE__
             }
 #endif
-            auto& resp = req_handle->pre_resp_msgbuf;
-            constexpr auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Memory::PolymorphicPointer)
-                + sizeof(size_t) + sizeof(Enums::RPCStatus);
+            // the backend keeps modifying the leaf or has not published it, let it search instead
+            if (!found.has_value()) {
+                return false;
+            }
+
+            auto [v, v_sz] = found.value();
+            msg->output.value = v;
+            msg->output.value_size = v_sz;
+            msg->output.status = v == nullptr ? Indexing::Enums::OpStatus::Failed : Indexing::Enums::OpStatus::Ok;
+
+            // hot values are inlined even if they are larger than small ones
+            if (ticket.has_value() && inline_value(msg, Constants::uHOT_VALUE_SIZE)) {
+                hot_cache->admit(ticket.value(), msg->input.key, msg->input.key_size, v, msg->output.inlined, v_sz);
+            }
+            respond(ctx, msg);
+            return true;
+        }
+
+        auto StoreServer::inline_value(IncomeMessage *msg, size_t limit) -> bool {
+            auto &v = msg->output.value;
+            if (msg->output.status != Indexing::Enums::OpStatus::Ok || v == nullptr || v.is_remote()) {
+                return false;
+            }
+
+            auto size = Inlining::copy(msg->output.inlined, v.local_ptr(), msg->output.value_size, limit,
+                                       msg->input.key, msg->input.key_size);
+            if (size == 0) {
+                return false;
+            }
+            msg->output.inlined_size = size;
+            return true;
+        }
 
+        auto StoreServer::respond(ServerContext *ctx, IncomeMessage *msg) -> void {
+            auto req_handle = msg->input.req_handle;
+            auto status = msg->output.status.load();
+            auto op = msg->input.op;
+            // agent's memory is available but not sufficient
+            if (status == Indexing::Enums::OpStatus::NoMemory && Enums::writes(op)) {
+                request_memory(ctx, msg);
+                return;
+            }
+
+            if (auto batch = msg->input.batch; batch != nullptr) {
+                batch->results[msg->input.index] = result_of(ctx, msg);
+                release_message(ctx, msg);
+                if (--batch->pending == 0) {
+                    respond_batch(ctx, batch);
+                }
+                return;
+            }
+
+#ifdef __HILL_SAMPLE__
+            auto handle_sampler = ctx->handle_sampler;
+            auto &sampler = op == Enums::RPCOperations::Insert ? handle_sampler->insert_sampler :
+                op == Enums::RPCOperations::Search ? handle_sampler->search_sampler : handle_sampler->update_sampler;
+#endif
+            auto &resp = req_handle->pre_resp_msgbuf;
 #ifdef __HILL_SAMPLE__
             {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP_MSG);
 #endif
-                ctx->rpc->resize_msg_buffer(&resp, total_msg_size);
-                *reinterpret_cast<Enums::RPCOperations *>(resp.buf) = Enums::RPCOperations::Search;
-
+                // small values save clients the one-sided read
+                if (op == Enums::RPCOperations::Search && msg->output.inlined_size == 0) {
+                    inline_value(msg, Constants::uINLINE_VALUE_SIZE);
+                }
+                // the value size lets clients read an inserted value by one-sided reads
+                constexpr auto header_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus)
+                    + sizeof(Memory::PolymorphicPointer) + sizeof(size_t);
+                // read-modify-writes carry the length of their previous value, which is not the stamped size
+                auto inlined_header_size = Enums::is_rmw(op) ? sizeof(size_t) : 0;
+                ctx->rpc->resize_msg_buffer(&resp, header_size + inlined_header_size + msg->output.inlined_size);
+                *reinterpret_cast<Enums::RPCOperations *>(resp.buf) = op;
+
+                auto result = result_of(ctx, msg);
                 auto offset = sizeof(Enums::RPCOperations);
-                if (msg.output.value == nullptr) {
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Failed;
-                } else {
-                    *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Ok;
-
-                    offset += sizeof(Enums::RPCStatus);
-                    if (msg.output.value.is_remote()) {
-                        *reinterpret_cast<Memory::PolymorphicPointer *>(resp.buf + offset) = msg.output.value;
-                    } else {
-                        auto poly = Memory::PolymorphicPointer::make_polymorphic_pointer(Memory::RemotePointer::make_remote_pointer(ctx->node_id, msg.output.value.local_ptr()));
-                        *reinterpret_cast<Memory::PolymorphicPointer *>(resp.buf + offset) = poly;
-                    }
-
-                    offset += sizeof(Memory::PolymorphicPointer);
-                    *reinterpret_cast<size_t *>(resp.buf + offset) =
-                        msg.output.value.is_remote() ? msg.output.value_size + 64 : msg.output.value_size;
+                *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = result.status;
+                offset += sizeof(Enums::RPCStatus);
+                *reinterpret_cast<Memory::PolymorphicPointer *>(resp.buf + offset) = result.value;
+                offset += sizeof(Memory::PolymorphicPointer);
+                *reinterpret_cast<size_t *>(resp.buf + offset) = result.size;
+                offset += sizeof(size_t);
+                if (inlined_header_size != 0) {
+                    *reinterpret_cast<size_t *>(resp.buf + offset) = msg->output.inlined_size;
+                    offset += inlined_header_size;
                 }
+                memcpy(resp.buf + offset, msg->output.inlined, msg->output.inlined_size);
 #ifdef __HILL_SAMPLE__
             }
 #endif
@@ -632,13 +932,220 @@ namespace Hill {
             {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP);
 #endif
+                // the request buffer, thus the key, is released here
                 ctx->rpc->enqueue_response(req_handle, &resp);
 #ifdef __HILL_SAMPLE__
             }
 #endif
-            if (msg.output.status.load() == Indexing::Enums::OpStatus::Failed) {
-                std::cout << "Searching " << key->to_string() << " failed\n";
+            release_message(ctx, msg);
+        }
+
+        auto StoreServer::result_of(ServerContext *ctx, IncomeMessage *msg) -> ResultEntry {
+            ResultEntry ret;
+            auto op = msg->input.op;
+            auto status = msg->output.status.load();
+            switch (status) {
+            case Indexing::Enums::OpStatus::Ok:
+                ret.status = Enums::RPCStatus::Ok;
+                break;
+            case Indexing::Enums::OpStatus::Retry:
+                ret.status = Enums::RPCStatus::Busy;
+                break;
+            default:
+                ret.status = msg->output.rmw == RMW::Outcome::Mismatch ? Enums::RPCStatus::Mismatch : Enums::RPCStatus::Failed;
+                break;
+            }
+
+            if (op == Enums::RPCOperations::Update || msg->output.value.is_remote()) {
+                ret.value = msg->output.value;
+            } else {
+                auto remote = Memory::RemotePointer::make_remote_pointer(ctx->node_id, msg->output.value.local_ptr());
+                ret.value = Memory::PolymorphicPointer::make_polymorphic_pointer(remote);
+            }
+
+            ret.size = 0;
+            if (op == Enums::RPCOperations::Insert) {
+                ret.size = KVPair::ValueStamp::stamped_size_of(msg->input.value_size);
+            } else if (op == Enums::RPCOperations::Search) {
+                ret.size = msg->output.value.is_remote() ? msg->output.value_size + 64 : msg->output.value_size;
+            } else if (Enums::is_rmw(op)) {
+                ret.size = msg->output.value_size;
+            }
+
+            if (ret.status == Enums::RPCStatus::Busy) {
+                ret.size = ctx->self->retry_after_us.load();
+            }
+
+            if (status == Indexing::Enums::OpStatus::Failed && ret.status != Enums::RPCStatus::Mismatch) {
+                std::cout << (op == Enums::RPCOperations::Insert ? "Inserting " :
+                              op == Enums::RPCOperations::Update ? "Updating " :
+                              op == Enums::RPCOperations::Search ? "Searching " : "Modifying ")
+                          << std::string(msg->input.key, msg->input.key_size) << " failed\n";
             }
+            return ret;
+        }
+
+        auto StoreServer::modify(Indexing::OLFIT &olfit, int tid, IncomeMessage *msg) -> Indexing::Enums::OpStatus {
+            auto current = olfit.read(tid, msg->input.key, msg->input.key_size);
+            if (!current.has_value()) {
+                return Indexing::Enums::OpStatus::Failed;
+            }
+
+            auto &old = current.value();
+            auto operand = msg->input.value;
+            auto operand_size = msg->input.value_size;
+            std::string desired;
+            RMW::Outcome outcome;
+            switch (msg->input.op) {
+            case Enums::RPCOperations::CompareAndSwap:
+                outcome = RMW::compare_and_swap(old, operand, operand_size, desired);
+                break;
+            case Enums::RPCOperations::FetchAdd:
+                outcome = RMW::fetch_add(old, operand, operand_size, desired);
+                break;
+            case Enums::RPCOperations::Append:
+                outcome = RMW::append(old, operand, operand_size, desired);
+                break;
+            default:
+                outcome = RMW::Outcome::Invalid;
+                break;
+            }
+
+            msg->output.rmw = outcome;
+            if (outcome == RMW::Outcome::Invalid) {
+                return Indexing::Enums::OpStatus::Failed;
+            }
+
+            // the client retries a CompareAndSwap with what is inlined instead of searching again
+            if (outcome == RMW::Outcome::Mismatch || msg->input.op == Enums::RPCOperations::FetchAdd) {
+                if (old.size() <= Constants::uHOT_VALUE_SIZE) {
+                    memcpy(msg->output.inlined, old.data(), old.size());
+                    msg->output.inlined_size = old.size();
+                }
+            }
+
+            if (outcome == RMW::Outcome::Mismatch) {
+                auto [v, v_sz] = olfit.search(msg->input.key, msg->input.key_size);
+                msg->output.value = v;
+                msg->output.value_size = v_sz;
+                return Indexing::Enums::OpStatus::Failed;
+            }
+
+            auto [status, value_ptr] = olfit.update(tid, msg->input.key, msg->input.key_size, desired.data(), desired.size());
+            if (status != Indexing::Enums::OpStatus::Ok) {
+                msg->output.inlined_size = 0;
+                return status;
+            }
+            msg->output.value = value_ptr;
+            msg->output.value_size = KVPair::ValueStamp::stamped_size_of(desired.size());
+            return status;
+        }
+
+        auto StoreServer::acquire_batch(ServerContext *ctx) -> BatchedRequest * {
+            while (ctx->free_batches.empty()) {
+                poll_completions(ctx);
+            }
+
+            auto batch = ctx->free_batches.back();
+            ctx->free_batches.pop_back();
+            return batch;
+        }
+
+        auto StoreServer::multi_handler(erpc::ReqHandle *req_handle, void *context) -> void {
+            auto ctx = reinterpret_cast<ServerContext *>(context);
+            auto server = ctx->server;
+            auto buf = req_handle->get_req_msgbuf()->buf;
+            auto type = *reinterpret_cast<Enums::RPCOperations *>(buf);
+            buf += sizeof(Enums::RPCOperations);
+            auto num = *reinterpret_cast<uint32_t *>(buf);
+            buf += sizeof(uint32_t);
+
+            auto batch = acquire_batch(ctx);
+            batch->req_handle = req_handle;
+            batch->op = type;
+            batch->total = 0;
+            batch->pending = 0;
+            if (num == 0 || num > Constants::iMAX_BATCH_OPS) {
+                respond_batch(ctx, batch);
+                return;
+            }
+
+            // keys are counted as pending beforehand so that early completions do not respond
+            batch->total = batch->pending = num;
+            auto op = Enums::single_of(type);
+            auto allowed = Constants::dNODE_CAPPACITY_LIMIT * server->get_node()->total_pm;
+            for (uint32_t i = 0; i < num; i++) {
+                auto key = reinterpret_cast<hill_key_t *>(buf);
+                buf += key->object_size();
+                hill_value_t *value = nullptr;
+                if (op != Enums::RPCOperations::Search) {
+                    value = reinterpret_cast<hill_value_t *>(buf);
+                    buf += value->object_size();
+                }
+
+                auto msg = acquire_message(ctx);
+                msg->input.req_handle = req_handle;
+                msg->input.batch = batch;
+                msg->input.index = i;
+                msg->input.op = op;
+                msg->input.key = key->raw_chars();
+                msg->input.key_size = key->size();
+                msg->input.hkey = key;
+                if (value != nullptr) {
+                    msg->input.value = value->raw_chars();
+                    msg->input.value_size = value->size();
+                    msg->input.hvalue = value;
+                }
+                msg->input.partition = ctx->self->partitioner.partition_of(msg->input.key, msg->input.key_size);
+
+                if (op != Enums::RPCOperations::Search &&
+                    server->get_allocator()->get_consumed() >= allowed &&
+                    !server->get_agent()->available(msg->input.partition)) {
+                    request_memory(ctx, msg);
+                    continue;
+                }
+
+                if (op == Enums::RPCOperations::Search && search_in_place(ctx, msg)) {
+                    continue;
+                }
+                dispatch(ctx, msg);
+            }
+        }
+
+        auto StoreServer::respond_batch(ServerContext *ctx, BatchedRequest *batch) -> void {
+            auto req_handle = batch->req_handle;
+            constexpr auto entry_size = sizeof(Enums::RPCStatus) + sizeof(Memory::PolymorphicPointer) + sizeof(size_t);
+            auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + sizeof(uint32_t)
+                + batch->total * entry_size;
+
+            auto resp = &req_handle->pre_resp_msgbuf;
+            if (total_msg_size > resp->max_data_size_) {
+                // eRPC frees a dynamic response buffer once the response is sent
+                req_handle->dyn_resp_msgbuf = ctx->rpc->alloc_msg_buffer_or_die(total_msg_size);
+                resp = &req_handle->dyn_resp_msgbuf;
+            }
+            ctx->rpc->resize_msg_buffer(resp, total_msg_size);
+
+            auto buf = resp->buf;
+            *reinterpret_cast<Enums::RPCOperations *>(buf) = batch->op;
+            buf += sizeof(Enums::RPCOperations);
+            *reinterpret_cast<Enums::RPCStatus *>(buf) = batch->total == 0 ? Enums::RPCStatus::Failed : Enums::RPCStatus::Ok;
+            buf += sizeof(Enums::RPCStatus);
+            *reinterpret_cast<uint32_t *>(buf) = batch->total;
+            buf += sizeof(uint32_t);
+            for (int i = 0; i < batch->total; i++) {
+                auto &r = batch->results[i];
+                *reinterpret_cast<Enums::RPCStatus *>(buf) = r.status;
+                buf += sizeof(Enums::RPCStatus);
+                *reinterpret_cast<Memory::PolymorphicPointer *>(buf) = r.value;
+                buf += sizeof(Memory::PolymorphicPointer);
+                *reinterpret_cast<size_t *>(buf) = r.size;
+                buf += sizeof(size_t);
+            }
+
+            // the request buffer, thus all keys, is released here
+            ctx->rpc->enqueue_response(req_handle, resp);
+            ctx->free_batches.push_back(batch);
         }
 
         auto StoreServer::range_handler(erpc::ReqHandle *req_handle, void *context) -> void {
@@ -662,55 +1169,109 @@ namespace Hill {
 
             IncomeMessage msgs[Memory::Constants::iTHREAD_LIST_NUM];
             std::vector<std::vector<Indexing::ScanHolder>> ranges;
+            std::vector<Indexing::ScanHolder> holders;
+            const auto &partitioner = ctx->self->partitioner;
+            auto wanted = *reinterpret_cast<size_t *>(value);
+            auto submit = [&](int i, size_t num) {
+                msgs[i].input.key = key->raw_chars();
+                msgs[i].input.key_size = key->size();
+                msgs[i].input.value_size = num;
+                msgs[i].input.op = type;
+                msgs[i].output.status = Indexing::Enums::OpStatus::Unkown;
+                while(!ctx->queues[i].push(&msgs[i]));
+                ctx->self->parkers[i].unpark();
+            };
 #ifdef __HILL_SAMPLE__
             {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::INDEXING);
 #endif
-                for (auto i = 0; i < ctx->num_launched_threads; i++) {
-                    msgs[i].input.key = key->raw_chars();
-                    msgs[i].input.key_size = key->size();
-                    msgs[i].input.value_size = *reinterpret_cast<size_t *>(value);
-                    msgs[i].input.op = type;
-                    msgs[i].output.status = Indexing::Enums::OpStatus::Unkown;
-                    while(!ctx->queues[i].push(&msgs[i]));
-                }
+                if (partitioner.is_ordered()) {
+                    /*
+                     * sub-ranges from the start are scanned at once rather than one after another, then
+                     * taken in order until enough keys are collected, no merging is needed
+                     */
+                    auto first = partitioner.partition_of(key->raw_chars(), key->size());
+                    for (auto i = first; i < ctx->num_launched_threads; i++) {
+                        submit(i, wanted);
+                    }
 
-                for (auto i = 0; i < ctx->num_launched_threads; i++) {
-                    while(msgs[i].output.status.load() == Indexing::Enums::OpStatus::Unkown);
-                    ranges.push_back(std::move(msgs[i].output.values));
+                    for (auto i = first; i < ctx->num_launched_threads; i++) {
+                        while(msgs[i].output.status.load() == Indexing::Enums::OpStatus::Unkown);
+                        auto &values = msgs[i].output.values;
+                        auto num = std::min(values.size(), wanted - holders.size());
+                        holders.insert(holders.end(), values.begin(), values.begin() + num);
+                    }
+                } else {
+                    for (auto i = 0; i < ctx->num_launched_threads; i++) {
+                        submit(i, wanted);
+                    }
+
+                    for (auto i = 0; i < ctx->num_launched_threads; i++) {
+                        while(msgs[i].output.status.load() == Indexing::Enums::OpStatus::Unkown);
+                        ranges.push_back(std::move(msgs[i].output.values));
+                    }
                 }
 #ifdef __HILL_SAMPLE__
             }
 #endif
             // all partitions are collected
-            size_t ret;
+            if (!partitioner.is_ordered()) {
 #ifdef __HILL_SAMPLE__
-            {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::MERGE);
 #endif
-                auto merger = Merger::make_merger(ranges);
-                auto holders = merger->merge(msgs[0].input.value_size);
-                ret = holders.size();
-#ifdef __HILL_SAMPLE__
+                auto merger = Merger::make_merger(ranges, ctx->server->get_key_codec());
+                holders = merger->merge(wanted);
             }
-#endif
 
-            auto& resp = req_handle->pre_resp_msgbuf;
+            auto resp = &req_handle->pre_resp_msgbuf;
 #ifdef __HILL_SAMPLE__
             {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP_MSG);
 #endif
-                constexpr auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Memory::PolymorphicPointer)
-                    + sizeof(size_t) + sizeof(Enums::RPCStatus);
+                constexpr auto header_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + RangePage::uHEADER_SIZE;
+                constexpr auto pointer_size = sizeof(Memory::PolymorphicPointer) + sizeof(size_t);
 
-                ctx->rpc->resize_msg_buffer(&resp, total_msg_size);
-                *reinterpret_cast<Enums::RPCOperations *>(resp.buf) = Enums::RPCOperations::Range;
+                // keys that fit in one page, the rest is left to continuations
+                auto page_limit = std::min(Constants::uRANGE_PAGE_SIZE, size_t(ctx->rpc->get_max_msg_size()));
+                size_t total_msg_size = header_size;
+                auto num = RangePage::fit(holders.size(), page_limit, total_msg_size, [&](size_t i) {
+                    return holders[i].key->object_size() + pointer_size;
+                });
 
-                auto offset = sizeof(Enums::RPCOperations);
-                *reinterpret_cast<Enums::RPCStatus *>(resp.buf + offset) = Enums::RPCStatus::Ok;
+                if (total_msg_size > resp->max_data_size_) {
+                    // eRPC frees a dynamic response buffer once the response is sent
+                    req_handle->dyn_resp_msgbuf = ctx->rpc->alloc_msg_buffer_or_die(total_msg_size);
+                    resp = &req_handle->dyn_resp_msgbuf;
+                }
+                ctx->rpc->resize_msg_buffer(resp, total_msg_size);
 
-                offset += sizeof(Enums::RPCStatus);
-                *reinterpret_cast<size_t *>(resp.buf + offset) = ret;
+                auto buf = resp->buf;
+                *reinterpret_cast<Enums::RPCOperations *>(buf) = Enums::RPCOperations::Range;
+                buf += sizeof(Enums::RPCOperations);
+                *reinterpret_cast<Enums::RPCStatus *>(buf) = Enums::RPCStatus::Ok;
+                buf += sizeof(Enums::RPCStatus);
+                buf = RangePage::write_header(buf, num, num < holders.size());
+
+                for (size_t i = 0; i < num; i++) {
+                    auto &h = holders[i];
+                    auto k_sz = h.key->object_size();
+                    memcpy(buf, h.key, k_sz);
+                    buf += k_sz;
+
+                    // the same as responses of searches
+                    auto poly = h.value_ptr;
+                    auto size = h.value_size;
+                    if (poly.is_remote()) {
+                        size += 64;
+                    } else {
+                        poly = Memory::PolymorphicPointer::make_polymorphic_pointer(
+                            Memory::RemotePointer::make_remote_pointer(ctx->node_id, poly.local_ptr()));
+                    }
+                    *reinterpret_cast<Memory::PolymorphicPointer *>(buf) = poly;
+                    buf += sizeof(Memory::PolymorphicPointer);
+                    *reinterpret_cast<size_t *>(buf) = size;
+                    buf += sizeof(size_t);
+                }
 #ifdef __HILL_SAMPLE__
             }
 #endif
@@ -718,7 +1279,7 @@ namespace Hill {
             {
                 SampleRecorder<uint64_t> _(sampler, HandleSampler::RESP);
 #endif
-                ctx->rpc->enqueue_response(req_handle, &resp);
+                ctx->rpc->enqueue_response(req_handle, resp);
 #ifdef __HILL_SAMPLE__
             }
 #endif
@@ -729,9 +1290,11 @@ namespace Hill {
             auto tid = ctx->thread_id;
             auto allocator = ctx->server->get_allocator();
             auto logger = ctx->server->get_logger();
-            auto &ptr = logger->make_log(tid, WAL::Enums::Ops::RemoteMemory);
+            auto &entry = logger->make_log(tid, WAL::Enums::Ops::RemoteMemory);
+            WAL::PendingEntry pending(*logger, tid, entry);
 
-            allocator->allocate_for_remote(ptr);
+            byte_ptr_t ptr;
+            allocator->allocate_for_remote(ptr, &pending);
 
             auto &resp = req_handle->pre_resp_msgbuf;
             constexpr auto total_msg_size = sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + sizeof(Memory::RemotePointer);
@@ -776,6 +1339,10 @@ namespace Hill {
                 // we should cast it to size_t outside this function
                 [[fallthrough]];
             case Enums::RPCOperations::Update:
+                [[fallthrough]];
+            case Enums::RPCOperations::CompareAndSwap:
+            case Enums::RPCOperations::FetchAdd:
+            case Enums::RPCOperations::Append:
                 key = reinterpret_cast<hill_key_t *>(buf);
                 buf += key->object_size();
                 key_or_value = reinterpret_cast<hill_value_t *>(buf);
@@ -829,6 +1396,23 @@ namespace Hill {
                     return ;
                 }
 
+                // consecutive point operations of the same type to the same node
+                std::vector<const Workload::WorkloadItem *> batch;
+                int batch_node = 0;
+                auto flush = [&] {
+                    if (batch.empty()) {
+                        return;
+                    }
+
+                    auto slot = acquire_slot(c_ctx, batch_node);
+                    if (prepare_batched_request(*slot, batch, c_ctx)) {
+                        send_request(c_ctx, slot, Enums::multi_of(static_cast<Enums::RPCOperations>(batch.front()->type)));
+                    } else {
+                        c_ctx.window.unused(slot);
+                    }
+                    batch.clear();
+                };
+
                 stats.throughputs.timing_now();
                 start = std::chrono::steady_clock::now();
                 Sampling::Sampler<uint64_t> *sampler = nullptr;
@@ -842,6 +1426,9 @@ namespace Hill {
                         sampler = &c_ctx.client_sampler->search_sampler;
                         break;
                     case Workload::Enums::Update:
+                    case Workload::Enums::CompareAndSwap:
+                    case Workload::Enums::FetchAdd:
+                    case Workload::Enums::Append:
                         sampler = &c_ctx.client_sampler->update_sampler;
                         break;
                     case Workload::Enums::Range:
@@ -858,30 +1445,33 @@ namespace Hill {
 #endif
                             auto ret = c_ctx.cache.get(i.key);
                             if (ret != nullptr) {
+                                bool fetched = true;
 #ifdef __HILL_FETCH_VALUE__
 #ifdef __HILL_SAMPLE__
                                 {
                                     SampleRecorder<size_t> _(*sampler, ClientSampler::CACHE_RDMA);
 #endif
                                     auto re_ptr = ret->value_ptr.remote_ptr();
-                                    c_ctx.client->read_from(c_ctx.thread_id, re_ptr.get_node(),
-                                                            re_ptr.get_as<byte_ptr_t>(), ret->value_size);
-                                    c_ctx.client->poll_completion_once(c_ctx.thread_id, re_ptr.get_node());
+                                    fetched = fetch_value(c_ctx, re_ptr.get_node(), re_ptr.get_as<byte_ptr_t>(),
+                                                          ret->value_size, i.key);
 #ifdef __HILL_SAMPLE__
                                 }
 #endif
 #endif
-                                ++c_ctx.num_search;
-                                ++c_ctx.suc_search;
-                                ++c_ctx.RTTs[1];
-                                goto sample;
+                                if (fetched) {
+                                    ++c_ctx.num_search;
+                                    ++c_ctx.suc_search;
+                                    ++c_ctx.RTTs[1];
+                                    goto sample;
+                                }
+                                // the cached value is updated or removed, search it by RPC
+                                c_ctx.cache.expire(i.key);
                             }
 #ifdef __HILL_SAMPLE__
                         }
 #endif
                     }
 
-                    c_ctx.is_done = false;
 #ifdef __HILL_SAMPLE__
                     {
                         SampleRecorder<size_t> _(*sampler, ClientSampler::CHECK_RPC);
@@ -896,25 +1486,42 @@ namespace Hill {
 
                     node_id = _node_id.value();
 
+                    if (batch_size > 1 && Enums::multi_of(static_cast<Enums::RPCOperations>(i.type)) != Enums::Unknown) {
+                        if (!batch.empty() && (batch.front()->type != i.type || batch_node != node_id)) {
+                            flush();
+                        }
+                        batch.push_back(&i);
+                        batch_node = node_id;
+                        if (batch.size() == batch_size) {
+                            flush();
+                        }
+                        goto sample;
+                    }
+                    // a range query should not overtake operations issued before it
+                    flush();
+
+                    bool prepared;
+                    RequestSlot *slot;
 #ifdef __HILL_SAMPLE__
                     {
                         SampleRecorder<size_t> _(*sampler, ClientSampler::PRE_REQ);
 #endif
-                        prepare_request(node_id, i, c_ctx);
+                        slot = acquire_slot(c_ctx, node_id);
+                        prepared = prepare_request(*slot, i, c_ctx);
 #ifdef __HILL_SAMPLE__
                     }
 #endif
+                    // too large for a single eRPC message
+                    if (!prepared) {
+                        c_ctx.window.unused(slot);
+                        continue;
+                    }
                     // cache is updated in the response_continuation
 #ifdef __HILL_SAMPLE__
                     {
                         SampleRecorder<size_t> _(*sampler, ClientSampler::RPC);
 #endif
-                        c_ctx.rpc->enqueue_request(c_ctx.erpc_sessions[node_id], i.type,
-                                                   &c_ctx.req_bufs[node_id], &c_ctx.resp_bufs[node_id],
-                                                   response_continuation, &node_id);
-                        while(!c_ctx.is_done) {
-                            c_ctx.rpc->run_event_loop_once();
-                        }
+                        send_request(c_ctx, slot, static_cast<Enums::RPCOperations>(i.type));
 #ifdef __HILL_SAMPLE__
                     }
 #endif
@@ -926,9 +1533,16 @@ namespace Hill {
                         start = std::chrono::steady_clock::now();
                     }
                 }
+                flush();
+                while (c_ctx.window.in_flight() != 0) {
+                    c_ctx.rpc->run_event_loop_once();
+                    resend_deferred(c_ctx);
+                }
                 stats.throughputs.timing_stop();
-                stats.throughputs.num_ops = c_ctx.num_insert + c_ctx.num_search + c_ctx.num_update + c_ctx.num_range;
-                stats.throughputs.suc_ops = c_ctx.suc_insert + c_ctx.suc_search + c_ctx.suc_update + c_ctx.suc_range;
+                stats.throughputs.num_ops = c_ctx.num_insert + c_ctx.num_search + c_ctx.num_update + c_ctx.num_range
+                    + c_ctx.num_modify;
+                stats.throughputs.suc_ops = c_ctx.suc_insert + c_ctx.suc_search + c_ctx.suc_update + c_ctx.suc_range
+                    + c_ctx.suc_modify;
                 stats.cache_hit_ratio = c_ctx.cache.hit_ratio();
                 this->client->unregister_thread(tid);
 
@@ -937,6 +1551,9 @@ namespace Hill {
                 std::cout << "-->> search: " << c_ctx.suc_search << "/" << c_ctx.num_search << "\n";
                 std::cout << "-->> update: " << c_ctx.suc_update << "/" << c_ctx.num_update << "\n";
                 std::cout << "-->> range: " << c_ctx.suc_range << "/" << c_ctx.num_range << "\n";
+                std::cout << "-->> read-modify-write: " << c_ctx.suc_modify << "/" << c_ctx.num_modify << "\n";
+                std::cout << "-->> invalid one-sided reads: " << c_ctx.invalid_reads << "\n";
+                std::cout << "-->> retried busy requests: " << c_ctx.busy_retries << "\n";
 #ifdef __HILL_SAMPLE__
                 std::cout << ">> Insert breakdown: "; c_ctx.client_sampler->report_insert(); std::cout << "\n";
                 std::cout << ">> Search breakdown: "; c_ctx.client_sampler->report_search(); std::cout << "\n";
@@ -982,19 +1599,49 @@ namespace Hill {
                     rpc->run_event_loop_once();
                 }
 
-                c_ctx.req_bufs[node_id] = rpc->alloc_msg_buffer_or_die(64);
-                c_ctx.resp_bufs[node_id] = rpc->alloc_msg_buffer_or_die(64);
+                // the window keeps pointers, so slots are never resized afterwards
+                c_ctx.slots[node_id].resize(window);
+                for (auto &slot : c_ctx.slots[node_id]) {
+                    slot.node_id = node_id;
+                    slot.req = rpc->alloc_msg_buffer_or_die(Constants::uMSG_BUF_SIZE);
+                    slot.resp = rpc->alloc_msg_buffer_or_die(Constants::uMSG_BUF_SIZE);
+                    slot.key = nullptr;
+                    c_ctx.window.add(&slot);
+                }
                 shutdown(socket, 0);
             }
             return true;
         }
 
-        auto StoreClient::prepare_request(int node_id, const Workload::WorkloadItem &item,
+        auto StoreClient::prepare_request(RequestSlot &slot, const Workload::WorkloadItem &item,
                                           ClientContext &c_ctx) -> bool
         {
             auto type = item.type;
-            uint8_t *buf = c_ctx.req_bufs[node_id].buf;
-            c_ctx.requesting_key = &item.key;
+            if (type == Hill::Workload::Enums::WorkloadType::Range) {
+                slot.key = &item.key;
+                return prepare_range_request(slot, item.key, Constants::dRANGE_SIZE, c_ctx);
+            }
+
+            auto msg_size = sizeof(Enums::RPCOperations) + KVPair::HillString::object_size_of(item.key.size());
+            switch(type) {
+            case Hill::Workload::Enums::WorkloadType::Update:
+            case Hill::Workload::Enums::WorkloadType::Insert:
+            case Hill::Workload::Enums::WorkloadType::CompareAndSwap:
+            case Hill::Workload::Enums::WorkloadType::FetchAdd:
+            case Hill::Workload::Enums::WorkloadType::Append:
+                msg_size += KVPair::HillString::object_size_of(item.key_or_value.size());
+                break;
+            default:
+                break;
+            }
+
+            // eRPC splits a message into packets by itself, large values only need a large enough buffer
+            if (!reserve_request_buffer(slot, msg_size, c_ctx)) {
+                return false;
+            }
+
+            uint8_t *buf = slot.req.buf;
+            slot.key = &item.key;
             switch(type) {
             case Hill::Workload::Enums::WorkloadType::Update:
                 *reinterpret_cast<Enums::RPCOperations *>(buf) = Enums::RPCOperations::Update;
@@ -1015,11 +1662,15 @@ namespace Hill {
                 buf += sizeof(Enums::RPCOperations);
                 KVPair::HillString::make_string(buf, item.key.c_str(), item.key.size());
                 break;
-            case Hill::Workload::Enums::WorkloadType::Range:
-                *reinterpret_cast<Enums::RPCOperations *>(buf) = Enums::RPCOperations::Range;
+            case Hill::Workload::Enums::WorkloadType::CompareAndSwap:
+            case Hill::Workload::Enums::WorkloadType::FetchAdd:
+            case Hill::Workload::Enums::WorkloadType::Append:
+                // the same layout as Update, the value is the operand
+                *reinterpret_cast<Enums::RPCOperations *>(buf) = static_cast<Enums::RPCOperations>(type);
                 buf += sizeof(Enums::RPCOperations);
                 KVPair::HillString::make_string(buf, item.key.c_str(), item.key.size());
-                *reinterpret_cast<size_t *>(buf) = Constants::dRANGE_SIZE;
+                buf += reinterpret_cast<hill_key_t *>(buf)->object_size();
+                KVPair::HillString::make_string(buf, item.key_or_value.c_str(), item.key_or_value.size());
                 break;
             default:
                 return false;
@@ -1027,19 +1678,226 @@ namespace Hill {
             return true;
         }
 
+        auto StoreClient::prepare_range_request(RequestSlot &slot, const std::string &start, size_t count,
+                                                ClientContext &c_ctx) -> bool
+        {
+            auto msg_size = sizeof(Enums::RPCOperations) + KVPair::HillString::object_size_of(start.size()) + sizeof(size_t);
+            if (!reserve_request_buffer(slot, msg_size, c_ctx)) {
+                return false;
+            }
+            reserve_response_buffer(slot, Constants::uRANGE_PAGE_SIZE, c_ctx);
+
+            uint8_t *buf = slot.req.buf;
+            *reinterpret_cast<Enums::RPCOperations *>(buf) = Enums::RPCOperations::Range;
+            buf += sizeof(Enums::RPCOperations);
+            KVPair::HillString::make_string(buf, start.c_str(), start.size());
+            buf += reinterpret_cast<hill_key_t *>(buf)->object_size();
+            *reinterpret_cast<size_t *>(buf) = count;
+            slot.remaining = count;
+            return true;
+        }
+
+        auto StoreClient::read_range_page(ClientContext &c_ctx, RequestSlot &slot, const uint8_t *buf) -> bool {
+            bool more;
+            size_t num = 0;
+            auto last = RangePage::read(buf, sizeof(Memory::PolymorphicPointer) + sizeof(size_t), more,
+                                   [&](const hill_key_t *key, const uint8_t *pointer) {
+#ifdef __HILL_FETCH_VALUE__
+                auto poly = *reinterpret_cast<const Memory::PolymorphicPointer *>(pointer);
+                auto size = *reinterpret_cast<const size_t *>(pointer + sizeof(Memory::PolymorphicPointer));
+                // small values are not fetched, the same as searches
+                if (size >= 64) {
+                    fetch_value(c_ctx, poly.remote_ptr().get_node(), poly.get_as<byte_ptr_t>(), size, key->to_string());
+                }
+#else
+                UNUSED(key);
+                UNUSED(pointer);
+#endif
+                ++num;
+            });
+
+            if (!RangePage::advance(slot.remaining, num, more)) {
+                return false;
+            }
+
+            RangePage::next_key(last, slot.cursor);
+            if (!prepare_range_request(slot, slot.cursor, slot.remaining, c_ctx)) {
+                return false;
+            }
+            c_ctx.rpc->enqueue_request(c_ctx.erpc_sessions[slot.node_id], Enums::RPCOperations::Range,
+                                       &slot.req, &slot.resp, response_continuation, &slot);
+            return true;
+        }
+
+        auto StoreClient::reserve_request_buffer(RequestSlot &slot, size_t msg_size, ClientContext &c_ctx) -> bool {
+            if (msg_size > c_ctx.rpc->get_max_msg_size()) {
+                return false;
+            }
+
+            auto &req = slot.req;
+            if (msg_size > req.max_data_size_) {
+                c_ctx.rpc->free_msg_buffer(req);
+                req = c_ctx.rpc->alloc_msg_buffer_or_die(msg_size);
+            }
+            c_ctx.rpc->resize_msg_buffer(&req, msg_size);
+            return true;
+        }
+
+        auto StoreClient::reserve_response_buffer(RequestSlot &slot, size_t msg_size, ClientContext &c_ctx) -> void {
+            auto &resp = slot.resp;
+            if (msg_size > resp.max_data_size_) {
+                c_ctx.rpc->free_msg_buffer(resp);
+                resp = c_ctx.rpc->alloc_msg_buffer_or_die(msg_size);
+            }
+        }
+
+        auto StoreClient::prepare_batched_request(RequestSlot &slot, const std::vector<const Workload::WorkloadItem *> &items,
+                                                  ClientContext &c_ctx) -> bool
+        {
+            auto type = items.front()->type;
+            auto msg_size = sizeof(Enums::RPCOperations) + sizeof(uint32_t);
+            for (auto i : items) {
+                msg_size += KVPair::HillString::object_size_of(i->key.size());
+                if (type != Workload::Enums::WorkloadType::Search) {
+                    msg_size += KVPair::HillString::object_size_of(i->key_or_value.size());
+                }
+            }
+
+            if (!reserve_request_buffer(slot, msg_size, c_ctx)) {
+                return false;
+            }
+
+            constexpr auto entry_size = sizeof(Enums::RPCStatus) + sizeof(Memory::PolymorphicPointer) + sizeof(size_t);
+            reserve_response_buffer(slot, sizeof(Enums::RPCOperations) + sizeof(Enums::RPCStatus) + sizeof(uint32_t)
+                                    + items.size() * entry_size, c_ctx);
+
+            uint8_t *buf = slot.req.buf;
+            *reinterpret_cast<Enums::RPCOperations *>(buf) = Enums::multi_of(static_cast<Enums::RPCOperations>(type));
+            buf += sizeof(Enums::RPCOperations);
+            *reinterpret_cast<uint32_t *>(buf) = items.size();
+            buf += sizeof(uint32_t);
+
+            slot.keys.clear();
+            for (auto i : items) {
+                KVPair::HillString::make_string(buf, i->key.c_str(), i->key.size());
+                buf += reinterpret_cast<hill_key_t *>(buf)->object_size();
+                if (type != Workload::Enums::WorkloadType::Search) {
+                    KVPair::HillString::make_string(buf, i->key_or_value.c_str(), i->key_or_value.size());
+                    buf += reinterpret_cast<hill_value_t *>(buf)->object_size();
+                }
+                slot.keys.push_back(&i->key);
+            }
+            return true;
+        }
+
+        auto StoreClient::acquire_slot(ClientContext &c_ctx, int node_id) -> RequestSlot * {
+            return c_ctx.window.acquire(node_id, [&] {
+                c_ctx.rpc->run_event_loop_once();
+                resend_deferred(c_ctx);
+            });
+        }
+
+        auto StoreClient::release_slot(ClientContext &c_ctx, RequestSlot *slot) -> void {
+            c_ctx.window.release(slot);
+        }
+
+        auto StoreClient::send_request(ClientContext &c_ctx, RequestSlot *slot, Enums::RPCOperations op) -> void {
+            c_ctx.window.sent(slot);
+            slot->op = op;
+            c_ctx.rpc->enqueue_request(c_ctx.erpc_sessions[slot->node_id], op, &slot->req, &slot->resp,
+                                       response_continuation, slot);
+        }
+
+        auto StoreClient::defer_request(ClientContext &c_ctx, RequestSlot *slot, uint64_t retry_after_us) -> void {
+            c_ctx.window.defer(slot, std::chrono::steady_clock::now() + std::chrono::microseconds(retry_after_us));
+        }
+
+        auto StoreClient::resend_deferred(ClientContext &c_ctx) -> void {
+            if (!c_ctx.window.has_deferred()) {
+                return;
+            }
+
+            c_ctx.busy_retries += c_ctx.window.resend(std::chrono::steady_clock::now(), [&](RequestSlot *slot) {
+                c_ctx.rpc->enqueue_request(c_ctx.erpc_sessions[slot->node_id], slot->op, &slot->req, &slot->resp,
+                                           response_continuation, slot);
+            });
+        }
+
+        auto StoreClient::fetch_value(ClientContext &c_ctx, int node_id, const byte_ptr_t &remote_ptr, size_t size,
+                                      const std::string &key) -> bool
+        {
+            auto tid = c_ctx.thread_id;
+            byte_ptr_t out = nullptr;
+            const_byte_ptr_t bytes = reinterpret_cast<const_byte_ptr_t>(c_ctx.client->rdma_buf_as_void(tid, node_id));
+            if (size > Hill::Constants::uLOCAL_BUF_SIZE) {
+                c_ctx.value_buf.resize(size);
+                out = c_ctx.value_buf.data();
+                bytes = out;
+            }
+
+            for (int i = 0; i < Constants::iREAD_RETRIES; i++) {
+                c_ctx.client->read_chunked(tid, node_id, remote_ptr, size, out);
+                if (KVPair::ValueStamp::validate(bytes, size, key.c_str(), key.size())) {
+                    return true;
+                }
+            }
+            ++c_ctx.invalid_reads;
+            return false;
+        }
+
         auto StoreClient::response_continuation(void *context, void *tag) -> void {
-            auto node_id = *reinterpret_cast<int *>(tag);
+            auto slot = reinterpret_cast<RequestSlot *>(tag);
             auto ctx = reinterpret_cast<ClientContext *>(context);
-            auto buf = ctx->resp_bufs[node_id].buf;
-            auto key = *ctx->requesting_key;
+            auto buf = slot->resp.buf;
 
             auto op = *reinterpret_cast<Enums::RPCOperations *>(buf);
             buf += sizeof(Enums::RPCOperations);
             auto status = *reinterpret_cast<Enums::RPCStatus *>(buf);
             buf += sizeof(Enums::RPCStatus);
-            auto poly = *reinterpret_cast<Memory::PolymorphicPointer *>(buf);
-            buf += sizeof(Memory::PolymorphicPointer);
-            auto size = *reinterpret_cast<size_t *>(buf);
+
+            if (auto single = Enums::single_of(op); single != Enums::RPCOperations::Unknown) {
+                auto num = *reinterpret_cast<uint32_t *>(buf);
+                buf += sizeof(uint32_t);
+
+                // keys answered Busy are packed to the front of the request and sent again after the longest hint
+                auto req = slot->req.buf + sizeof(Enums::RPCOperations) + sizeof(uint32_t);
+                uint32_t busy = 0;
+                uint64_t retry_after_us = 0;
+                auto packed = Batch::repack(req, num, single != Enums::RPCOperations::Search, [&](uint32_t i) {
+                    auto entry_status = *reinterpret_cast<Enums::RPCStatus *>(buf);
+                    buf += sizeof(Enums::RPCStatus);
+                    auto poly = *reinterpret_cast<Memory::PolymorphicPointer *>(buf);
+                    buf += sizeof(Memory::PolymorphicPointer);
+                    auto size = *reinterpret_cast<size_t *>(buf);
+                    buf += sizeof(size_t);
+
+                    if (entry_status == Enums::RPCStatus::Busy) {
+                        slot->keys[busy++] = slot->keys[i];
+                        retry_after_us = std::max(retry_after_us, uint64_t(size));
+                        return true;
+                    }
+                    apply_result(*ctx, single, entry_status, poly, size, *slot->keys[i]);
+                    return false;
+                });
+
+                if (busy != 0) {
+                    *reinterpret_cast<uint32_t *>(slot->req.buf + sizeof(Enums::RPCOperations)) = busy;
+                    slot->keys.resize(busy);
+                    ctx->rpc->resize_msg_buffer(&slot->req, packed - slot->req.buf);
+                    defer_request(*ctx, slot, retry_after_us);
+                    return;
+                }
+                // the slot is not reused before this continuation returns
+                release_slot(*ctx, slot);
+
+                // a rejected batch fails all of its keys
+                if (num == 0) {
+                    for (auto k : slot->keys) {
+                        apply_result(*ctx, single, Enums::RPCStatus::Failed, nullptr, 0, *k);
+                    }
+                }
+                return;
+            }
 
 #ifdef __HILL_SAMPLE__
             Sampling::Sampler<uint64_t> *sampler = nullptr;
@@ -1051,6 +1909,9 @@ namespace Hill {
                 sampler = &ctx->client_sampler->search_sampler;
                 break;
             case Enums::RPCOperations::Update:
+            case Enums::RPCOperations::CompareAndSwap:
+            case Enums::RPCOperations::FetchAdd:
+            case Enums::RPCOperations::Append:
                 sampler = &ctx->client_sampler->update_sampler;
                 break;
             case Enums::RPCOperations::Range:
@@ -1063,62 +1924,105 @@ namespace Hill {
             {
                 SampleRecorder<uint64_t> _(*sampler, ClientSampler::CONTI);
 #endif
-                switch(op) {
-                case Enums::RPCOperations::Insert: {
-                    if (status == Enums::RPCStatus::Ok) {
-                        ++ctx->suc_insert;
-                        ctx->cache.insert(key, poly, size);
+                if (op == Enums::RPCOperations::Range) {
+                    if (read_range_page(*ctx, *slot, buf)) {
+                        return;
                     }
-                    ++ctx->num_insert;
-                    break;
+                    release_slot(*ctx, slot);
+                    apply_result(*ctx, op, status, nullptr, 0, *slot->key);
+                    return;
                 }
 
-                case Enums::RPCOperations::Search: {
-                    if (status == Enums::RPCStatus::Ok) {
-                        ++ctx->suc_search;
-                        ctx->cache.insert(key, poly, size);
-                    }
-#ifdef __HILL_FETCH_VALUE__
-                    // value is embeded
-                    if (size < 64) {
-                        ++ctx->num_search;
-                        ++ctx->RTTs[1];
-                        break;
-                    }
+                auto poly = *reinterpret_cast<Memory::PolymorphicPointer *>(buf);
+                buf += sizeof(Memory::PolymorphicPointer);
+                auto size = *reinterpret_cast<size_t *>(buf);
+                buf += sizeof(size_t);
+                // sent again once the hint passes, requests sent after it may run before it
+                if (status == Enums::RPCStatus::Busy) {
+                    defer_request(*ctx, slot, size);
+                    return;
+                }
 
-                    node_id = poly.remote_ptr().get_node();
-                    ctx->client->read_from(ctx->thread_id, node_id, poly.get_as<byte_ptr_t>(), size);
-                    ctx->client->poll_completion_once(ctx->thread_id, node_id);
-                    ++ctx->RTTs[2];
+                auto inlined_size = size;
+                if (Enums::is_rmw(op)) {
+                    inlined_size = *reinterpret_cast<size_t *>(buf);
+                    buf += sizeof(size_t);
+                }
+                auto inlined = Inlining::received(slot->resp.buf, slot->resp.get_data_size(), buf, inlined_size);
+                release_slot(*ctx, slot);
+                apply_result(*ctx, op, status, poly, size, *slot->key, inlined);
+#ifdef __HILL_SAMPLE__
+            }
 #endif
-                    ++ctx->num_search;
-                    break;
+        }
+
+        auto StoreClient::apply_result(ClientContext &c_ctx, Enums::RPCOperations op, Enums::RPCStatus status,
+                                       const Memory::PolymorphicPointer &poly, size_t size, const std::string &key,
+                                       const_byte_ptr_t inlined) -> void
+        {
+            switch(op) {
+            case Enums::RPCOperations::Insert: {
+                if (status == Enums::RPCStatus::Ok) {
+                    ++c_ctx.suc_insert;
+                    c_ctx.cache.insert(key, poly, size);
                 }
+                ++c_ctx.num_insert;
+                break;
+            }
 
-                case Enums::RPCOperations::Update: {
-                    if (status == Enums::RPCStatus::Ok) {
-                        ++ctx->suc_update;
-                        ctx->cache.expire(key);
-                    }
-                    ++ctx->num_update;
+            case Enums::RPCOperations::Search: {
+                if (status == Enums::RPCStatus::Ok) {
+                    ++c_ctx.suc_search;
+                    c_ctx.cache.insert(key, poly, size);
+                }
+#ifdef __HILL_FETCH_VALUE__
+                // small and hot values are inlined, the rest are read by one-sided reads
+                if (status != Enums::RPCStatus::Ok || Inlining::usable(inlined, size, key)) {
+                    ++c_ctx.num_search;
+                    ++c_ctx.RTTs[1];
                     break;
                 }
 
-                case Enums::RPCOperations::Range: {
-                    if (status == Enums::RPCStatus::Ok) {
-                        ++ctx->suc_range;
-                    }
-                    ++ctx->num_range;
-                    break;
+                // a value updated right after the search is left to the next search
+                fetch_value(c_ctx, poly.remote_ptr().get_node(), poly.get_as<byte_ptr_t>(), size, key);
+                ++c_ctx.RTTs[2];
+#endif
+                ++c_ctx.num_search;
+                break;
+            }
+
+            case Enums::RPCOperations::Update: {
+                if (status == Enums::RPCStatus::Ok) {
+                    ++c_ctx.suc_update;
+                    c_ctx.cache.expire(key);
                 }
+                ++c_ctx.num_update;
+                break;
+            }
 
-                default:
-                    break;
+            case Enums::RPCOperations::Range: {
+                if (status == Enums::RPCStatus::Ok) {
+                    ++c_ctx.suc_range;
                 }
-                ctx->is_done = true;
-#ifdef __HILL_SAMPLE__
+                ++c_ctx.num_range;
+                break;
+            }
+
+            case Enums::RPCOperations::CompareAndSwap:
+            case Enums::RPCOperations::FetchAdd:
+            case Enums::RPCOperations::Append: {
+                // the new value is not cached, the old one is never read again
+                if (status == Enums::RPCStatus::Ok) {
+                    ++c_ctx.suc_modify;
+                }
+                c_ctx.cache.expire(key);
+                ++c_ctx.num_modify;
+                break;
+            }
+
+            default:
+                break;
             }
-#endif
         }
     }
 }
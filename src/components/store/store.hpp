@@ -12,8 +12,22 @@
 #include "city/city.hpp"
 #include "stats/stats.hpp"
 #include "sampler/sampler.hpp"
+#include "store/ring/ring.hpp"
+#include "store/partitioner/partitioner.hpp"
+#include "store/hot_cache/hot_cache.hpp"
+#include "store/rmw/rmw.hpp"
+#include "store/stalled/stalled.hpp"
+#include "store/group_seq/group_seq.hpp"
+#include "store/inflight/inflight.hpp"
+#include "store/batch/batch.hpp"
+#include "store/window/window.hpp"
+#include "store/range_page/range_page.hpp"
+#include "store/inlining/inlining.hpp"
+#include "store/coalescer/coalescer.hpp"
 
 #include "boost/lockfree/queue.hpp"
+
+#include <condition_variable>
 /*
  * The complete implementation of Hill is here.
  *
@@ -34,17 +48,47 @@ namespace Hill {
         using namespace Sampling;
 
         namespace Constants {
-            static constexpr size_t uMAX_MSG_SIZE = 512;
+            // initial size of a client request buffer, grown when a request carries a larger value
+            static constexpr size_t uMSG_BUF_SIZE = 512;
             static constexpr int iMSG_QUEUE_CAP = 128;
+            // messages a frontend thread keeps in flight, less than iMSG_QUEUE_CAP so its rings never fill
+            static constexpr int iMAX_INFLIGHT = 64;
+            // max number of messages a backend thread drains into one WAL group commit
+            static constexpr int iGROUP_COMMIT_SIZE = 16;
+            // a backend draining this many messages at once is behind, its searches may be stolen
+            static constexpr int iSTEAL_BACKLOG = iGROUP_COMMIT_SIZE;
+            // searches an idle backend takes from a backend that is behind at once
+            static constexpr int iSTEAL_BATCH = 4;
+            // empty rounds a backend spins before it parks, and how long it parks before looking again
+            static constexpr int iIDLE_ROUNDS = 1024;
+            static constexpr uint64_t uPARK_TIMEOUT_US = 10000;
 #ifdef __HILL_DEBUG__
             static constexpr double dNODE_CAPPACITY_LIMIT = 0.1;
 #else
             static constexpr double dNODE_CAPPACITY_LIMIT = 0.8;
 #endif
+            // writes a frontend parks per partition while remote memory is requested, later ones are answered Busy
+            static constexpr size_t uMAX_STALLED_WRITES = 16;
+            // retry-after hint of Busy responses until a remote memory request has been timed
+            static constexpr uint64_t uDEFAULT_RETRY_AFTER_US = 1000;
             // fake constants
             using tBOOST_QUEUE_CAP = boost::lockfree::capacity<iMSG_QUEUE_CAP>;
+            // every thread registered to the engine may send to a backend, plus the memory monitor
+            static constexpr int iMONITOR_PRODUCER = Memory::Constants::iTHREAD_LIST_NUM;
+            static constexpr int iNUM_PRODUCERS = iMONITOR_PRODUCER + 1;
 
             static constexpr double dRANGE_SIZE = 86;
+            // a range response stops before this size, the client continues from the last key it got
+            static constexpr size_t uRANGE_PAGE_SIZE = 16 * 1024;
+            // one-sided reads of a torn value are retried before the client falls back to RPC
+            static constexpr int iREAD_RETRIES = 4;
+            // max number of keys in one batched request, each takes a message of the eRPC thread
+            static constexpr int iMAX_BATCH_OPS = 32;
+            // batched requests an eRPC thread handles at the same time
+            static constexpr int iMAX_INFLIGHT_BATCHES = 8;
+            // max requests a client thread keeps in flight to each server
+            static constexpr int iMAX_CLIENT_WINDOW = 64;
+            static_assert(uINLINE_VALUE_SIZE <= uHOT_VALUE_SIZE, "inlined values must fit the message");
         }
 
         namespace Enums {
@@ -59,17 +103,96 @@ namespace Hill {
                 // for peer server
                 CallForMemory,
 
+                // batched point operations for client
+                MultiInsert,
+                MultiSearch,
+                MultiUpdate,
+
+                // read-modify-writes executed by the owner of the key
+                CompareAndSwap = Workload::Enums::WorkloadType::CompareAndSwap,
+                FetchAdd = Workload::Enums::WorkloadType::FetchAdd,
+                Append = Workload::Enums::WorkloadType::Append,
+
                 // guardian
                 Unknown,
             };
+            // new operations are appended, the values already on the wire never change
+            static_assert(CallForMemory == 4 && MultiUpdate + 1 == CompareAndSwap, "RPC operations are renumbered");
 
             enum RPCStatus : uint8_t {
                 Ok = 0,
                 NoMemory,
                 Failed,
+                // retryable, the size_t of the response is a retry-after hint in microseconds
+                Busy,
+                // CompareAndSwap found another value, which is inlined if it fits
+                Mismatch,
             };
+
+            // operations that write a value, thus may run out of memory
+            static inline auto writes(RPCOperations op) noexcept -> bool {
+                switch (op) {
+                case Insert:
+                case Update:
+                case CompareAndSwap:
+                case FetchAdd:
+                case Append:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            static inline auto is_rmw(RPCOperations op) noexcept -> bool {
+                return op == CompareAndSwap || op == FetchAdd || op == Append;
+            }
+
+            // operation of each key in a batched request, or Unknown if op is not batched
+            static inline auto single_of(RPCOperations op) noexcept -> RPCOperations {
+                switch (op) {
+                case MultiInsert:
+                    return Insert;
+                case MultiSearch:
+                    return Search;
+                case MultiUpdate:
+                    return Update;
+                default:
+                    return Unknown;
+                }
+            }
+
+            // batched counterpart of a point operation, or Unknown if op can not be batched
+            static inline auto multi_of(RPCOperations op) noexcept -> RPCOperations {
+                switch (op) {
+                case Insert:
+                    return MultiInsert;
+                case Search:
+                    return MultiSearch;
+                case Update:
+                    return MultiUpdate;
+                default:
+                    return Unknown;
+                }
+            }
         }
 
+        // what is responded for a point operation
+        struct ResultEntry {
+            Enums::RPCStatus status;
+            Memory::PolymorphicPointer value;
+            size_t size;
+        };
+
+        // a batched request is responded once all of its messages are completed
+        struct BatchedRequest {
+            erpc::ReqHandle *req_handle;
+            Enums::RPCOperations op;
+            int total;
+            int pending;
+            ResultEntry results[Constants::iMAX_BATCH_OPS];
+        };
+
+        struct ServerContext;
         struct IncomeMessage {
             struct {
                 const char *key;
@@ -86,6 +209,15 @@ namespace Hill {
 
                 KVPair::HillString *hkey;
                 KVPair::HillString *hvalue;
+
+                // backend partition of the key
+                int partition;
+                // where to report completion, nullptr if the sender polls the status instead
+                ServerContext *from;
+                erpc::ReqHandle *req_handle;
+                // set if the message is one key of a batched request
+                BatchedRequest *batch;
+                int index;
             } input;
 
             // output
@@ -94,6 +226,11 @@ namespace Hill {
                 Memory::PolymorphicPointer value;
                 size_t value_size;
                 std::vector<Indexing::ScanHolder> values;
+                // the stamped value copied to DRAM, sent along with the pointer if inlined_size is not 0
+                size_t inlined_size;
+                byte_t inlined[Constants::uHOT_VALUE_SIZE];
+                // outcome of a read-modify-write, set by modify
+                RMW::Outcome rmw;
             } output;
 
             IncomeMessage() {
@@ -111,13 +248,22 @@ namespace Hill {
                 input.value = nullptr;
                 input.value_size = 0;
                 input.op = Enums::RPCOperations::Unknown;
+                input.partition = 0;
+                input.from = nullptr;
+                input.req_handle = nullptr;
+                input.batch = nullptr;
+                input.index = 0;
 
                 output.status = Indexing::Enums::OpStatus::Unkown;
                 output.value = nullptr;
                 output.value_size = 0;
+                output.inlined_size = 0;
+                output.rmw = RMW::Outcome::Ok;
             }
         };
 
+        using RequestRing = SPSCRing<IncomeMessage *, Constants::iMSG_QUEUE_CAP>;
+
         class StoreServer;
         struct ServerContext {
             StoreServer *self;
@@ -125,13 +271,22 @@ namespace Hill {
             int thread_id;
             int node_id;
             Engine *server;
-            boost::lockfree::queue<IncomeMessage *, Constants::tBOOST_QUEUE_CAP> *queues;
+            // rings from this thread to each backend
+            RequestRing *queues;
             erpc::Rpc<erpc::CTransport> *rpc;
             int num_launched_threads;
             erpc::Nexus *nexus;
 
-            // for remote memory only;
-            std::atomic_bool need_memory;
+            // for remote memory only, the agent lock of a partition is held while its memory is asked for
+            // writes waiting for remote memory of their partitions, dispatched again once it is offered
+            StalledWrites<IncomeMessage *, Memory::Constants::iTHREAD_LIST_NUM, Constants::uMAX_STALLED_WRITES> stalled;
+            // writes dispatched to each backend and not completed yet, searches of their partitions go after them
+            int inflight_writes[Memory::Constants::iTHREAD_LIST_NUM];
+
+            // messages of in-flight requests and those completed by backends
+            Inflight<IncomeMessage, Constants::iMAX_INFLIGHT> messages;
+            BatchedRequest batches[Constants::iMAX_INFLIGHT_BATCHES];
+            std::vector<BatchedRequest *> free_batches;
             int erpc_sessions[Cluster::Constants::uMAX_NODE];
             erpc::MsgBuffer req_bufs[Cluster::Constants::uMAX_NODE];
             erpc::MsgBuffer resp_bufs[Cluster::Constants::uMAX_NODE];
@@ -145,21 +300,41 @@ namespace Hill {
                     s = -1;
                 }
 
-                need_memory = false;
+                for (auto &w : inflight_writes) {
+                    w = 0;
+                }
+                for (auto &b : batches) {
+                    free_batches.push_back(&b);
+                }
             }
         };
 
+        // buffers of one in-flight client request, the request is tagged with its slot
+        struct RequestSlot {
+            int node_id;
+            erpc::MsgBuffer req;
+            erpc::MsgBuffer resp;
+            // key of a point operation, or keys of a batched request in the order of their results
+            const std::string *key;
+            std::vector<const std::string *> keys;
+            // start key of the next page of a range query and the number of keys still wanted
+            std::string cursor;
+            size_t remaining;
+            // the request is sent again at retry_at if the server is busy
+            Enums::RPCOperations op;
+            std::chrono::steady_clock::time_point retry_at;
+        };
+
         struct ClientContext {
             int thread_id;
             std::string server_uri[Cluster::Constants::uMAX_NODE];
             Client *client;
             erpc::Rpc<erpc::CTransport> *rpc;
-            erpc::MsgBuffer req_bufs[Cluster::Constants::uMAX_NODE];
-            erpc::MsgBuffer resp_bufs[Cluster::Constants::uMAX_NODE];
+            // a window of slots per server
+            std::vector<RequestSlot> slots[Cluster::Constants::uMAX_NODE];
+            RequestWindow<RequestSlot, Cluster::Constants::uMAX_NODE> window;
             int erpc_sessions[Cluster::Constants::uMAX_NODE];
-            bool is_done;
             Stats::SyntheticStats stats;
-            const std::string *requesting_key;
             ReadCache::Cache cache;
             uint64_t num_insert;
             uint64_t suc_insert;
@@ -169,15 +344,23 @@ namespace Hill {
             uint64_t suc_update;
             uint64_t num_range;
             uint64_t suc_range;
+            // read-modify-writes, a CompareAndSwap answered Mismatch is not successful
+            uint64_t num_modify;
+            uint64_t suc_modify;
+            // one-sided reads that failed validation after all retries
+            uint64_t invalid_reads;
+            // requests sent again after Busy responses
+            uint64_t busy_retries;
+            // values larger than the registered RDMA buffer are fetched here
+            std::vector<byte_t> value_buf;
 
             // record at most 8 RTTs
             size_t RTTs[8];
 
             ClientSampler *client_sampler;
 
-            ClientContext() : thread_id(0), is_done(false), cache(ReadCache::Constants::uCACHE_SIZE){
+            ClientContext() : thread_id(0), cache(ReadCache::Constants::uCACHE_SIZE){
                 thread_id = 0;
-                is_done = false;
                 for (auto &u : server_uri) {
                     u = "";
                 }
@@ -193,6 +376,9 @@ namespace Hill {
                 }
 
                 num_insert = suc_insert = num_search = suc_search = num_update = suc_update = num_range = suc_range = 0;
+                num_modify = suc_modify = 0;
+                invalid_reads = 0;
+                busy_retries = 0;
             }
         };
 
@@ -219,27 +405,54 @@ namespace Hill {
          *    |           first byte         |
          *    | RPCOperations::CallForMemory |
          *
+         * 6. MultiInsert, MultiSearch and MultiUpdate
+         *    |      first byte      |   following bytes
+         *    | RPCOperations::Multi | uint32_t n | n entries of the point operation without the first byte |
+         *
+         * 7. CompareAndSwap, FetchAdd and Append
+         *    |      first byte      | following bytes
+         *    | RPCOperations::(RMW) | hill_key_t key | hill_value_t operand |
+         *    the operand of CompareAndSwap is | uint32_t n | n bytes expected | desired |, see RMW::make_cas_operand,
+         *    the one of FetchAdd is an int64_t added to a value of 8 bytes, and Append appends the operand
+         *
          * responses are in one of following formats
          * 1. Insert:
          *    |       first byte      |  following bytes
-         *    | RPCOperations::Insert |    RPCStatus   | PolymorphicPointer
+         *    | RPCOperations::Insert |    RPCStatus   | PolymorphicPointer | size_t stamped size
          *
          * 2. Search:
          *    |       first byte      |  following bytes
-         *    | RPCOperations::Search |    RPCStatus   | PolymorphicPointer | size_t size
+         *    | RPCOperations::Search |    RPCStatus   | PolymorphicPointer | size_t size | (stamped value) |
+         *    the stamped value of size bytes is inlined if the response is longer than the size_t, which
+         *    happens for values up to Constants::uINLINE_VALUE_SIZE and for hot values
          *
          * 3. Update:
          *    |       first byte      |  following bytes
-         *    | RPCOperations::Update |    RPCStatus   | PolymorphicPointer
+         *    | RPCOperations::Update |    RPCStatus   | PolymorphicPointer | size_t (always 0)
          *
          * 4. Scan
-         *    |      first byte     |
-         *    | RPCOperations::Scan |
+         *    |      first byte     |  following bytes
+         *    | RPCOperations::Scan |    RPCStatus   | uint32_t n | uint8_t more | n x (hill_key_t | PolymorphicPointer | size_t) |
+         *    keys are in order, more is set if the page is full before the requested number of keys
          *
          * 5. CallForMemory
          *    |           first byte         |
          *    | RPCOperations::CallForMemory |
          *
+         * 6. MultiInsert, MultiSearch and MultiUpdate
+         *    |      first byte      |   following bytes
+         *    | RPCOperations::Multi | RPCStatus | uint32_t n | n x (RPCStatus | PolymorphicPointer | size_t) |
+         *    entries are in the order of keys, and n is 0 if the request is malformed
+         *
+         * 7. CompareAndSwap, FetchAdd and Append
+         *    |      first byte      |  following bytes
+         *    | RPCOperations::(RMW) |    RPCStatus   | PolymorphicPointer | size_t stamped size | size_t n | n bytes |
+         *    the pointer and the stamped size are of the new value. The n unstamped bytes are the previous
+         *    counter of a FetchAdd, or the current value of a CompareAndSwap answered Mismatch if it fits
+         *    uHOT_VALUE_SIZE, and n is 0 otherwise
+         *
+         * A write that can not be parked while remote memory is requested is answered with
+         * RPCStatus::Busy, and its size_t is a hint of how many microseconds to wait before retrying
          */
         class StoreServer {
         public:
@@ -255,6 +468,7 @@ namespace Hill {
             {
                 auto ret = std::make_unique<StoreServer>();
                 ret->server = Engine::make_engine(config);
+                ret->parse_partition_samples(config);
 #ifdef __HILL_INFO__
                 std::cout << ">> Starting nexus for server at " << ret->server->get_rpc_uri() << "\n";
 #endif
@@ -262,15 +476,31 @@ namespace Hill {
                 ret->nexus->register_req_func(Enums::RPCOperations::Insert, insert_handler);
                 ret->nexus->register_req_func(Enums::RPCOperations::Search, search_handler);
                 ret->nexus->register_req_func(Enums::RPCOperations::Update, update_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::CompareAndSwap, update_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::FetchAdd, update_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::Append, update_handler);
                 ret->nexus->register_req_func(Enums::RPCOperations::Range, range_handler);
                 ret->nexus->register_req_func(Enums::RPCOperations::CallForMemory, memory_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::MultiInsert, multi_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::MultiSearch, multi_handler);
+                ret->nexus->register_req_func(Enums::RPCOperations::MultiUpdate, multi_handler);
                 ret->erpc_id_cursor = 0;
 
                 for (auto &i : ret->contexts) {
                     i = nullptr;
                 }
 
+                for (auto &i : ret->indexes) {
+                    i = nullptr;
+                }
+
+                for (auto &b : ret->backlogs) {
+                    b = 0;
+                }
+
+                ret->hot_cache = HotCache::make_hot_cache();
                 ret->is_launched = false;
+                ret->retry_after_us = Constants::uDEFAULT_RETRY_AFTER_US;
                 return ret;
             }
 
@@ -281,13 +511,15 @@ namespace Hill {
             inline auto stop() -> void {
                 server->stop();
                 is_launched = false;
+                monitor_cv.notify_all();
             }
 
             // launch one thread wait for income erpc connection request
             auto launch_one_erpc_listen_thread() -> bool;
 
             // launch one thread that periodically checks memory resource amount and
-            // apply for remote memory if it finds any thread is short of memory
+            // apply for remote memory if it finds any thread is short of memory. The thread sleeps
+            // until a frontend asks for memory
             auto launch_one_memory_monitor_thread() -> bool;
             /*
              * If a thread is successfully registered, a background thread would be launched handling
@@ -303,10 +535,38 @@ namespace Hill {
 
             // server represents all servers that are not a monitor
             std::unique_ptr<Engine> server;
+            // decides the backend of a key, made when backends are launched
+            Partitioner partitioner;
+            std::vector<std::string> partition_samples;
             Indexing::LeafNode *leaves[Memory::Constants::iTHREAD_LIST_NUM];
-            boost::lockfree::queue<IncomeMessage *, Constants::tBOOST_QUEUE_CAP> req_queues[Memory::Constants::iTHREAD_LIST_NUM];
+            /*
+             * Trees of backends, owned here rather than by backend threads, since frontends may still
+             * search one after its backend exits. Freed with the server, after frontends are joined
+             */
+            std::unique_ptr<Indexing::OLFIT> olfits[Memory::Constants::iTHREAD_LIST_NUM];
+            // published by backends once their trees are made, frontends search them optimistically
+            std::atomic<Indexing::OLFIT *> indexes[Memory::Constants::iTHREAD_LIST_NUM];
+            // hot values answered from DRAM, backends invalidate keys they change
+            std::unique_ptr<HotCache> hot_cache;
+            /*
+             * req_rings[p][b] is the only path from producer p to backend b. A backend drains the
+             * column of its id in a round-robin manner
+             */
+            RequestRing req_rings[Constants::iNUM_PRODUCERS][Memory::Constants::iTHREAD_LIST_NUM];
+            /*
+             * Searches are read-only, thus any thread may run them optimistically. Searches of a backend
+             * that is behind are queued in its shared_searches instead, where idle backends steal them.
+             * The owner drains the queue as well, so nothing waits for a thief
+             */
+            boost::lockfree::queue<IncomeMessage *, Constants::tBOOST_QUEUE_CAP>
+                shared_searches[Memory::Constants::iTHREAD_LIST_NUM];
+            // messages each backend drained in its last round, how far behind it is
+            std::atomic_int backlogs[Memory::Constants::iTHREAD_LIST_NUM];
+            // groups of backend b with writes, searches of other threads go through them, see search_published
+            GroupSeq group_seqs[Memory::Constants::iTHREAD_LIST_NUM];
+            // idle backends sleep here, whoever pushes to a backend wakes it
+            Parker parkers[Memory::Constants::iTHREAD_LIST_NUM];
             ServerContext *contexts[Memory::Constants::iTHREAD_LIST_NUM];
-            uint64_t index_ids[Memory::Constants::iTHREAD_LIST_NUM];
             erpc::Nexus *nexus;
 
             bool is_launched;
@@ -315,19 +575,70 @@ namespace Hill {
             std::mutex rpc_id_lock;
             std::mutex tid_lock;
             std::mutex agent_locks[Memory::Constants::iTHREAD_LIST_NUM];
+            // the memory monitor waits on monitor_cv, see wake_monitor
+            std::mutex monitor_lock;
+            std::condition_variable monitor_cv;
+            // how long the last remote memory request took, the retry-after hint of Busy responses
+            std::atomic_uint64_t retry_after_us;
 
             // available eRPC IDs
             std::vector<int> erpc_ids;
             std::atomic_uint erpc_id_cursor;
 
+            // optional, one sample key per line in the file of partition_samples in config
+            auto parse_partition_samples(const std::string &config) -> bool;
+            auto wake_monitor() -> void;
+            // run searches of the backend furthest behind for idle backend btid, false if none is completed
+            auto steal(int btid) -> bool;
+            // checked again by backend btid before it parks
+            auto has_work(int btid) noexcept -> bool;
+            // optimistic search of the index of partition, nothing if it is modified or not published meanwhile
+            auto search_published(int partition, const Indexing::OLFIT *index, const char *k, size_t k_sz) const noexcept
+                -> std::optional<std::pair<Memory::PolymorphicPointer, size_t>>;
+            auto needs_memory() const noexcept -> bool;
+
             static auto insert_handler(erpc::ReqHandle *req_handle, void *context) -> void;
+            // also for read-modify-writes, which are run by backends like updates
             static auto update_handler(erpc::ReqHandle *req_handle, void *context) -> void;
             static auto search_handler(erpc::ReqHandle *req_handle, void *context) -> void;
             static auto range_handler(erpc::ReqHandle *req_handle, void *context) -> void;
             static auto memory_handler(erpc::ReqHandle *req_handle, void *context) -> void;
+            // fans keys of a batched request out to backends, responded by respond_batch
+            static auto multi_handler(erpc::ReqHandle *req_handle, void *context) -> void;
 
             static auto parse_request_message(const erpc::ReqHandle *req_handle, const void *s_ctx) ->
                 std::tuple<Enums::RPCOperations, KVPair::HillString *, KVPair::HillString *>;
+
+            /*
+             * Handlers do not wait for backends. A handler takes a message from its context, hands
+             * it to a backend and returns, the backend pushes the message to the completions of
+             * that context and the eRPC thread responds when it polls them. Requests waiting for
+             * remote memory are parked in the context instead of blocking the eRPC thread. Searches
+             * are read-only, so they are served in place and only go to backends on conflicts
+             */
+            static auto acquire_message(ServerContext *ctx) -> IncomeMessage *;
+            static auto release_message(ServerContext *ctx, IncomeMessage *msg) -> void;
+            static auto dispatch(ServerContext *ctx, IncomeMessage *msg) -> void;
+            static auto request_memory(ServerContext *ctx, IncomeMessage *msg) -> void;
+            // answer Busy with a retry-after hint instead of parking more writes
+            static auto reject(ServerContext *ctx, IncomeMessage *msg) -> void;
+            static auto poll_completions(ServerContext *ctx) -> void;
+            static auto respond(ServerContext *ctx, IncomeMessage *msg) -> void;
+            /*
+             * Searches skip backends if nothing they read is modified or left unpublished meanwhile,
+             * returns false otherwise. A search also goes to the backend if a write of this thread to
+             * the partition is not completed, so that it does not overtake the write. Hot values are
+             * answered from the hot cache and inlined in responses
+             */
+            static auto search_in_place(ServerContext *ctx, IncomeMessage *msg) -> bool;
+            // copy a found value of at most limit bytes to the message, false if it is torn or does not fit
+            static auto inline_value(IncomeMessage *msg, size_t limit) -> bool;
+            static auto result_of(ServerContext *ctx, IncomeMessage *msg) -> ResultEntry;
+            // run a read-modify-write by the backend owning the key, the new value is logged as an update
+            // a CompareAndSwap that is not swapped fails with output.rmw set to Mismatch
+            static auto modify(Indexing::OLFIT &olfit, int tid, IncomeMessage *msg) -> Indexing::Enums::OpStatus;
+            static auto acquire_batch(ServerContext *ctx) -> BatchedRequest *;
+            static auto respond_batch(ServerContext *ctx, BatchedRequest *batch) -> void;
         };
 
         class StoreClient {
@@ -345,9 +656,31 @@ namespace Hill {
                 ret->nexus = new erpc::Nexus(ret->client->get_rpc_uri(), 0, 0);
 
                 ret->is_launched = false;
+                ret->batch_size = 1;
+                ret->window = 1;
                 return ret;
             }
 
+            /*
+             * Consecutive inserts, searches or updates to the same node are sent as one batched
+             * request of at most size keys. 1 means every operation is a request on its own
+             */
+            inline auto set_batch_size(size_t size) noexcept -> void {
+                batch_size = std::min(std::max(size, 1UL), size_t(Constants::iMAX_BATCH_OPS));
+            }
+
+            /*
+             * A client thread keeps at most size requests in flight to each server and only waits
+             * when all slots to the server are taken. Requests of a thread to the same key are still
+             * executed in order since a server thread hands them to the same backend in order, except
+             * for a write answered Busy: it is sent again after the hint, so any request sent in the
+             * meantime, or already in flight, may run before it. A window and a batch size of 1 keep
+             * the order
+             */
+            inline auto set_window(size_t size) noexcept -> void {
+                window = std::min(std::max(size, 1UL), size_t(Constants::iMAX_CLIENT_WINDOW));
+            }
+
             inline auto launch() -> bool {
 #if defined(__HILL_DEBUG__) || defined(__HILL_INFO__)
                 std::cout << ">> Launching client node at " << client->get_addr_uri() << "\n";
@@ -364,9 +697,39 @@ namespace Hill {
             std::unique_ptr<Client> client;
             erpc::Nexus *nexus;
             bool is_launched;
+            size_t batch_size;
+            size_t window;
 
             auto connect_all_servers(int tid, ClientContext &c_ctx) -> bool;
-            auto prepare_request(int node_id, const Workload::WorkloadItem &item, ClientContext &c_ctx) -> bool;
+            auto prepare_request(RequestSlot &slot, const Workload::WorkloadItem &item, ClientContext &c_ctx) -> bool;
+            // size the request buffer of a slot for a message, false if eRPC can not carry it
+            static auto reserve_request_buffer(RequestSlot &slot, size_t msg_size, ClientContext &c_ctx) -> bool;
+            static auto reserve_response_buffer(RequestSlot &slot, size_t msg_size, ClientContext &c_ctx) -> void;
+            // pack items of the same type into one batched request
+            auto prepare_batched_request(RequestSlot &slot, const std::vector<const Workload::WorkloadItem *> &items,
+                                         ClientContext &c_ctx) -> bool;
+            // take a free slot to node_id, running the event loop until one is released
+            static auto acquire_slot(ClientContext &c_ctx, int node_id) -> RequestSlot *;
+            static auto release_slot(ClientContext &c_ctx, RequestSlot *slot) -> void;
+            // a range request for count keys starting from start, i.e., the first page or a continuation
+            static auto prepare_range_request(RequestSlot &slot, const std::string &start, size_t count,
+                                              ClientContext &c_ctx) -> bool;
+            // consume a page of a range response, true if the next page is requested with the same slot
+            static auto read_range_page(ClientContext &c_ctx, RequestSlot &slot, const uint8_t *buf) -> bool;
+            static auto send_request(ClientContext &c_ctx, RequestSlot *slot, Enums::RPCOperations op) -> void;
+            // keep a slot answered Busy in flight and send it again after retry_after_us
+            static auto defer_request(ClientContext &c_ctx, RequestSlot *slot, uint64_t retry_after_us) -> void;
+            static auto resend_deferred(ClientContext &c_ctx) -> void;
+            // bookkeeping of the result of one point operation, inlined is the stamped value if the server sent it
+            static auto apply_result(ClientContext &c_ctx, Enums::RPCOperations op, Enums::RPCStatus status,
+                                     const Memory::PolymorphicPointer &poly, size_t size, const std::string &key,
+                                     const_byte_ptr_t inlined = nullptr) -> void;
+            /*
+             * Read a value by one-sided RDMA reads and validate it against its stamp, retrying a
+             * torn read. False if the value is still invalid, e.g., updated or removed
+             */
+            static auto fetch_value(ClientContext &c_ctx, int node_id, const byte_ptr_t &remote_ptr, size_t size,
+                                    const std::string &key) -> bool;
             static auto response_continuation(void *context, void *tag) -> void;
         };
     }
@@ -0,0 +1,104 @@
+#ifndef __HILL__STORE__WINDOW__WINDOW__
+#define __HILL__STORE__WINDOW__WINDOW__
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+/*
+ * Window of in-flight requests of a client thread
+ *
+ * A client keeps a fixed number of slots per server. A request takes a free slot of its server
+ * and is sent without waiting for earlier ones, the slot is free again when the response is
+ * handled. A client with every slot of a server in flight runs its event loop until one comes
+ * back, so no server has more than its window of requests of one client.
+ *
+ * A request answered Busy keeps its slot and is deferred until its retry-after hint passes.
+ * T has an int node_id and a std::chrono::steady_clock::time_point retry_at.
+ */
+namespace Hill {
+    namespace Store {
+        template<typename T, size_t Nodes>
+        class RequestWindow {
+        public:
+            using time_point = std::chrono::steady_clock::time_point;
+
+            RequestWindow() : inflight(0) {}
+            ~RequestWindow() = default;
+            RequestWindow(const RequestWindow &) = delete;
+            RequestWindow(RequestWindow &&) = delete;
+            auto operator=(const RequestWindow &) -> RequestWindow & = delete;
+            auto operator=(RequestWindow &&) -> RequestWindow & = delete;
+
+            // a slot of the window of its node, slots are never moved afterwards
+            auto add(T *slot) -> void {
+                free[slot->node_id].push_back(slot);
+            }
+
+            // a free slot of node, poll is called while all of them are in flight
+            template<typename P>
+            auto acquire(int node, P &&poll) -> T * {
+                auto &slots = free[node];
+                while (slots.empty()) {
+                    poll();
+                }
+
+                auto ret = slots.back();
+                slots.pop_back();
+                return ret;
+            }
+
+            // an acquired slot whose request is not sent
+            auto unused(T *slot) -> void {
+                free[slot->node_id].push_back(slot);
+            }
+
+            auto sent(T *) noexcept -> void {
+                ++inflight;
+            }
+
+            // the response of the slot is handled
+            auto release(T *slot) -> void {
+                free[slot->node_id].push_back(slot);
+                --inflight;
+            }
+
+            // still in flight, sent again once retry_at passes
+            auto defer(T *slot, time_point retry_at) -> void {
+                slot->retry_at = retry_at;
+                deferred.push_back(slot);
+            }
+
+            /*
+             * hands every deferred slot due at now to resend, returns how many
+             * hints of one server are close, so the front is mostly the earliest
+             */
+            template<typename F>
+            auto resend(time_point now, F &&resend) -> size_t {
+                size_t ret = 0;
+                while (!deferred.empty() && deferred.front()->retry_at <= now) {
+                    auto slot = deferred.front();
+                    deferred.pop_front();
+                    resend(slot);
+                    ++ret;
+                }
+                return ret;
+            }
+
+            auto has_deferred() const noexcept -> bool {
+                return !deferred.empty();
+            }
+
+            auto in_flight() const noexcept -> size_t {
+                return inflight;
+            }
+
+        private:
+            std::vector<T *> free[Nodes];
+            std::deque<T *> deferred;
+            size_t inflight;
+        };
+    }
+}
+#endif
@@ -0,0 +1,344 @@
+#include "value_log.hpp"
+
+#include <chrono>
+
+namespace Hill {
+    namespace ValueLog {
+        namespace Util {
+            // stores bypass the cache if possible, no fence is issued
+            static inline auto copy_nodrain(byte_ptr_t dst, const void *src, size_t size) noexcept -> void {
+#ifdef __HILL_PMEM__
+                pmem_memcpy_nodrain(dst, src, size);
+#else
+                memcpy(dst, src, size);
+#endif
+            }
+        }
+
+        auto ValueLog::recover_or_make_value_log(const byte_ptr_t &base, Memory::Allocator *alloc, RecordAction action)
+            -> std::unique_ptr<ValueLog>
+        {
+            auto dir = reinterpret_cast<Directory *>(base);
+            if (dir->magic != Constants::uVALUE_LOG_MAGIC) {
+                return make_value_log(base, alloc);
+            }
+
+            auto ret = std::make_unique<ValueLog>();
+            ret->directory = dir;
+            ret->alloc = alloc;
+
+            uint64_t max_sequence = 0;
+            size_t records = 0;
+            ret->for_each_segment([&](Segment *seg) {
+                if (seg->magic != Constants::uVALUE_LOG_MAGIC || seg->state == Enums::SegmentState::Free) {
+                    Segment::make_segment(reinterpret_cast<byte_ptr_t>(seg));
+                    ret->free_segments.push_back(seg);
+                    return;
+                }
+
+                size_t live = 0;
+                auto cursor = std::min(seg->cursor.load(), Constants::uSEGMENT_SIZE);
+                size_t offset = sizeof(Segment);
+                while (offset + sizeof(RecordHeader) <= cursor) {
+                    auto rec = seg->record_at(offset);
+                    // the cursor may be durable before a torn record
+                    if (rec->total == 0 || rec->total != RecordHeader::record_size(rec->key_size, rec->value_size) ||
+                        offset + rec->total > cursor) {
+                        break;
+                    }
+
+                    if (rec->valid) {
+                        live += rec->total;
+                        max_sequence = std::max(max_sequence, rec->sequence);
+                        action(rec->key(), rec->key_size, reinterpret_cast<byte_ptr_t>(rec->value()));
+                        ++records;
+                    }
+                    offset += rec->total;
+                }
+
+                seg->cursor = offset;
+                seg->live = live;
+                // active segments of the previous run are not appended to anymore
+                seg->state = Enums::SegmentState::Sealed;
+                Memory::Util::flush(seg, sizeof(Segment));
+            });
+            Memory::Util::sfence();
+            ret->sequence = max_sequence + 1;
+
+#ifdef __HILL_INFO__
+            std::cout << ">> Value log recovered " << records << " records from "
+                      << dir->num_arenas.load() << " arenas\n";
+#endif
+            return ret;
+        }
+
+        auto ValueLog::append(int tid, const hill_key_t *key, const hill_value_t *value, uint32_t version) noexcept
+            -> byte_ptr_t
+        {
+            return write(tid, sequence.fetch_add(1, std::memory_order_relaxed), version,
+                         key->raw_chars(), key->size(), value->raw_bytes(), value->size());
+        }
+
+        auto ValueLog::append(int tid, const char *k, size_t k_sz, const char *v, size_t v_sz, uint32_t version) noexcept
+            -> byte_ptr_t
+        {
+            return write(tid, sequence.fetch_add(1, std::memory_order_relaxed), version,
+                         k, k_sz, reinterpret_cast<const_byte_ptr_t>(v), v_sz);
+        }
+
+        auto ValueLog::write(int tid, uint64_t seq, uint32_t version, const char *k, size_t k_sz, const_byte_ptr_t v,
+                             size_t v_sz) noexcept -> byte_ptr_t
+        {
+            auto size = RecordHeader::record_size(k_sz, v_sz);
+            auto rec = reserve(tid, size);
+            if (rec == nullptr) {
+                return nullptr;
+            }
+
+            RecordHeader header {
+                .sequence = seq,
+                .key_size = static_cast<uint32_t>(k_sz),
+                .value_size = static_cast<uint32_t>(v_sz),
+                .valid = 1,
+                .total = static_cast<uint32_t>(size),
+            };
+            // an extended value header is at most 6 bytes
+            byte_t value_header[sizeof(uint64_t)];
+            auto header_size = KVPair::HillString::make_header(value_header, v_sz);
+            KVPair::ValueStamp stamp {
+                .version = version,
+                .checksum = KVPair::ValueStamp::checksum_of(version, k, k_sz, value_header, header_size, v, v_sz),
+            };
+
+            auto cursor = reinterpret_cast<byte_ptr_t>(rec);
+            Util::copy_nodrain(cursor, &header, sizeof(RecordHeader));
+            cursor += sizeof(RecordHeader);
+            auto ret = cursor;
+            Util::copy_nodrain(cursor, value_header, header_size);
+            cursor += header_size;
+            Util::copy_nodrain(cursor, v, v_sz);
+            cursor += v_sz;
+            Util::copy_nodrain(cursor, &stamp, sizeof(stamp));
+            cursor += sizeof(stamp);
+            Util::copy_nodrain(cursor, k, k_sz);
+            return ret;
+        }
+
+        auto ValueLog::reserve(int tid, size_t size) noexcept -> RecordHeader * {
+            if (size > Constants::uSEGMENT_SIZE - sizeof(Segment)) {
+                return nullptr;
+            }
+
+            auto seg = active[tid];
+            if (seg == nullptr || seg->cursor.load(std::memory_order_relaxed) + size > Constants::uSEGMENT_SIZE) {
+                if (seg != nullptr) {
+                    seg->state = Enums::SegmentState::Sealed;
+                    Memory::Util::flush(seg, sizeof(Segment));
+                }
+
+                seg = make_active(tid);
+                if (seg == nullptr) {
+                    return nullptr;
+                }
+            }
+
+            auto offset = seg->cursor.load(std::memory_order_relaxed);
+            seg->cursor.store(offset + size, std::memory_order_relaxed);
+            seg->live.fetch_add(size, std::memory_order_relaxed);
+            Memory::Util::flush(&seg->cursor, sizeof(seg->cursor));
+            return seg->record_at(offset);
+        }
+
+        auto ValueLog::make_active(int tid) noexcept -> Segment * {
+            Segment *seg;
+            {
+                std::scoped_lock<std::mutex> _(free_lock);
+                if (free_segments.empty() && !add_arena()) {
+                    active[tid] = nullptr;
+                    return nullptr;
+                }
+                seg = free_segments.front();
+                free_segments.pop_front();
+            }
+
+            seg->owner = tid;
+            seg->cursor = sizeof(Segment);
+            seg->live = 0;
+            seg->state = Enums::SegmentState::Active;
+            Memory::Util::flush(seg, sizeof(Segment));
+            Memory::Util::sfence();
+            active[tid] = seg;
+            return seg;
+        }
+
+        // free_lock must be held
+        auto ValueLog::add_arena() noexcept -> bool {
+            auto n = directory->num_arenas.load();
+            if (n >= Constants::iMAX_ARENAS) {
+                return false;
+            }
+
+            byte_ptr_t arena;
+            alloc->allocate_for_remote(arena);
+            if (arena == nullptr) {
+                return false;
+            }
+
+            auto aligned = (reinterpret_cast<uint64_t>(arena) + Constants::uSEGMENT_SIZE - 1) & Constants::uSEGMENT_MASK;
+            for (size_t i = 0; i < Constants::uSEGMENTS_PER_ARENA; i++) {
+                auto seg = &Segment::make_segment(reinterpret_cast<byte_ptr_t>(aligned + i * Constants::uSEGMENT_SIZE));
+                Memory::Util::flush(seg, sizeof(Segment));
+                free_segments.push_back(seg);
+            }
+            Memory::Util::sfence();
+
+            directory->arenas[n] = arena;
+            Memory::Util::flush(&directory->arenas[n], sizeof(byte_ptr_t));
+            Memory::Util::sfence();
+            directory->num_arenas = n + 1;
+            Memory::Util::flush(&directory->num_arenas, sizeof(directory->num_arenas));
+            Memory::Util::sfence();
+            return true;
+        }
+
+        auto ValueLog::free(const byte_ptr_t &value) noexcept -> void {
+            auto rec = RecordHeader::of(value);
+            rec->valid = 0;
+            Memory::Util::flush(&rec->valid, sizeof(rec->valid));
+            Segment::of(value)->live.fetch_sub(rec->total);
+        }
+
+        auto ValueLog::contains(const byte_ptr_t &ptr) const noexcept -> bool {
+            auto n = directory->num_arenas.load();
+            for (int i = 0; i < n; i++) {
+                auto arena = directory->arenas[i];
+                if (ptr >= arena && ptr < arena + Constants::uARENA_SIZE) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        auto ValueLog::for_each_segment(std::function<void(Segment *)> action) const noexcept -> void {
+            auto n = directory->num_arenas.load();
+            for (int i = 0; i < n; i++) {
+                auto aligned = (reinterpret_cast<uint64_t>(directory->arenas[i]) + Constants::uSEGMENT_SIZE - 1) &
+                    Constants::uSEGMENT_MASK;
+                for (size_t s = 0; s < Constants::uSEGMENTS_PER_ARENA; s++) {
+                    action(reinterpret_cast<Segment *>(aligned + s * Constants::uSEGMENT_SIZE));
+                }
+            }
+        }
+
+        auto ValueLog::clean(int tid, RelocateAction relocate) noexcept -> size_t {
+            Segment *victim;
+            {
+                std::scoped_lock<std::mutex> _(victims_locks[tid]);
+                if (victims[tid].empty()) {
+                    return 0;
+                }
+                victim = victims[tid].front();
+                victims[tid].pop_front();
+            }
+
+            // copies are made durable by a single fence before the index is modified
+            std::vector<std::pair<RecordHeader *, byte_ptr_t>> copies;
+            auto cursor = victim->cursor.load();
+            for (size_t offset = sizeof(Segment); offset < cursor;) {
+                auto rec = victim->record_at(offset);
+                offset += rec->total;
+                if (!rec->valid) {
+                    continue;
+                }
+
+                auto value = rec->value();
+                auto copy = write(tid, rec->sequence, KVPair::ValueStamp::of(value)->version, rec->key(), rec->key_size,
+                                  value->raw_bytes(), value->size());
+                if (copy == nullptr) {
+                    // out of segments, give the relocated ones up and retry later
+                    for (auto &c : copies) {
+                        free(c.second);
+                    }
+                    victim->state = Enums::SegmentState::Sealed;
+                    return 0;
+                }
+                copies.emplace_back(rec, copy);
+            }
+            Memory::Util::sfence();
+
+            for (auto &[rec, copy] : copies) {
+                auto old = reinterpret_cast<byte_ptr_t>(rec->value());
+                if (!relocate(rec->key(), rec->key_size, old, copy)) {
+                    free(copy);
+                }
+            }
+            // relocate persists index updates, they must be durable before the victim is reused
+            Memory::Util::sfence();
+
+            victim->owner = -1;
+            victim->cursor = sizeof(Segment);
+            victim->live = 0;
+            victim->state = Enums::SegmentState::Free;
+            Memory::Util::flush(victim, sizeof(Segment));
+            Memory::Util::sfence();
+            {
+                std::scoped_lock<std::mutex> _(free_lock);
+                free_segments.push_back(victim);
+            }
+            return copies.size();
+        }
+
+        auto ValueLog::collect() noexcept -> void {
+            for_each_segment([&](Segment *seg) {
+                auto expected = Enums::SegmentState::Sealed;
+                if (seg->state.load() != expected || seg->owner < 0 || seg->owner >= Constants::iTHREAD_NUM) {
+                    return;
+                }
+
+                if (seg->live.load() == 0) {
+                    // nothing to relocate, recycle it directly
+                    if (seg->state.compare_exchange_strong(expected, Enums::SegmentState::Free)) {
+                        seg->owner = -1;
+                        seg->cursor = sizeof(Segment);
+                        Memory::Util::flush(seg, sizeof(Segment));
+                        Memory::Util::sfence();
+                        std::scoped_lock<std::mutex> _(free_lock);
+                        free_segments.push_back(seg);
+                    }
+                    return;
+                }
+
+                if (seg->live_ratio() < Constants::dCLEAN_THRESHOLD &&
+                    seg->state.compare_exchange_strong(expected, Enums::SegmentState::Cleaning))
+                {
+                    std::scoped_lock<std::mutex> _(victims_locks[seg->owner]);
+                    victims[seg->owner].push_back(seg);
+                }
+            });
+        }
+
+        auto ValueLog::launch_cleaner() -> bool {
+            if (cleaning.exchange(true)) {
+                return false;
+            }
+
+            cleaner = std::thread([&] {
+                while (cleaning.load()) {
+                    collect();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(Constants::uCLEANER_INTERVAL_MS));
+                }
+            });
+#ifdef __HILL_INFO__
+            std::cout << ">> Value log cleaner launched\n";
+#endif
+            return true;
+        }
+
+        auto ValueLog::stop_cleaner() -> void {
+            cleaning = false;
+            if (cleaner.joinable()) {
+                cleaner.join();
+            }
+        }
+    }
+}
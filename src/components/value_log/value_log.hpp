@@ -0,0 +1,243 @@
+#ifndef __HILL__VALUE_LOG__VALUE_LOG__
+#define __HILL__VALUE_LOG__VALUE_LOG__
+#include "memory_manager/memory_manager.hpp"
+#include "kv_pair/kv_pair.hpp"
+
+#include <functional>
+#include <deque>
+#include <thread>
+#include <memory>
+#include <vector>
+
+/*
+ * Log-structured value store
+ *
+ * Instead of a small PM allocation plus a WAL entry per value, each thread appends its values
+ * to its own segment with non-temporal stores. A record carries the key it belongs to, so the
+ * log is the redo record of the value itself.
+ *
+ * Segments live in arenas taken from the allocator with allocate_for_remote. A background
+ * cleaner picks sealed segments with few live bytes and hands them to their owners, and an
+ * owner relocates the live records of a victim when it is idle. Relocation is left to the
+ * owner because only the owner thread modifies its index.
+ */
+namespace Hill {
+    namespace ValueLog {
+        using namespace Memory::TypeAliases;
+        using namespace KVPair::TypeAliases;
+
+        namespace Constants {
+#ifdef __HILL_DEBUG__
+            static constexpr size_t uSEGMENT_SIZE = 64 * 1024UL;
+#else
+            static constexpr size_t uSEGMENT_SIZE = 4 * 1024 * 1024UL;
+#endif
+            static constexpr uint64_t uSEGMENT_MASK = ~(uSEGMENT_SIZE - 1);
+            static constexpr size_t uARENA_SIZE = Memory::Constants::uREMOTE_REGION_SIZE;
+            // one segment may be lost in aligning an arena
+            static constexpr size_t uSEGMENTS_PER_ARENA = uARENA_SIZE / uSEGMENT_SIZE - 1;
+            static constexpr int iMAX_ARENAS = 64;
+            static constexpr int iTHREAD_NUM = Memory::Constants::iTHREAD_LIST_NUM;
+            static constexpr uint64_t uVALUE_LOG_MAGIC = 0x76616c75656c6f67UL;
+            // sealed segments with a lower live ratio are cleaned
+            static constexpr double dCLEAN_THRESHOLD = 0.5;
+            static constexpr uint64_t uCLEANER_INTERVAL_MS = 10;
+        }
+
+        namespace Enums {
+            enum class SegmentState : uint64_t {
+                Free,
+                Active,
+                Sealed,
+                Cleaning,
+            };
+        }
+
+        /*
+         * A record is laid out as follows
+         * | RecordHeader | value (a HillString) | ValueStamp | key bytes |
+         * The index points at the value, so a value can be used as if it were allocated by the
+         * allocator and the header is found right before it
+         */
+        struct RecordHeader {
+            uint64_t sequence;
+            uint32_t key_size;
+            uint32_t value_size;
+            uint32_t valid;
+            uint32_t total;
+
+            inline auto value() noexcept -> hill_value_t * {
+                return reinterpret_cast<hill_value_t *>(reinterpret_cast<byte_ptr_t>(this) + sizeof(RecordHeader));
+            }
+
+            inline auto key() noexcept -> const char * {
+                return reinterpret_cast<const char *>(value()) + KVPair::ValueStamp::stamped_size_of(value_size);
+            }
+
+            static inline auto of(const byte_ptr_t &value) noexcept -> RecordHeader * {
+                return reinterpret_cast<RecordHeader *>(value - sizeof(RecordHeader));
+            }
+
+            static inline auto record_size(size_t k_sz, size_t v_sz) noexcept -> size_t {
+                auto raw = sizeof(RecordHeader) + KVPair::ValueStamp::stamped_size_of(v_sz) + k_sz;
+                return (raw + 7) & ~7UL;
+            }
+        };
+
+        struct Segment {
+            uint64_t magic;
+            int owner;
+            std::atomic<Enums::SegmentState> state;
+            // offset of the next record
+            std::atomic_size_t cursor;
+            // bytes of valid records
+            std::atomic_size_t live;
+
+            static auto make_segment(const byte_ptr_t &ptr) -> Segment & {
+                auto tmp = reinterpret_cast<Segment *>(ptr);
+                tmp->owner = -1;
+                tmp->state = Enums::SegmentState::Free;
+                tmp->cursor = sizeof(Segment);
+                tmp->live = 0;
+                tmp->magic = Constants::uVALUE_LOG_MAGIC;
+                return *tmp;
+            }
+
+            static inline auto of(const byte_ptr_t &ptr) noexcept -> Segment * {
+                return reinterpret_cast<Segment *>(reinterpret_cast<uint64_t>(ptr) & Constants::uSEGMENT_MASK);
+            }
+
+            inline auto record_at(size_t offset) noexcept -> RecordHeader * {
+                return reinterpret_cast<RecordHeader *>(reinterpret_cast<byte_ptr_t>(this) + offset);
+            }
+
+            inline auto live_ratio() const noexcept -> double {
+                return double(live.load()) / (Constants::uSEGMENT_SIZE - sizeof(Segment));
+            }
+
+            Segment() = delete;
+            ~Segment() = delete;
+            Segment(const Segment &) = delete;
+            Segment(Segment &&) = delete;
+            auto operator=(const Segment &) -> Segment & = delete;
+            auto operator=(Segment &&) -> Segment & = delete;
+        };
+
+        /*
+         * The only persistent root of a value log, recording arenas taken from the allocator.
+         * Segments are self-describing, thus are rediscovered by walking the arenas
+         */
+        struct Directory {
+            uint64_t magic;
+            std::atomic_int num_arenas;
+            byte_ptr_t arenas[Constants::iMAX_ARENAS];
+
+            static auto make_directory(const byte_ptr_t &ptr) -> Directory & {
+                auto tmp = reinterpret_cast<Directory *>(ptr);
+                tmp->num_arenas = 0;
+                for (auto &a : tmp->arenas) {
+                    a = nullptr;
+                }
+                tmp->magic = Constants::uVALUE_LOG_MAGIC;
+                return *tmp;
+            }
+        };
+
+        // invoked with the key, the old value and its copy, returns false if the index no longer
+        // points to the old value
+        using RelocateAction = std::function<bool(const char *, size_t, const byte_ptr_t &, const byte_ptr_t &)>;
+        // invoked for each valid record on recovery
+        using RecordAction = std::function<void(const char *, size_t, const byte_ptr_t &)>;
+
+        class ValueLog {
+        public:
+            static auto make_value_log(const byte_ptr_t &base, Memory::Allocator *alloc) -> std::unique_ptr<ValueLog> {
+                auto ret = std::make_unique<ValueLog>();
+                ret->directory = &Directory::make_directory(base);
+                ret->alloc = alloc;
+                return ret;
+            }
+
+            /*
+             * Rebuild the volatile part by walking arenas in the directory. Sequence numbers tell
+             * which record of a key is the latest in case a crash leaves relocated duplicates
+             */
+            static auto recover_or_make_value_log(const byte_ptr_t &base, Memory::Allocator *alloc, RecordAction action)
+                -> std::unique_ptr<ValueLog>;
+
+            ValueLog() : directory(nullptr), alloc(nullptr), sequence(0), cleaning(false) {
+                for (auto &a : active) {
+                    a = nullptr;
+                }
+            }
+            ~ValueLog() {
+                stop_cleaner();
+            }
+            ValueLog(const ValueLog &) = delete;
+            ValueLog(ValueLog &&) = delete;
+            auto operator=(const ValueLog &) -> ValueLog & = delete;
+            auto operator=(ValueLog &&) -> ValueLog & = delete;
+
+            /*
+             * Append a record and return the value in it, or nullptr if no memory is available.
+             * Stores are non-temporal and are not drained, the caller fences before publishing
+             * the returned pointer
+             */
+            auto append(int tid, const hill_key_t *key, const hill_value_t *value, uint32_t version) noexcept -> byte_ptr_t;
+            auto append(int tid, const char *k, size_t k_sz, const char *v, size_t v_sz, uint32_t version) noexcept
+                -> byte_ptr_t;
+            auto free(const byte_ptr_t &value) noexcept -> void;
+            auto contains(const byte_ptr_t &ptr) const noexcept -> bool;
+
+            /*
+             * Relocate live records of one victim handed to tid by the cleaner, returns
+             * the number of relocated records. Should be called by the owner thread when idle
+             */
+            auto clean(int tid, RelocateAction relocate) noexcept -> size_t;
+
+            // Only one cleaner per value log
+            auto launch_cleaner() -> bool;
+            auto stop_cleaner() -> void;
+
+            // valid while the cleaner runs, e.g., for pinning it
+            inline auto get_cleaner() noexcept -> std::thread & {
+                return cleaner;
+            }
+
+            inline auto get_num_arenas() const noexcept -> int {
+                return directory->num_arenas.load();
+            }
+
+            inline auto get_num_free_segments() noexcept -> size_t {
+                std::scoped_lock<std::mutex> _(free_lock);
+                return free_segments.size();
+            }
+
+        private:
+            Directory *directory;
+            Memory::Allocator *alloc;
+            std::atomic_uint64_t sequence;
+
+            Segment *active[Constants::iTHREAD_NUM];
+            std::mutex victims_locks[Constants::iTHREAD_NUM];
+            std::deque<Segment *> victims[Constants::iTHREAD_NUM];
+
+            std::mutex free_lock;
+            std::deque<Segment *> free_segments;
+
+            std::atomic_bool cleaning;
+            std::thread cleaner;
+
+            // pick a free segment for tid, maps a new arena if necessary
+            auto make_active(int tid) noexcept -> Segment *;
+            auto reserve(int tid, size_t size) noexcept -> RecordHeader *;
+            // relocated records keep their sequence numbers and versions
+            auto write(int tid, uint64_t seq, uint32_t version, const char *k, size_t k_sz, const_byte_ptr_t v,
+                       size_t v_sz) noexcept -> byte_ptr_t;
+            auto add_arena() noexcept -> bool;
+            auto for_each_segment(std::function<void(Segment *)> action) const noexcept -> void;
+            auto collect() noexcept -> void;
+        };
+    }
+}
+#endif
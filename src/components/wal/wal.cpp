@@ -1,47 +1,72 @@
 #include "wal.hpp"
+
+#include <chrono>
+#include <iostream>
 namespace Hill {
     namespace WAL {
         std::mutex wal_global_lock;        
-        auto LogRegion::recover(LogEntryAction action) noexcept -> page_vector_ptr {
-            std::unordered_set<Memory::Page *> page_set;
-            auto freed_pages = std::make_unique<std::vector<Memory::Page *>>();
-            for (size_t i = checkpointed; i < cursor; i++) {
-                if (entries[i].status == Enums::LogStatus::Uncommited && entries[i].address != 0) {
-                    if (!action(recover_op(entries[i], page_set, freed_pages))) {
-                        return nullptr;
+        auto PageSet::to_vector() const -> std::vector<Memory::Page *> {
+            std::vector<Memory::Page *> ret;
+            for (auto &shard : shards) {
+                ret.insert(ret.end(), shard.pages.begin(), shard.pages.end());
+            }
+            return ret;
+        }
+
+        auto LogRegion::recover(LogEntryAction action, PageSet &pages) noexcept -> std::optional<size_t> {
+            // entries before committed belong to finished operations even if not checkpointed yet
+            auto start = std::max(committed.load(), checkpointed.load());
+            if (cursor - start > Constants::uREGION_CAPACITY) {
+                start = cursor - Constants::uREGION_CAPACITY;
+            }
+
+            size_t replayed = 0;
+            for (size_t i = start; i < cursor; i++) {
+                auto &entry = entry_at(i);
+                if (entry.get_status() == Enums::LogStatus::Uncommited && entry.get_address() != nullptr &&
+                    !entry.is_remote()) {
+#ifndef __HILL_LOG_ALLOCATOR__
+                    /*
+                     * memory being deleted by an unfinished op may still be referenced, so may memory of
+                     * ops in a group that did not end, leaking it is safer
+                     */
+                    if (entry.get_op() != Enums::Ops::Delete && i < group_start) {
+                        recover_op(entry, pages);
+                    }
+#else
+                    // a log allocator has no page records and never reuses memory, uncommitted memory is leaked
+                    (void)pages;
+#endif
+
+                    if (!action(entry)) {
+                        return {};
                     }
+                    ++replayed;
                 }
             }
             checkpointed = 0;
+            committed = 0;
+            group_start = Constants::uNO_GROUP;
             Memory::Util::mfence();
             cursor = 0;
-            return freed_pages;
+            return replayed;
         }
 
-        auto LogRegion::recover_op(LogEntry &entry,
-                                   std::unordered_set<Memory::Page *> &set,
-                                   page_vector_ptr &freed_pages) noexcept -> LogEntry & {
-            auto addr = entry.address;
+        auto LogRegion::recover_op(LogEntry &entry, PageSet &pages) noexcept -> LogEntry & {
+            auto addr = entry.get_address();
             auto page_ptr = Memory::Page::get_page(addr);
             auto page_as_byte_ptr = reinterpret_cast<byte_ptr_t>(page_ptr);
             auto headers = page_ptr->get_headers();
             auto offset = addr - page_as_byte_ptr;
 
+            std::scoped_lock<std::mutex> _(pages.lock_of(page_ptr));
             for (size_t i = 0; i < page_ptr->header.records; i++) {
                 if (headers[i].offset == offset) {
                     // always reclaim uncommited memory
                     headers[i].offset = 0;
                 }
             }
-
-            if (set.find(page_ptr) == set.end()) {
-                auto ret = recover_page(page_ptr);
-                set.insert(page_ptr);
-                
-                if (ret.has_value()) {
-                    freed_pages->push_back(ret.value());
-                }
-            }
+            pages.insert_locked(page_ptr);
 
             return entry;
         }
@@ -67,28 +92,104 @@ namespace Hill {
             return {};
         }
 
-        auto LogRegion::make_log(Enums::Ops op) noexcept ->  byte_ptr_t & {
-            entries[cursor].address = nullptr;
-            Memory::Util::mfence();
-            entries[cursor].op = op;
-            entries[cursor].status = Enums::LogStatus::Uncommited;
-            Memory::Util::mfence();
+        auto LogRegions::replay(LogEntryAction action, int num_threads) noexcept -> RecoveryReport {
+            auto start = std::chrono::steady_clock::now();
+            num_threads = std::max(1, std::min(num_threads, Constants::iREGION_NUM));
 
-            return entries[cursor++].address;
+            auto run_on_pool = [num_threads](const std::function<void()> &task) {
+                std::vector<std::thread> pool;
+                pool.reserve(num_threads);
+                for (int i = 0; i < num_threads; i++) {
+                    pool.emplace_back(task);
+                }
+                for (auto &t : pool) {
+                    t.join();
+                }
+            };
+
+            PageSet pages;
+            std::atomic_int next_region = 0;
+            std::atomic_size_t entries = 0;
+            std::atomic_bool ok = true;
+            run_on_pool([&] {
+                for (auto i = next_region++; i < Constants::iREGION_NUM; i = next_region++) {
+                    auto replayed = regions[i].recover(action, pages);
+                    if (!replayed.has_value()) {
+                        ok = false;
+                        continue;
+                    }
+                    entries += replayed.value();
+                }
+            });
+
+            // every page is recounted once, after all its headers are reclaimed
+            auto touched = pages.to_vector();
+            std::atomic_size_t next_page = 0;
+            std::atomic_size_t freed = 0;
+            run_on_pool([&] {
+                for (auto i = next_page++; i < touched.size(); i = next_page++) {
+                    if (LogRegion::recover_page(touched[i]).has_value()) {
+                        ++freed;
+                    }
+                }
+            });
+
+            RecoveryReport report;
+            report.ok = ok;
+            report.threads = num_threads;
+            report.entries = entries;
+            report.pages = touched.size();
+            report.freed_pages = freed;
+            report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            return report;
         }
 
-        auto LogRegion::checkpoint() noexcept -> void {
-            for (size_t i = checkpointed; i < cursor; i++) {
+        auto LogRegion::make_log(Enums::Ops op) noexcept -> LogEntry & {
+            // no fence, a reserved entry carries no address and is ignored by recovery
+            auto &entry = entry_at(cursor++);
+            entry.reserve(op);
+            HILL_CRASH_POINT("wal.make_log");
+            return entry;
+        }
+
+        auto LogRegion::flush_entries(size_t from, size_t to) noexcept -> void {
+            if (to <= from) {
+                return;
+            }
+
+            if (to - from >= Constants::uREGION_CAPACITY) {
+                Memory::Util::flush(&entries[0], sizeof(entries));
+                return;
+            }
+
+            auto head = from % Constants::uREGION_CAPACITY;
+            auto tail = to % Constants::uREGION_CAPACITY;
+            if (head < tail) {
+                Memory::Util::flush(&entries[head], (tail - head) * sizeof(LogEntry));
+            } else {
+                // wrapped around
+                Memory::Util::flush(&entries[head], (Constants::uREGION_CAPACITY - head) * sizeof(LogEntry));
+                Memory::Util::flush(&entries[0], tail * sizeof(LogEntry));
+            }
+        }
+
+        auto LogRegion::checkpoint_to(size_t target) noexcept -> void {
+            auto from = checkpointed.load(std::memory_order_relaxed);
+            if (target <= from) {
+                return;
+            }
+
+            for (size_t i = from; i < target; i++) {
                 // no need to check if entry is UNCOMMITED because this is a runtime method
-                entries[i].commit();
+                entry_at(i).commit();
             }
-            checkpointed = 0;
-            Memory::Util::mfence();            
-            cursor = checkpointed;
-#ifdef PMEM
-            // checkpointed is not forced to persist since recover just replays the checkpointing
-            pmem_persist(&cursor, sizeof(cursor));
-#endif
+            flush_entries(from, target);
+            Memory::Util::sfence();
+
+            // releasing slots to the owner, it is ok if the tail is lost in a crash because
+            // recovery starts from committed
+            checkpointed.store(target, std::memory_order_release);
+            Memory::Util::flush(&checkpointed, sizeof(checkpointed));
         }
 
         auto Logger::register_thread() noexcept -> std::optional<int> {
@@ -103,10 +204,104 @@ namespace Hill {
         }
 
         auto Logger::unregister_thread(int id) noexcept -> void {
-            regions->regions[id].checkpoint();
+            if (grouping[id]) {
+                end_group(id);
+            }
+            checkpoint(id);
             in_use[id] = false;
             counters[id] = 0;
         }
 
+        auto Logger::end_group(int id) noexcept -> void {
+            auto &region = regions->regions[id];
+            region.flush_entries(group_starts[id], region.cursor);
+            // one fence orders every entry and every persist() issued in this group
+            Memory::Util::sfence();
+            grouping[id] = false;
+            publish_committed(id);
+            // entries of the group are before committed now, a stale start only leaks what comes after
+            region.group_start = Constants::uNO_GROUP;
+            Memory::Util::flush(&region.group_start, sizeof(region.group_start));
+        }
+
+        auto Logger::publish_committed(int id) noexcept -> void {
+            auto &region = regions->regions[id];
+            region.committed.store(region.cursor, std::memory_order_release);
+            Memory::Util::flush(&region.committed, sizeof(region.committed));
+            // durable before the operations are acknowledged, end_group calls this after closing the group
+            if (!grouping[id]) {
+                Memory::Util::sfence();
+            }
+
+            if (!checkpointing.load(std::memory_order_relaxed) && counters[id] >= Constants::uBATCH_SIZE) {
+                region.checkpoint();
+                counters[id] = 0;
+            }
+        }
+
+        auto Logger::make_room(int id) noexcept -> void {
+            auto &region = regions->regions[id];
+            if (checkpointing.load()) {
+                // backpressure, the checkpointer frees slots as soon as committed entries show up
+                std::this_thread::yield();
+                return;
+            }
+
+            if (region.committed.load() == region.checkpointed.load()) {
+                // a single group can never fill a region, so reaching here is a misuse
+                std::cerr << ">> Log region " << id << " is full of uncommitted entries\n";
+                std::terminate();
+            }
+            region.checkpoint();
+            counters[id] = 0;
+        }
+
+        auto Logger::checkpoint(int id) noexcept -> void {
+            auto &region = regions->regions[id];
+            // runtime checkpointing regards every entry as finished
+            region.committed.store(region.cursor, std::memory_order_release);
+            while (checkpointing.load()) {
+                if (region.checkpointed.load(std::memory_order_acquire) == region.cursor) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            region.checkpoint();
+        }
+
+        auto Logger::launch_checkpointer() -> bool {
+            if (checkpointing.exchange(true)) {
+                return false;
+            }
+
+            checkpointer = std::thread([&] {
+                while (checkpointing.load()) {
+                    bool progressed = false;
+                    for (auto &region : regions->regions) {
+                        auto target = region.committed.load(std::memory_order_acquire);
+                        if (target != region.checkpointed.load(std::memory_order_relaxed)) {
+                            region.checkpoint_to(target);
+                            progressed = true;
+                        }
+                    }
+
+                    if (!progressed) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(Constants::uCHECKPOINT_INTERVAL_US));
+                    }
+                }
+            });
+#ifdef __HILL_INFO__
+            std::cout << ">> WAL checkpointer launched\n";
+#endif
+            return true;
+        }
+
+        auto Logger::stop_checkpointer() -> void {
+            checkpointing = false;
+            if (checkpointer.joinable()) {
+                checkpointer.join();
+            }
+        }
+
     }
 }
@@ -4,9 +4,15 @@
 #include "memory_manager/memory_manager.hpp"
 #include "config/config.hpp"
 
+#include <iostream>
 #include <memory>
 #include <functional>
+#include <limits>
 #include <unordered_set>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
 
 namespace Hill {
     using namespace Memory::TypeAliases;
@@ -21,7 +27,16 @@ namespace Hill {
             static constexpr size_t uBATCH_SIZE = 64UL;
             static constexpr size_t uREGION_SIZE = 1024UL;
 #endif
-            static constexpr uint64_t uLOG_REGIONS_MAGIC = 0x1357246813572468UL;
+            // number of entries in a region, the region is used as a ring
+            static constexpr size_t uREGION_CAPACITY = uBATCH_SIZE * uREGION_SIZE;
+            // how long the background checkpointer naps when no region has progressed
+            static constexpr size_t uCHECKPOINT_INTERVAL_US = 50;
+            static constexpr int iRECOVERY_THREADS = 8;
+            static constexpr size_t uPAGE_SET_SHARDS = 64;
+            // bumped whenever the layout of LogEntry or LogRegion changes, older regions are remade
+            static constexpr uint64_t uLOG_REGIONS_MAGIC = 0x135724681357246aUL;
+            // group_start of a region with no open group
+            static constexpr size_t uNO_GROUP = std::numeric_limits<size_t>::max();
         }
 
         namespace Enums {
@@ -62,44 +77,77 @@ namespace Hill {
             using SharedLogger = std::shared_ptr<Logger>;
         }
 
+        /*
+         * A LogEntry is a single word so that it is published or committed by one 8-byte store.
+         * Op and status are packed into bits 48-55, which are always zero in user-space addresses
+         * and are only a filling hint in a RemotePointer, so both local and remote addresses can
+         * be logged
+         *
+         * 63      56 55    52 51    48 47                     0
+         * -----------------------------------------------------
+         * | remote  | status |   op   |        address        |
+         * -----------------------------------------------------
+         */
         struct LogEntry {
-            byte_ptr_t address;
-            Enums::Ops op;
-            Enums::LogStatus status;
+            std::atomic_uint64_t word;
 
-            LogEntry() : address(nullptr), op(Enums::Ops::Unknown),status(Enums::LogStatus::None) {};
+            static constexpr uint64_t uADDRESS_MASK = 0xff00ffffffffffffUL;
+            static constexpr uint64_t uOP_SHIFT = 48;
+            static constexpr uint64_t uSTATUS_SHIFT = 52;
+            static constexpr uint64_t uFIELD_MASK = 0xfUL;
+            static constexpr uint64_t uREMOTE_BITS_MASK = 0xc000000000000000UL;
+            static constexpr uint64_t uREMOTE_BITS = 0x8000000000000000UL;
+
+            LogEntry() : word(pack(nullptr, Enums::Ops::Unknown, Enums::LogStatus::None)) {};
 
             static auto make_entry(const byte_ptr_t &ptr) -> LogEntry & {
                 auto tmp = reinterpret_cast<LogEntry *>(ptr);
-                tmp->address = nullptr;
-                tmp->op = Enums::Ops::Unknown;
-                tmp->status = Enums::LogStatus::None;
+                tmp->word.store(pack(nullptr, Enums::Ops::Unknown, Enums::LogStatus::None), std::memory_order_relaxed);
                 return *tmp;
             }
 
-            inline auto get_address() noexcept -> byte_ptr_t & {
-                return address;
+            static inline auto pack(byte_ptr_t address, Enums::Ops op, Enums::LogStatus status) noexcept -> uint64_t {
+                return (reinterpret_cast<uint64_t>(address) & uADDRESS_MASK) |
+                    ((static_cast<uint64_t>(op) & uFIELD_MASK) << uOP_SHIFT) |
+                    ((static_cast<uint64_t>(status) & uFIELD_MASK) << uSTATUS_SHIFT);
+            }
+
+            inline auto get_address() const noexcept -> byte_ptr_t {
+                return reinterpret_cast<byte_ptr_t>(word.load(std::memory_order_relaxed) & uADDRESS_MASK);
+            }
+
+            inline auto get_op() const noexcept -> Enums::Ops {
+                return static_cast<Enums::Ops>((word.load(std::memory_order_relaxed) >> uOP_SHIFT) & uFIELD_MASK);
+            }
+
+            inline auto get_status() const noexcept -> Enums::LogStatus {
+                return static_cast<Enums::LogStatus>((word.load(std::memory_order_relaxed) >> uSTATUS_SHIFT) & uFIELD_MASK);
             }
 
-            inline auto set_op(Enums::Ops _op) noexcept -> void {
-                op = _op;
+            // remote memory is reclaimed by its owner, never by local recovery
+            inline auto is_remote() const noexcept -> bool {
+                return (word.load(std::memory_order_relaxed) & uREMOTE_BITS_MASK) == uREMOTE_BITS;
             }
 
-            inline auto get_op() const noexcept -> const Enums::Ops & {
-                return op;
+            // reserve this entry for an operation whose address is not known yet
+            inline auto reserve(Enums::Ops op) noexcept -> void {
+                word.store(pack(nullptr, op, Enums::LogStatus::Uncommited), std::memory_order_release);
             }
 
-            inline auto get_status() const noexcept -> const Enums::LogStatus & {
-                return status;
+            // record the address the on-going operation is working on
+            inline auto publish(const byte_ptr_t &address) noexcept -> void {
+                word.store(pack(address, get_op(), Enums::LogStatus::Uncommited), std::memory_order_release);
             }
 
             inline auto commit() noexcept -> void {
-                status = Enums::LogStatus::Committed;
+                auto w = word.load(std::memory_order_relaxed);
+                w &= ~(uFIELD_MASK << uSTATUS_SHIFT);
+                w |= static_cast<uint64_t>(Enums::LogStatus::Committed) << uSTATUS_SHIFT;
+                word.store(w, std::memory_order_release);
             }
 
             inline auto reset() noexcept -> void {
-                address = nullptr;
-                status = Enums::LogStatus::None;
+                word.store(pack(nullptr, get_op(), Enums::LogStatus::None), std::memory_order_release);
             }
 
             ~LogEntry() = default;
@@ -109,20 +157,61 @@ namespace Hill {
             auto operator=(LogEntry &&) -> LogEntry & = delete;
 
         };
-
+        static_assert(sizeof(LogEntry) == sizeof(uint64_t), "LogEntry should be a single word");
 
         /*
-         * A LogRegion is a continuous persistent memory chunk recording operations
-         *
-         * A thread first get a LogEntry via make_log. Then it decides if a commit
-         * is needed and call LogEntry::commit to actively commit a log. Or it can
-         * wait for a checkpointing for batch commit.
+         * Pages touched by log replay. Regions are replayed concurrently and different regions may
+         * point into the same page, so the lock of a page's shard also guards its record headers
          */
+        class PageSet {
+        public:
+            PageSet() = default;
+            ~PageSet() = default;
+            PageSet(const PageSet &) = delete;
+            PageSet(PageSet &&) = delete;
+            auto operator=(const PageSet &) -> PageSet & = delete;
+            auto operator=(PageSet &&) -> PageSet & = delete;
+
+            inline auto lock_of(Memory::Page *page) noexcept -> std::mutex & {
+                return shard_of(page).lock;
+            }
+
+            // the shard lock of page must be held
+            inline auto insert_locked(Memory::Page *page) -> void {
+                shard_of(page).pages.insert(page);
+            }
+
+            auto to_vector() const -> std::vector<Memory::Page *>;
+        private:
+            struct Shard {
+                std::mutex lock;
+                std::unordered_set<Memory::Page *> pages;
+            };
+            Shard shards[Constants::uPAGE_SET_SHARDS];
+
+            inline auto shard_of(Memory::Page *page) noexcept -> Shard & {
+                return shards[(reinterpret_cast<uint64_t>(page) / Memory::Constants::uPAGE_SIZE) % Constants::uPAGE_SET_SHARDS];
+            }
+        };
+
+        struct RecoveryReport {
+            bool ok;
+            int threads;
+            size_t entries;
+            size_t pages;
+            size_t freed_pages;
+            std::chrono::microseconds elapsed;
+        };
+
+        // replay callbacks are invoked concurrently from multiple threads
         using LogEntryAction = std::function<bool(LogEntry &)>;
         struct LogRegion {
-            size_t checkpointed;
+            std::atomic_size_t checkpointed;
+            std::atomic_size_t committed;
             size_t cursor;
-            LogEntry entries[Constants::uBATCH_SIZE * Constants::uREGION_SIZE];
+            // first entry of the open group, durable before any entry of the group is
+            size_t group_start;
+            LogEntry entries[Constants::uREGION_CAPACITY];
 
             static auto make_region(const byte_ptr_t &ptr) -> LogRegion & {
                 auto tmp = reinterpret_cast<LogRegion *>(ptr);
@@ -131,26 +220,49 @@ namespace Hill {
                     LogEntry::make_entry(reinterpret_cast<byte_ptr_t>(&e));
                 }
                 tmp->checkpointed = 0;
+                tmp->committed = 0;
                 tmp->cursor = 0;
+                tmp->group_start = Constants::uNO_GROUP;
                 return *tmp;
             }
 
+            inline auto entry_at(size_t index) noexcept -> LogEntry & {
+                return entries[index % Constants::uREGION_CAPACITY];
+            }
+
+            inline auto is_full() const noexcept -> bool {
+                return cursor - checkpointed.load(std::memory_order_acquire) >= Constants::uREGION_CAPACITY;
+            }
+
             /*
              * Recover iterates over each uncheckpointed log entry and apply the
              * user-defined callback to the entry
              *
-             * During the iteration, memory chunks are logically reclaimed, contents
+             * During the iteration, memory chunks are logically reclaimed except those of Delete
+             * entries, which may still be referenced if the op did not finish, and those of an
+             * open group, which its ops may have linked before the crash. Contents
              * in the memory chunks are not touched, thus the callback is allowed
              * to use the contents. The logically reclaimed memory chunks is allocated
              * upon allocation, thus once recovery is done, the contents are not
              * guaranteed to be valid.
+             *
+             * Touched pages are collected in pages, each of them should be passed to
+             * recover_page once all regions are replayed. Returns the number of replayed
+             * entries, or nothing if the callback fails.
              */
-            using page_vector_ptr = std::unique_ptr<std::vector<Memory::Page *>>;
-            auto recover(LogEntryAction log_action) noexcept -> page_vector_ptr;
-
-            // it is possible that log runs out the region, use with caution
-            auto make_log(Enums::Ops op) noexcept -> byte_ptr_t & ;
-            auto checkpoint() noexcept -> void;
+            auto recover(LogEntryAction log_action, PageSet &pages) noexcept -> std::optional<size_t>;
+            // recount valid records of a page, returns the page if it turns out to be empty
+            static auto recover_page(Memory::Page *) noexcept -> std::optional<Memory::Page *>;
+
+            // the caller must make sure the region is not full, see Logger::make_log
+            auto make_log(Enums::Ops op) noexcept -> LogEntry &;
+            // write back entries in [from, to), no fence is issued
+            auto flush_entries(size_t from, size_t to) noexcept -> void;
+            // commit entries in [checkpointed, target) and advance checkpointed to target
+            auto checkpoint_to(size_t target) noexcept -> void;
+            inline auto checkpoint() noexcept -> void {
+                checkpoint_to(committed.load(std::memory_order_acquire));
+            }
 
             LogRegion() = delete;
             ~LogRegion() = default;
@@ -165,8 +277,7 @@ namespace Hill {
              * memory. Contents in reclaimed memory chunk are not touched, so applications can still use
              * the contents.
              */
-            auto recover_op(LogEntry &, std::unordered_set<Memory::Page *> &, page_vector_ptr &) noexcept -> LogEntry &;
-            auto recover_page(Memory::Page *) noexcept -> std::optional<Memory::Page *>;
+            auto recover_op(LogEntry &, PageSet &) noexcept -> LogEntry &;
         };
 
         struct LogRegions {
@@ -184,18 +295,31 @@ namespace Hill {
                 return *tmp;
             }
 
-            static auto recover_or_make_regions(const byte_ptr_t &ptr, LogEntryAction action) noexcept -> LogRegions & {
+            static auto recover_or_make_regions(const byte_ptr_t &ptr, LogEntryAction action,
+                                                int num_threads = Constants::iRECOVERY_THREADS) noexcept -> LogRegions & {
                 auto tmp = reinterpret_cast<LogRegions *>(ptr);
 
                 if (tmp->magic == Constants::uLOG_REGIONS_MAGIC) {
-                    for (int i = 0; i < Constants::iREGION_NUM; i++) {
-                        tmp->regions[i].recover(action);
+                    auto report = tmp->replay(action, num_threads);
+#ifdef __HILL_INFO__
+                    std::cout << ">> WAL replayed " << report.entries << " entries over " << report.pages
+                              << " pages (" << report.freed_pages << " freed) with " << report.threads
+                              << " threads in " << report.elapsed.count() << "us\n";
+#endif
+                    if (!report.ok) {
+                        std::cerr << ">> WAL replay callback failed\n";
                     }
                 }
 
                 return make_regions(ptr);
             }
 
+            /*
+             * Replay all regions on a pool of num_threads threads. Regions are handed out one at a time,
+             * then every touched page is recounted exactly once, also in parallel.
+             */
+            auto replay(LogEntryAction action, int num_threads) noexcept -> RecoveryReport;
+
             LogRegions() = delete;
             ~LogRegions() = default;
             LogRegions(const LogRegions &) = delete;
@@ -213,6 +337,10 @@ namespace Hill {
          * Upon recovery, each address should be checked, i.e., the page owning the the address.
          * should be scanned to find the exact number of valid records. Since logging entryies are
          * committed in batches, there at most Constants::iREGION_NUM * Constants::uBATCH_SIZE
+         *
+         * Once launch_checkpointer is called, a background thread checkpoints every region as soon
+         * as its owner commits, so owners never pay for checkpointing. A thread finding its region
+         * full waits for the checkpointer instead of overrunning the ring.
          */
         class Logger {
         public:
@@ -250,23 +378,103 @@ namespace Hill {
 
             auto register_thread() noexcept -> std::optional<int>;
             auto unregister_thread(int id) noexcept -> void;
-            inline auto make_log(int id, Enums::Ops op) noexcept -> byte_ptr_t & {
-                return regions->regions[id].make_log(op);
+            /*
+             * Reserve an entry for op. The caller then publishes the address it is going to work
+             * on via publish. Allocations are published by the allocator before it commits them, e.g.,
+             *     auto &entry = logger->make_log(tid, op);
+             *     PendingEntry pending(*logger, tid, entry);
+             *     alloc->allocate(tid, size, ptr, &pending);
+             */
+            inline auto make_log(int id, Enums::Ops op) noexcept -> LogEntry & {
+                auto &region = regions->regions[id];
+                while (region.is_full()) {
+                    make_room(id);
+                }
+
+                return region.make_log(op);
             }
 
+            // a single 8-byte store, plus a write back and a fence unless in a group
+            inline auto publish(int id, LogEntry &entry, const byte_ptr_t &address) noexcept -> void {
+                entry.publish(address);
+                HILL_CRASH_POINT("wal.publish");
+                if (!grouping[id]) {
+                    Memory::Util::flush(&entry, sizeof(LogEntry));
+                    Memory::Util::sfence();
+                }
+            }
+
+            /*
+             * All entries made by this thread so far belong to finished operations. Memory should be
+             * committed before it is linked into the index, otherwise recovery reclaims referenced memory
+             */
             inline auto commit(int id) noexcept -> void {
-                if (++counters[id] == Constants::uBATCH_SIZE) {
-                    regions->regions[id].checkpoint();
-                    counters[id] = 0;
+                ++counters[id];
+                // entries in a group are not durable before end_group
+                if (!grouping[id]) {
+                    publish_committed(id);
+                    HILL_CRASH_POINT("wal.commit");
+                }
+            }
+
+            /*
+             * Group commit
+             *
+             * Between begin_group and end_group, publish and persist only write back cache lines
+             * without fences. end_group writes back all entries made in the
+             * group and issues a single sfence, so a thread draining a batch of requests pays one
+             * fence for the whole batch instead of two per entry.
+             *
+             * Operations of a group are not durable until end_group returns, so none of them should
+             * be acknowledged before. They commit before end_group and may already be linked into
+             * the index, thus after a crash in the middle of a group recovery leaks the memory they
+             * published instead of reclaiming it, and they may or may not be found. To tell them
+             * apart, begin_group makes the start of the group durable with a fence of its own.
+             */
+            inline auto begin_group(int id) noexcept -> void {
+                auto &region = regions->regions[id];
+                grouping[id] = true;
+                group_starts[id] = region.cursor;
+                region.group_start = region.cursor;
+                Memory::Util::flush(&region.group_start, sizeof(region.group_start));
+                Memory::Util::sfence();
+            }
+
+            auto end_group(int id) noexcept -> void;
+
+            // persist data written under the protection of a log entry, e.g., a newly copied value
+            inline auto persist(int id, const void *addr, size_t size) noexcept -> void {
+                Memory::Util::flush(addr, size);
+                if (!grouping[id]) {
+                    Memory::Util::sfence();
+                }
+            }
+
+            // order data written without a log entry, e.g., a value log record, unless in a group
+            inline auto fence(int id) noexcept -> void {
+                if (!grouping[id]) {
+                    Memory::Util::sfence();
                 }
             }
 
-            inline auto checkpoint(int id) noexcept -> void {
-                regions->regions[id].checkpoint();
+            auto checkpoint(int id) noexcept -> void;
+
+            /*
+             * Only one checkpointer per logger. stop_checkpointer should be called when no thread
+             * is logging, afterwards threads checkpoint their own regions again.
+             */
+            auto launch_checkpointer() -> bool;
+            auto stop_checkpointer() -> void;
+
+            // valid while the checkpointer runs, e.g., for pinning it
+            inline auto get_checkpointer() noexcept -> std::thread & {
+                return checkpointer;
             }
 
             Logger() = default;
-            ~Logger() = default;
+            ~Logger() {
+                stop_checkpointer();
+            }
             Logger(const Logger &) = delete;
             Logger(Logger &&) = delete;
             auto operator=(const Logger &) -> Logger & = delete;
@@ -276,13 +484,41 @@ namespace Hill {
             LogRegions *regions;
             bool in_use[Constants::iREGION_NUM];
             size_t counters[Constants::iREGION_NUM];
+            bool grouping[Constants::iREGION_NUM];
+            size_t group_starts[Constants::iREGION_NUM];
+            std::atomic_bool checkpointing;
+            std::thread checkpointer;
 
             auto init_utility() noexcept -> void {
                 for (int i = 0; i < Constants::iREGION_NUM; i++) {
                     in_use[i] = false;
                     counters[i] = 0;
+                    grouping[i] = false;
+                    group_starts[i] = 0;
                 }
+                checkpointing = false;
             }
+
+            // expose finished entries to checkpointing
+            auto publish_committed(int id) noexcept -> void;
+            // called by make_log when a region is full
+            auto make_room(int id) noexcept -> void;
+        };
+
+        // publishes an allocation to a reserved entry right before the allocator commits it
+        class PendingEntry : public Memory::AllocationListener {
+        public:
+            PendingEntry(Logger &logger_, int id_, LogEntry &entry_) noexcept
+                : logger(logger_), id(id_), entry(entry_) {}
+
+            auto on_allocate(const byte_ptr_t &ptr) noexcept -> void override {
+                logger.publish(id, entry, ptr);
+            }
+
+        private:
+            Logger &logger;
+            int id;
+            LogEntry &entry;
         };
     }
 }
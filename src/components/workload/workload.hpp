@@ -18,6 +18,12 @@ namespace Hill {
                 Range,                
 
                 Unknownk,
+
+                // read-modify-writes, key_or_value is the operand
+                // numbered after the RPC operations of store.hpp, so none of those is renumbered
+                CompareAndSwap = 8,
+                FetchAdd,
+                Append,
             };
         }
 
@@ -0,0 +1,137 @@
+#include "store/batch/batch.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+using namespace Hill::KVPair::TypeAliases;
+
+// | hill_key_t | hill_value_t | of every pair, values are left out if empty
+static auto encode(std::vector<uint8_t> &buf, const std::vector<std::pair<std::string, std::string>> &pairs) -> void {
+    size_t size = 0;
+    for (const auto &[k, v] : pairs) {
+        size += KVPair::HillString::object_size_of(k.size());
+        if (!v.empty()) {
+            size += KVPair::HillString::object_size_of(v.size());
+        }
+    }
+    buf.assign(size, 0);
+
+    auto p = buf.data();
+    for (const auto &[k, v] : pairs) {
+        KVPair::HillString::make_string(p, k.c_str(), k.size());
+        p += reinterpret_cast<hill_key_t *>(p)->object_size();
+        if (!v.empty()) {
+            KVPair::HillString::make_string(p, v.c_str(), v.size());
+            p += reinterpret_cast<hill_value_t *>(p)->object_size();
+        }
+    }
+}
+
+static auto decode(const uint8_t *p, const uint8_t *end, bool with_values)
+    -> std::vector<std::pair<std::string, std::string>>
+{
+    std::vector<std::pair<std::string, std::string>> ret;
+    while (p < end) {
+        auto key = reinterpret_cast<const hill_key_t *>(p)->to_string();
+        std::string value;
+        if (with_values) {
+            value = reinterpret_cast<const hill_value_t *>(p + reinterpret_cast<const hill_key_t *>(p)->object_size())->to_string();
+        }
+        p += Batch::entry_size(p, with_values);
+        ret.emplace_back(key, value);
+    }
+    assert(p == end);
+    return ret;
+}
+
+int main() {
+    // entries of different sizes kept by a MultiInsert are packed in order
+    {
+        std::vector<std::pair<std::string, std::string>> pairs = {
+            {"a", "1"}, {"longer key", "short"}, {"k", std::string(300, 'v')}, {"key4", "value4"}, {"z", "last"},
+        };
+        std::vector<uint8_t> buf;
+        encode(buf, pairs);
+
+        std::vector<uint32_t> visited;
+        auto end = Batch::repack(buf.data(), pairs.size(), true, [&](uint32_t i) {
+            visited.push_back(i);
+            return i == 1 || i == 2 || i == 4;
+        });
+        assert((visited == std::vector<uint32_t>{0, 1, 2, 3, 4}));
+        auto packed = decode(buf.data(), end, true);
+        assert((packed == std::vector<std::pair<std::string, std::string>>{pairs[1], pairs[2], pairs[4]}));
+
+        // nothing is kept, the request is done
+        encode(buf, pairs);
+        assert(Batch::repack(buf.data(), pairs.size(), true, [](uint32_t) { return false; }) == buf.data());
+
+        // everything is kept, the request is sent again as it is
+        encode(buf, pairs);
+        auto copy = buf;
+        assert(Batch::repack(buf.data(), pairs.size(), true, [](uint32_t) { return true; }) == buf.data() + buf.size());
+        assert(buf == copy);
+    }
+    std::cout << "Succeded\n";
+
+    // MultiSearch entries are keys only
+    {
+        std::vector<std::pair<std::string, std::string>> keys = {{"s0", ""}, {"search 1", ""}, {"s2", ""}};
+        std::vector<uint8_t> buf;
+        encode(buf, keys);
+        auto end = Batch::repack(buf.data(), keys.size(), false, [](uint32_t i) { return i != 0; });
+        auto packed = decode(buf.data(), end, false);
+        assert((packed == std::vector<std::pair<std::string, std::string>>{keys[1], keys[2]}));
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * The server answers some keys Busy in each round, the client sends the busy ones again until
+     * none is left. Every key is answered exactly once, with the value it was sent with
+     */
+    {
+        std::vector<std::pair<std::string, std::string>> pairs;
+        for (int i = 0; i < 64; i++) {
+            pairs.emplace_back("key" + std::to_string(i), std::string(i % 7 + 1, 'a' + i % 26));
+        }
+        std::vector<uint8_t> buf;
+        encode(buf, pairs);
+        std::vector<int> keys;
+        for (int i = 0; i < 64; i++) {
+            keys.push_back(i);
+        }
+
+        std::vector<int> answered(pairs.size(), 0);
+        auto end = buf.data() + buf.size();
+        for (int round = 0; !keys.empty(); round++) {
+            // what the server receives this round
+            auto received = decode(buf.data(), end, true);
+            assert(received.size() == keys.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                assert(received[i] == pairs[keys[i]]);
+            }
+
+            uint32_t busy = 0;
+            end = Batch::repack(buf.data(), keys.size(), true, [&](uint32_t i) {
+                if ((keys[i] + round) % 3 == 0) {
+                    keys[busy++] = keys[i];
+                    return true;
+                }
+                ++answered[keys[i]];
+                return false;
+            });
+            keys.resize(busy);
+            assert(round < 64);
+        }
+        for (auto a : answered) {
+            assert(a == 1);
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
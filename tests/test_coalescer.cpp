@@ -0,0 +1,163 @@
+#include "store/coalescer/coalescer.hpp"
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill::Store;
+
+constexpr size_t group_size = 32;
+
+enum class Op { Search, Update, Range };
+
+struct Message {
+    Op op;
+    std::string key;
+    int value;
+    int result;
+};
+
+/*
+ * Runs a group as a backend does, returns how many messages reach the index. A search copies
+ * the result of an earlier one of the same key unless the key is written in between
+ */
+template<typename H>
+static auto run_group(std::vector<Message> &batch, std::map<std::string, int> &index, H &&hash) -> size_t {
+    SearchCoalescer<group_size> coalescer;
+    size_t executed = 0;
+    auto execute = [&](Message &msg) {
+        ++executed;
+        if (msg.op == Op::Update) {
+            index[msg.key] = msg.value;
+        } else if (msg.op == Op::Search) {
+            auto it = index.find(msg.key);
+            msg.result = it == index.end() ? -1 : it->second;
+        }
+    };
+
+    for (size_t m = 0; m < batch.size(); m++) {
+        auto &msg = batch[m];
+        if (msg.op != Op::Search && !(msg.op == Op::Update && !coalescer.empty())) {
+            execute(msg);
+            continue;
+        }
+
+        auto h = hash(msg.key);
+        if (msg.op != Op::Search) {
+            coalescer.written(h);
+            execute(msg);
+            continue;
+        }
+
+        auto leader = coalescer.leader_of(h, [&](size_t r) { return batch[r].key == msg.key; });
+        if (leader != coalescer.npos) {
+            assert(leader < m && batch[leader].op == Op::Search);
+            msg.result = batch[leader].result;
+            continue;
+        }
+        execute(msg);
+        coalescer.lead(m, h);
+    }
+    return executed;
+}
+
+int main() {
+    std::hash<std::string> hasher;
+    auto hash = [&](const std::string &k) -> uint64_t { return hasher(k); };
+    // every key collides, only the keys themselves tell searches apart
+    auto colliding = [](const std::string &) -> uint64_t { return 42; };
+
+    // searches of a hot key are run once per group, a write in between makes the next one run again
+    {
+        std::map<std::string, int> index = {{"hot", 1}, {"cold", 2}};
+        std::vector<Message> batch = {
+            {Op::Search, "hot", 0, 0}, {Op::Search, "hot", 0, 0}, {Op::Search, "cold", 0, 0},
+            {Op::Search, "hot", 0, 0}, {Op::Update, "hot", 5, 0}, {Op::Search, "hot", 0, 0},
+            {Op::Search, "hot", 0, 0}, {Op::Search, "cold", 0, 0}, {Op::Range, "cold", 0, 0},
+        };
+        assert(run_group(batch, index, hash) == 5);
+        std::vector<int> results;
+        for (auto &m : batch) {
+            if (m.op == Op::Search) {
+                results.push_back(m.result);
+            }
+        }
+        assert((results == std::vector<int>{1, 1, 2, 1, 5, 5, 2}));
+
+        // a key hashed the same as another is not taken for it
+        for (auto &m : batch) {
+            m.result = 0;
+        }
+        index = {{"hot", 1}, {"cold", 2}};
+        assert(run_group(batch, index, colliding) == 6);
+        results.clear();
+        for (auto &m : batch) {
+            if (m.op == Op::Search) {
+                results.push_back(m.result);
+            }
+        }
+        assert((results == std::vector<int>{1, 1, 2, 1, 5, 5, 2}));
+    }
+    std::cout << "Succeded\n";
+
+    // a group without searches never hashes a key, nothing is kept across groups
+    {
+        SearchCoalescer<group_size> coalescer;
+        assert(coalescer.empty());
+        coalescer.lead(0, 1);
+        coalescer.lead(1, 2);
+        assert(coalescer.leader_of(2, [](size_t) { return true; }) == 1);
+        assert(coalescer.leader_of(2, [](size_t) { return false; }) == coalescer.npos);
+        coalescer.written(1);
+        assert(!coalescer.empty() && coalescer.leader_of(1, [](size_t) { return true; }) == coalescer.npos);
+        coalescer.reset();
+        assert(coalescer.empty() && coalescer.leader_of(2, [](size_t) { return true; }) == coalescer.npos);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Random groups of searches and updates over a few skewed keys return what running every
+     * message in order returns, with both real and colliding hashes
+     */
+    {
+        std::mt19937 rng(7);
+        for (int round = 0; round < 2000; round++) {
+            std::vector<Message> batch;
+            auto size = rng() % group_size + 1;
+            for (size_t i = 0; i < size; i++) {
+                auto k = rng() % 8;
+                auto op = rng() % 4 == 0 ? Op::Update : Op::Search;
+                batch.push_back({op, "key" + std::to_string(k * k % 5), int(rng() % 1000), 0});
+            }
+
+            std::map<std::string, int> expected_index = {{"key0", 0}, {"key1", 1}};
+            auto expected = batch;
+            for (auto &m : expected) {
+                if (m.op == Op::Update) {
+                    expected_index[m.key] = m.value;
+                } else {
+                    auto it = expected_index.find(m.key);
+                    m.result = it == expected_index.end() ? -1 : it->second;
+                }
+            }
+
+            for (int h = 0; h < 2; h++) {
+                auto got = batch;
+                std::map<std::string, int> index = {{"key0", 0}, {"key1", 1}};
+                auto executed = h == 0 ? run_group(got, index, hash) : run_group(got, index, colliding);
+                assert(executed <= got.size());
+                assert(index == expected_index);
+                for (size_t m = 0; m < got.size(); m++) {
+                    assert(got[m].result == expected[m].result);
+                }
+            }
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
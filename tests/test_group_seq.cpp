@@ -0,0 +1,114 @@
+#include "store/group_seq/group_seq.hpp"
+#include "indexing/indexing.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Indexing;
+
+auto insert(OLFIT &olfit, int tid, const std::string &k, const std::string &v) -> Enums::OpStatus {
+    auto hk_buf = std::make_unique<byte_t[]>(KVPair::HillString::object_size_of(k.size()));
+    auto hv_buf = std::make_unique<byte_t[]>(KVPair::HillString::object_size_of(v.size()));
+    auto &hk = KVPair::HillString::make_string(hk_buf.get(), k.c_str(), k.size());
+    auto &hv = KVPair::HillString::make_string(hv_buf.get(), v.c_str(), v.size());
+    return olfit.insert(tid, k.c_str(), k.size(), v.c_str(), v.size(), &hk, &hv).first;
+}
+
+int main() {
+    auto alloc = Memory::Allocator::make_allocator(new byte_t[1024 * 1024 * 1024], 1024 * 1024 * 1024);
+    auto logger = WAL::Logger::make_unique_logger(new byte_t[1024 * 1024 * 128]);
+    auto tid = alloc->register_thread().value();
+    assert(logger->register_thread().value() == tid);
+
+    // searches are dropped while a group is open or once it is published during them
+    {
+        Store::GroupSeq seq;
+        auto search = [] { return std::optional<int>(1); };
+        assert(seq.read(search).value() == 1);
+        seq.open();
+        assert(!seq.read(search).has_value());
+        seq.close();
+        assert(seq.read(search).value() == 1);
+        assert(!seq.read([&] { seq.open(); seq.close(); return std::optional<int>(1); }).has_value());
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * The backend updates every key in each WAL group and publishes the group after it ends, as
+     * the store does. Searches in place racing it never return a value of a group that is not
+     * published, nor one older than the last group published before they start
+     */
+    {
+        auto index = std::make_unique<OLFIT>(tid, alloc, logger.get());
+        Store::GroupSeq seq;
+        std::atomic_uint64_t published = 0;
+        auto version_of = [](uint64_t r) {
+            auto s = std::to_string(r);
+            return std::string(17 - s.size(), '0') + s;
+        };
+        std::vector<std::string> keys;
+        for (int i = 0; i < 64; i++) {
+            keys.push_back("group" + std::to_string(i));
+            assert(insert(*index, tid, keys.back(), version_of(0)) == Enums::OpStatus::Ok);
+        }
+
+        std::atomic_bool done = false;
+        std::atomic_uint64_t trusted = 0;
+        std::vector<std::thread> frontends;
+        for (int f = 0; f < 3; f++) {
+            frontends.emplace_back([&] {
+                std::vector<byte_t> buf;
+                while (!done.load()) {
+                    for (const auto &key : keys) {
+                        auto before = published.load();
+                        auto found = seq.read([&] {
+                            return index->optimistic_search(key.c_str(), key.size());
+                        });
+                        // asked to the backend in the store
+                        if (!found.has_value()) {
+                            continue;
+                        }
+                        auto [v, v_sz] = found.value();
+                        assert(v != nullptr);
+                        buf.resize(v_sz);
+                        memcpy(buf.data(), v.local_ptr(), v_sz);
+                        if (!KVPair::ValueStamp::validate(buf.data(), v_sz, key.c_str(), key.size())) {
+                            continue;
+                        }
+                        auto version = std::stoull(reinterpret_cast<KVPair::HillString *>(buf.data())->to_string());
+                        assert(version >= before);
+                        assert(version <= published.load());
+                        ++trusted;
+                    }
+                }
+            });
+        }
+
+        for (uint64_t r = 1; r <= 1000; r++) {
+            seq.open();
+            logger->begin_group(tid);
+            for (const auto &key : keys) {
+                auto value = version_of(r);
+                assert(index->update(tid, key.c_str(), key.size(), value.c_str(), value.size()).first == Enums::OpStatus::Ok);
+            }
+            // leaves split under the frontends as well
+            assert(insert(*index, tid, "fresh" + std::to_string(r), version_of(r)) == Enums::OpStatus::Ok);
+            logger->end_group(tid);
+            published = r;
+            seq.close();
+        }
+        // what is published last is found in place
+        while (trusted.load() == 0);
+        done = true;
+        for (auto &t : frontends) {
+            t.join();
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
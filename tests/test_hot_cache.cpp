@@ -0,0 +1,97 @@
+#include "store/hot_cache/hot_cache.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+
+// the cache does not look into values, a value here is just a counter
+static auto search(HotCache &cache, const std::string &key, uint64_t &out) -> bool {
+    byte_t buf[Constants::uHOT_VALUE_SIZE];
+    Memory::PolymorphicPointer ptr;
+    auto size = cache.get(key.c_str(), key.size(), buf, ptr);
+    if (size == 0) {
+        return false;
+    }
+    assert(size == sizeof(uint64_t));
+    memcpy(&out, buf, sizeof(out));
+    return true;
+}
+
+static auto admit(HotCache &cache, const std::string &key, uint64_t ticket, uint64_t value) -> bool {
+    return cache.admit(ticket, key.c_str(), key.size(), nullptr, reinterpret_cast<const_byte_ptr_t>(&value),
+                       sizeof(value));
+}
+
+int main() {
+    auto cache = HotCache::make_hot_cache();
+    const std::string key = "hot";
+    uint64_t out;
+
+    // a key searched once is not admitted
+    assert(!search(*cache, key, out));
+    assert(!cache->ticket(key.c_str(), key.size()).has_value());
+
+    assert(!search(*cache, key, out));
+    auto ticket = cache->ticket(key.c_str(), key.size());
+    assert(ticket.has_value());
+    assert(admit(*cache, key, ticket.value(), 1));
+    assert(search(*cache, key, out) && out == 1);
+
+    // an invalidation after the ticket fails the admission
+    cache->invalidate(key.c_str(), key.size());
+    assert(!search(*cache, key, out));
+    ticket = cache->ticket(key.c_str(), key.size());
+    assert(ticket.has_value());
+    cache->invalidate(key.c_str(), key.size());
+    assert(!admit(*cache, key, ticket.value(), 2));
+    assert(!search(*cache, key, out));
+    std::cout << "Succeded\n";
+
+    /*
+     * The writer changes the value then invalidates the key, readers admit what they read. A
+     * search never returns a value older than the one current before it starts
+     */
+    std::atomic_uint64_t current = 0;
+    std::atomic_bool run = true;
+    std::atomic_uint64_t hits = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            uint64_t value;
+            while (run.load()) {
+                auto before = current.load();
+                if (search(*cache, key, value)) {
+                    assert(value >= before);
+                    ++hits;
+                    continue;
+                }
+
+                auto t = cache->ticket(key.c_str(), key.size());
+                auto found = current.load();
+                if (t.has_value()) {
+                    admit(*cache, key, t.value(), found);
+                }
+            }
+        });
+    }
+
+    for (uint64_t i = 1; i <= 1000000; i++) {
+        current.store(i);
+        cache->invalidate(key.c_str(), key.size());
+    }
+    run = false;
+    for (auto &t : readers) {
+        t.join();
+    }
+    std::cout << ">> " << hits.load() << " hits while racing with 1000000 invalidations\n";
+    std::cout << "Succeded\n";
+    return 0;
+}
@@ -2,8 +2,10 @@
 #include "workload/workload.hpp"
 #include "cmd_parser/cmd_parser.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <thread>
 using namespace Hill;
 using namespace Hill::Indexing;
 using namespace CmdParser;
@@ -36,6 +38,16 @@ auto register_thread(Memory::Allocator *alloc, UniqueLogger &logger) -> std::opt
     return atid;
 }
 
+auto insert(OLFIT &olfit, int tid, const std::string &k, const std::string &v)
+    -> std::pair<Enums::OpStatus, Memory::PolymorphicPointer>
+{
+    auto hk_buf = std::make_unique<byte_t[]>(KVPair::HillString::object_size_of(k.size()));
+    auto hv_buf = std::make_unique<byte_t[]>(KVPair::HillString::object_size_of(v.size()));
+    auto &hk = KVPair::HillString::make_string(hk_buf.get(), k.c_str(), k.size());
+    auto &hv = KVPair::HillString::make_string(hv_buf.get(), v.c_str(), v.size());
+    return olfit.insert(tid, k.c_str(), k.size(), v.c_str(), v.size(), &hk, &hv);
+}
+
 auto main(int argc, char *argv[]) -> int {
     Parser parser;
     parser.add_option<size_t>("--size", "-s", 100000);
@@ -61,14 +73,105 @@ auto main(int argc, char *argv[]) -> int {
     auto batch = 5000000;
     for (int i = 0; i < batch; i++) {
         auto key = std::to_string(begin - i);
-        olfit->insert(tid, key.c_str(), key.size(), key.c_str(), 17);
+        insert(*olfit, tid, key, key + std::string(17 - key.size(), '0'));
     }
 
     std::cout << "Leaf size " << sizeof(Indexing::LeafNode) << "\n";
+#ifndef __HILL_LOG_ALLOCATOR__
+    // objects a page can not hold fail instead of throwing in the allocator
+    {
+        const std::string huge(Memory::Allocator::max_allocation(), 'x');
+        const auto key = std::to_string(begin);
+        assert(insert(*olfit, tid, huge, "v").first == Enums::OpStatus::Failed);
+        assert(insert(*olfit, tid, "huge", huge).first == Enums::OpStatus::Failed);
+        assert(olfit->update(tid, key.c_str(), key.size(), huge.c_str(), huge.size()).first == Enums::OpStatus::Failed);
+        assert(olfit->search(key.c_str(), key.size()).first != nullptr);
+    }
+#endif
+
+    // an insert running out of value log space leaves the leaf as it was, it is retried later
+    {
+        auto index = std::make_unique<OLFIT>(tid, alloc, logger.get());
+        auto vlog = ValueLog::ValueLog::make_value_log(new byte_t[sizeof(ValueLog::Directory)], alloc);
+        // one leaf that is not full, k3 shifts all of the keys
+        std::vector<std::string> keys;
+        for (int i = 0; i < Constants::iNUM_HIGHKEY - 1; i++) {
+            keys.push_back(std::string("k") + char('4' + i));
+            assert(insert(*index, tid, keys.back(), "v" + keys.back()).first == Enums::OpStatus::Ok);
+        }
+        index->enable_value_log(vlog.get());
+        const std::string unfit(ValueLog::Constants::uSEGMENT_SIZE, 'x');
+        assert(insert(*index, tid, "k3", unfit).first == Enums::OpStatus::NoMemory);
+        assert(index->search("k3", 2).first == nullptr);
+        for (const auto &key : keys) {
+            auto [v, _] = index->search(key.c_str(), key.size());
+            assert(v != nullptr);
+            assert(v.get_as<KVPair::HillString *>()->to_string() == "v" + key);
+        }
+    }
+
+    // optimistic readers racing the owner see a stamped value of every key, never an older one than before
+    {
+        auto index = std::make_unique<OLFIT>(tid, alloc, logger.get());
+        auto version_of = [](uint64_t r) {
+            auto s = std::to_string(r);
+            return std::string(17 - s.size(), '0') + s;
+        };
+        std::vector<std::string> keys;
+        for (int i = 0; i < 64; i++) {
+            keys.push_back("race" + std::to_string(i));
+            assert(insert(*index, tid, keys.back(), version_of(0)).first == Enums::OpStatus::Ok);
+        }
+
+        std::atomic_bool done = false;
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; r++) {
+            readers.emplace_back([&] {
+                std::vector<uint64_t> seen(keys.size(), 0);
+                std::vector<byte_t> buf;
+                while (!done.load()) {
+                    for (size_t i = 0; i < keys.size(); i++) {
+                        const auto &key = keys[i];
+                        auto found = index->optimistic_search(key.c_str(), key.size());
+                        if (!found.has_value()) {
+                            continue;
+                        }
+                        auto [v, v_sz] = found.value();
+                        assert(v != nullptr);
+                        // an updated value may be freed and reused, only a validated copy is read
+                        buf.resize(v_sz);
+                        memcpy(buf.data(), v.local_ptr(), v_sz);
+                        if (!KVPair::ValueStamp::validate(buf.data(), v_sz, key.c_str(), key.size())) {
+                            continue;
+                        }
+                        auto version = std::stoull(reinterpret_cast<KVPair::HillString *>(buf.data())->to_string());
+                        assert(version >= seen[i]);
+                        seen[i] = version;
+                    }
+                }
+            });
+        }
+
+        // the owner splits leaves under the readers while updating
+        for (uint64_t r = 1; r <= 200; r++) {
+            for (const auto &key : keys) {
+                auto value = version_of(r);
+                assert(index->update(tid, key.c_str(), key.size(), value.c_str(), value.size()).first == Enums::OpStatus::Ok);
+            }
+            auto fresh = "fresh" + std::to_string(r);
+            assert(insert(*index, tid, fresh, version_of(r)).first == Enums::OpStatus::Ok);
+        }
+        done = true;
+        for (auto &t : readers) {
+            t.join();
+        }
+    }
+
     for (int i = 0; i < batch; i++) {
         auto key = std::to_string(begin - i);
+        auto value = key + std::string(17 - key.size(), '1');
         // std::cout << "updating " << key << "\n";
-        if (auto [sta, _] = olfit->update(tid, key.c_str(), key.size(), key.c_str(), 17);
+        if (auto [sta, _] = olfit->update(tid, key.c_str(), key.size(), value.c_str(), value.size());
             sta != Enums::OpStatus::Ok) {
             std::cout << "updating " << key << " failed\n";
             return -1;
@@ -0,0 +1,110 @@
+#include "store/inflight/inflight.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill::Store;
+
+struct Message {
+    int request;
+    int backend;
+};
+
+int main() {
+    // a frontend with every message in flight polls until a completion frees one
+    {
+        Inflight<Message, 4> inflight;
+        std::vector<Message *> taken;
+        for (int i = 0; i < 4; i++) {
+            taken.push_back(inflight.acquire([] { assert(false); }));
+        }
+        assert(inflight.in_flight() == 4);
+
+        int polls = 0;
+        auto msg = inflight.acquire([&] {
+            if (++polls == 3) {
+                inflight.complete(taken[1]);
+            }
+            inflight.drain([&](Message *m) { inflight.release(m); });
+        });
+        assert(polls == 3 && msg == taken[1]);
+        assert(inflight.in_flight() == 4);
+
+        // completions are responded in the order they come
+        inflight.complete(taken[3]);
+        inflight.complete(taken[0]);
+        std::vector<Message *> responded;
+        assert(inflight.drain([&](Message *m) { responded.push_back(m); }) == 2);
+        assert((responded == std::vector<Message *>{taken[3], taken[0]}));
+        assert(inflight.drain([](Message *) { assert(false); }) == 0);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Backends complete what the frontend hands them while the frontend keeps taking messages,
+     * every request is responded exactly once and never more than N are in flight
+     */
+    {
+        constexpr int backends = 3;
+        constexpr int requests = 10000;
+        Inflight<Message, 8> inflight;
+        std::vector<std::atomic<Message *>> handed(backends);
+        for (auto &h : handed) {
+            h = nullptr;
+        }
+        std::atomic_bool done = false;
+        std::vector<std::thread> threads;
+        for (int b = 0; b < backends; b++) {
+            threads.emplace_back([&, b] {
+                while (!done.load()) {
+                    if (auto m = handed[b].exchange(nullptr); m != nullptr) {
+                        assert(m->backend == b);
+                        inflight.complete(m);
+                        continue;
+                    }
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        std::vector<int> responses(requests, 0);
+        int responded = 0;
+        auto poll = [&] {
+            responded += inflight.drain([&](Message *m) {
+                ++responses[m->request];
+                inflight.release(m);
+            });
+        };
+        for (int r = 0; r < requests; r++) {
+            auto m = inflight.acquire(poll);
+            assert(inflight.in_flight() <= 8);
+            m->request = r;
+            m->backend = r % backends;
+            // the handler returns as soon as the message is handed over
+            Message *expected = nullptr;
+            while (!handed[m->backend].compare_exchange_weak(expected, m)) {
+                expected = nullptr;
+                poll();
+                std::this_thread::yield();
+            }
+        }
+        while (responded != requests) {
+            poll();
+        }
+        done = true;
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        assert(inflight.in_flight() == 0);
+        for (auto r : responses) {
+            assert(r == 1);
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "store/inlining/inlining.hpp"
+#include "store/hot_cache/hot_cache.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+using namespace Hill::Memory::TypeAliases;
+
+// a stamped value of key whose stamped size is exactly size bytes, false if there is none
+static auto stamped(const std::string &key, size_t size, std::vector<byte_t> &buf) -> bool {
+    size_t v_sz = 0;
+    while (KVPair::ValueStamp::stamped_size_of(v_sz + 1) <= size) {
+        ++v_sz;
+    }
+    if (KVPair::ValueStamp::stamped_size_of(v_sz) != size) {
+        return false;
+    }
+    buf.assign(size, 0);
+    std::string value(v_sz, 'v');
+    auto &h = KVPair::HillString::make_string(buf.data(), value.c_str(), value.size());
+    KVPair::ValueStamp::stamp(&h, 1, key.c_str(), key.size());
+    return true;
+}
+
+int main() {
+    byte_t out[Constants::uHOT_VALUE_SIZE];
+    std::vector<byte_t> value;
+    const std::string key = "key";
+
+    // values up to uINLINE_VALUE_SIZE are inlined, a byte more is read by the client
+    {
+        constexpr auto limit = Constants::uINLINE_VALUE_SIZE;
+        for (auto size : {KVPair::ValueStamp::stamped_size_of(0), limit - 1, limit}) {
+            assert(stamped(key, size, value));
+            assert(Inlining::copy(out, value.data(), size, limit, key.c_str(), key.size()) == size);
+            assert(memcmp(out, value.data(), size) == 0);
+            assert(Inlining::usable(out, size, key));
+        }
+
+        assert(stamped(key, limit + 1, value));
+        assert(Inlining::copy(out, value.data(), limit + 1, limit, key.c_str(), key.size()) == 0);
+        // hot values are inlined up to the hot limit
+        assert(Inlining::copy(out, value.data(), limit + 1, Constants::uHOT_VALUE_SIZE, key.c_str(), key.size()) == limit + 1);
+        assert(stamped(key, Constants::uHOT_VALUE_SIZE, value));
+        assert(Inlining::copy(out, value.data(), value.size(), Constants::uHOT_VALUE_SIZE, key.c_str(), key.size()) == value.size());
+    }
+    std::cout << "Succeded\n";
+
+    // a value freed or reused meanwhile fails its stamp and is not inlined
+    {
+        assert(stamped(key, 64, value));
+        assert(Inlining::copy(out, nullptr, 64, Constants::uINLINE_VALUE_SIZE, key.c_str(), key.size()) == 0);
+        assert(Inlining::copy(out, value.data(), 64, Constants::uINLINE_VALUE_SIZE, "other", 5) == 0);
+        value[20] ^= 1;
+        assert(Inlining::copy(out, value.data(), 64, Constants::uINLINE_VALUE_SIZE, key.c_str(), key.size()) == 0);
+        assert(!Inlining::usable(value.data(), 64, key));
+        assert(!Inlining::usable(nullptr, 64, key));
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Responses of | header | stamped value | are received whole or cut short, the client only takes
+     * inlined bytes that are all in the response and stamped by its key
+     */
+    {
+        constexpr size_t header = 32;
+        for (size_t size = KVPair::ValueStamp::stamped_size_of(0); size <= Constants::uINLINE_VALUE_SIZE + 8; size++) {
+            // sizes of no value
+            if (!stamped(key, size, value)) {
+                continue;
+            }
+
+            std::vector<byte_t> resp(header, 0);
+            auto inlined_size = Inlining::copy(out, value.data(), size, Constants::uINLINE_VALUE_SIZE,
+                                               key.c_str(), key.size());
+            resp.insert(resp.end(), out, out + inlined_size);
+
+            auto inlined = Inlining::received(resp.data(), resp.size(), resp.data() + header, inlined_size);
+            if (size <= Constants::uINLINE_VALUE_SIZE) {
+                assert(inlined == resp.data() + header && Inlining::usable(inlined, size, key));
+                assert(Inlining::received(resp.data(), resp.size() - 1, resp.data() + header, inlined_size) == nullptr);
+            } else {
+                assert(inlined == nullptr && !Inlining::usable(inlined, size, key));
+            }
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
@@ -1,6 +1,11 @@
 #include "kv_pair/kv_pair.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include <cassert>
 using namespace Hill;
 using namespace Hill::Memory::TypeAliases;
 int main() {
@@ -18,5 +23,91 @@ int main() {
         std::cout << "size mismatched\n";
         return -1;
     }
+
+    // the check value of CRC32C
+    assert(~KVPair::ValueStamp::crc32c(~0U, "123456789", 9) == 0xe3069283U);
+
+    // a stamped value validates only as a whole, for its own key and while it is valid
+    auto vbuf = new byte_t[1024];
+    auto &v = KVPair::HillString::make_string(vbuf, cnt.c_str(), cnt.size());
+    KVPair::ValueStamp::stamp(&v, 7, "key", 3);
+    auto stamped = KVPair::ValueStamp::stamped_size_of(cnt.size());
+    assert(KVPair::ValueStamp::of(&v)->version == 7);
+    assert(KVPair::ValueStamp::validate(vbuf, stamped, "key", 3));
+    assert(KVPair::ValueStamp::validate(vbuf, stamped + 64, "key", 3));
+    assert(!KVPair::ValueStamp::validate(vbuf, stamped - 1, "key", 3));
+    assert(!KVPair::ValueStamp::validate(vbuf, stamped, "kez", 3));
+    vbuf[5] ^= 1;
+    assert(!KVPair::ValueStamp::validate(vbuf, stamped, "key", 3));
+    vbuf[5] ^= 1;
+    KVPair::ValueStamp::of(&v)->version = 8;
+    assert(!KVPair::ValueStamp::validate(vbuf, stamped, "key", 3));
+    KVPair::ValueStamp::of(&v)->version = 7;
+    v.invalidate();
+    assert(!KVPair::ValueStamp::validate(vbuf, stamped, "key", 3));
+    delete[] vbuf;
+
+    // numeric codes follow the byte order of keys, not their numeric values
+    auto codec = KVPair::KeyCodec::make_numeric_codec("user");
+    std::mt19937_64 rng(0);
+    std::vector<std::string> keys = {"user", "user0", "user00", "user1", "user10", "user9", "user9999999999999999999"};
+    for (int i = 0; i < 10000; i++) {
+        keys.push_back("user" + std::to_string((rng() >> 1) >> (rng() % 63)));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto code = codec.encode(keys[i].c_str(), keys[i].size());
+        assert(codec.is_exact(code));
+        assert(codec.decode(code) == keys[i]);
+        if (i != 0) {
+            assert(codec.encode(keys[i - 1].c_str(), keys[i - 1].size()) < code);
+        }
+    }
+
+    // other keys are coded as 0 and compared in full
+    for (auto k : {"use", "userx", "user1x", "user12345678901234567890", "1234"}) {
+        assert(codec.encode(k, strlen(k)) == 0);
+    }
+    auto &hk = KVPair::HillString::make_string(buf, "user12", 6);
+    assert(codec.compare(codec.encode("user12", 6), &hk, 0, "user1x", 6) < 0);
+    assert(codec.compare(codec.encode("user12", 6), &hk, codec.encode("user2", 5), "user2", 5) < 0);
+
+    assert(KVPair::KeyCodec::detect({"user1000", "user1001", "user2"}).get_prefix() == "user");
+    assert(KVPair::KeyCodec::detect({"1000", "1001"}).is_numeric());
+    assert(!KVPair::KeyCodec::detect({"user1000", "userx"}).is_numeric());
+    assert(!KVPair::KeyCodec::detect({"user1000", "user12345678901234567890"}).is_numeric());
+
+    // keys of a loaded range share their leading digits, so prefixes do not help but codes do
+    const size_t num = 1024, rounds = 2000;
+    std::vector<byte_ptr_t> bufs;
+    std::vector<KVPair::HillString *> hkeys;
+    std::vector<uint64_t> prefixes, codes;
+    for (size_t i = 0; i < num; i++) {
+        auto k = "user" + std::to_string(1000000000UL + rng() % 1000000);
+        bufs.push_back(new byte_t[64]);
+        hkeys.push_back(&KVPair::HillString::make_string(bufs.back(), k.c_str(), k.size()));
+        prefixes.push_back(hkeys.back()->prefix());
+        codes.push_back(codec.encode(k.c_str(), k.size()));
+    }
+
+    auto run = [&](const char *name, const KVPair::KeyCodec &c, std::vector<uint64_t> &cs) {
+        size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < num; i++) {
+                auto j = (i + r + 1) % num;
+                hits += c.compare(cs[i], hkeys[i], cs[j], hkeys[j]->raw_chars(), hkeys[j]->size()) < 0;
+            }
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << ">> " << name << ": " << double(ns) / (num * rounds) << " ns/cmp (" << hits << ")\n";
+    };
+    run("prefixed", KVPair::KeyCodec(), prefixes);
+    run("numeric", codec, codes);
+
+    for (auto b : bufs) {
+        delete[] b;
+    }
     return 0;
 }
@@ -0,0 +1,80 @@
+#include "store/range_merger/range_merger.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+using namespace Hill::Indexing;
+using namespace Hill::KVPair;
+
+// each partition of a range query returns keys in order, the merger interleaves them
+static auto make_ranges(std::vector<std::string> &keys, size_t partitions, std::vector<byte_ptr_t> &bufs)
+    -> std::vector<std::vector<ScanHolder>>
+{
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::vector<ScanHolder>> ranges(partitions);
+    Memory::PolymorphicPointer nothing = nullptr;
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto &k = keys[i];
+        bufs.push_back(new byte_t[sizeof(HillStringHeader) + k.size()]);
+        auto hk = &HillString::make_string(bufs.back(), k.c_str(), k.size());
+        ranges[std::hash<std::string>{}(k) % partitions].emplace_back(hk, hk->prefix(), nothing);
+    }
+    return ranges;
+}
+
+static auto check(std::vector<ScanHolder> &merged, std::vector<std::string> &keys, size_t total) -> void {
+    assert(merged.size() == std::min(total, keys.size()));
+    for (size_t i = 0; i < merged.size(); i++) {
+        assert(merged[i].key->to_string() == keys[i]);
+    }
+}
+
+int main() {
+    std::vector<byte_ptr_t> bufs;
+
+    // binary keys sharing their first 8 bytes fall back to full comparison
+    std::vector<std::string> keys = {
+        "user0000", "user00001", std::string("user0000\0a", 10), "user0001", "a", "b", "", "zz",
+    };
+    auto ranges = make_ranges(keys, 3, bufs);
+    auto merged = Merger::make_merger(ranges)->merge(keys.size());
+    check(merged, keys, keys.size());
+
+    // asking for more than available stops at the end of all partitions
+    ranges = make_ranges(keys, 3, bufs);
+    merged = Merger::make_merger(ranges)->merge(keys.size() * 2);
+    check(merged, keys, keys.size() * 2);
+    std::cout << "Succeded\n";
+
+    for (auto [key_size, shared] : std::vector<std::pair<size_t, size_t>>{{8, 0}, {16, 4}, {64, 16}}) {
+        std::mt19937_64 rng(key_size);
+        std::vector<std::string> bench_keys;
+        for (int i = 0; i < 100000; i++) {
+            std::string k(shared, 'k');
+            while (k.size() < key_size) {
+                k.push_back('a' + rng() % 26);
+            }
+            bench_keys.push_back(std::move(k));
+        }
+
+        auto bench_ranges = make_ranges(bench_keys, 16, bufs);
+        auto start = std::chrono::steady_clock::now();
+        auto out = Merger::make_merger(bench_ranges)->merge(bench_keys.size());
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        check(out, bench_keys, bench_keys.size());
+        std::cout << ">> " << key_size << "B keys, 16 partitions: " << bench_keys.size() << " merged in " << us << " us\n";
+    }
+
+    for (auto b : bufs) {
+        delete[] b;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "store/partitioner/partitioner.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+
+static auto partition_of(const Partitioner &p, const std::string &key) -> int {
+    return p.partition_of(key.c_str(), key.size());
+}
+
+int main() {
+    // boundaries are cut at quantiles of the sorted samples, whatever order samples come in
+    {
+        std::vector<std::string> samples;
+        for (char c = 'h'; c >= 'a'; c--) {
+            samples.push_back(std::string(1, c));
+        }
+        auto p = Partitioner::make_range_partitioner(4, samples);
+        assert(p.is_ordered());
+        assert(p.get_num_partitions() == 4);
+        assert((p.get_boundaries() == std::vector<std::string>{"c", "e", "g"}));
+
+        assert(partition_of(p, "") == 0);
+        assert(partition_of(p, "a") == 0);
+        assert(partition_of(p, "bzzz") == 0);
+        // a key equal to a boundary is the first key of the next partition
+        assert(partition_of(p, "c") == 1);
+        assert(partition_of(p, std::string("c\0", 2)) == 1);
+        assert(partition_of(p, "e") == 2);
+        assert(partition_of(p, "g") == 3);
+        assert(partition_of(p, "zzz") == 3);
+
+        // keys are ordered across partitions
+        int prev_partition = 0;
+        for (char c = 'a'; c <= 'z'; c++) {
+            auto key = std::string(1, c);
+            auto partition = partition_of(p, key);
+            assert(partition >= prev_partition);
+            assert(partition < p.get_num_partitions());
+            prev_partition = partition;
+        }
+    }
+    std::cout << "Succeded\n";
+
+    // bytes compare unsigned, so high bytes sort after ASCII as they do in the index
+    {
+        auto p = Partitioner::make_range_partitioner(2, {"a", "b", "\xf0", "\xf1"});
+        assert((p.get_boundaries() == std::vector<std::string>{"\xf0"}));
+        assert(partition_of(p, "z") == 0);
+        assert(partition_of(p, "\xf0") == 1);
+        assert(partition_of(p, "\xff") == 1);
+    }
+    std::cout << "Succeded\n";
+
+    // fewer samples than partitions still give valid, if empty, partitions
+    {
+        auto p = Partitioner::make_range_partitioner(4, {"k"});
+        assert(p.is_ordered());
+        assert(p.get_boundaries().size() == 3);
+        assert(partition_of(p, "a") == 0);
+        assert(partition_of(p, "k") == 3);
+    }
+    std::cout << "Succeded\n";
+
+    // a single partition or no samples fall back to hashing
+    {
+        auto single = Partitioner::make_range_partitioner(1, {"a", "b"});
+        assert(!single.is_ordered());
+        assert(single.get_boundaries().empty());
+        assert(partition_of(single, "a") == 0 && partition_of(single, "zzz") == 0);
+
+        auto unsampled = Partitioner::make_range_partitioner(8, {});
+        assert(!unsampled.is_ordered());
+        assert(unsampled.get_num_partitions() == 8);
+        auto hashed = Partitioner::make_hash_partitioner(8);
+        std::vector<bool> used(8, false);
+        for (int i = 0; i < 1000; i++) {
+            auto key = "key" + std::to_string(i);
+            auto partition = partition_of(unsampled, key);
+            assert(partition >= 0 && partition < 8);
+            assert(partition == partition_of(hashed, key));
+            used[partition] = true;
+        }
+        for (auto u : used) {
+            assert(u);
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "store/range_page/range_page.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+using namespace Hill::KVPair::TypeAliases;
+
+using namespace std::string_literals;
+
+// | hill_key_t | uint64_t value |, the value stands for the pointer and size of a response
+constexpr size_t trailer_size = sizeof(uint64_t);
+
+// a server answering a range from start with keys of store not smaller than it
+static auto serve(const std::map<std::string, uint64_t> &store, const std::string &start, size_t count,
+                  size_t limit, std::vector<uint8_t> &page) -> void
+{
+    std::vector<std::pair<std::string, uint64_t>> holders;
+    for (auto it = store.lower_bound(start); it != store.end() && holders.size() < count; ++it) {
+        holders.push_back(*it);
+    }
+
+    size_t used = RangePage::uHEADER_SIZE;
+    auto num = RangePage::fit(holders.size(), limit, used, [&](size_t i) {
+        return KVPair::HillString::object_size_of(holders[i].first.size()) + trailer_size;
+    });
+    assert(used <= limit);
+    page.assign(used, 0);
+
+    auto buf = RangePage::write_header(page.data(), num, num < holders.size());
+    for (size_t i = 0; i < num; i++) {
+        KVPair::HillString::make_string(buf, holders[i].first.data(), holders[i].first.size());
+        buf += reinterpret_cast<hill_key_t *>(buf)->object_size();
+        *reinterpret_cast<uint64_t *>(buf) = holders[i].second;
+        buf += trailer_size;
+    }
+    assert(buf == page.data() + page.size());
+}
+
+// a client asking for count keys from start page by page, returns every key it got in order
+static auto scan(const std::map<std::string, uint64_t> &store, const std::string &start, size_t count,
+                 size_t limit, size_t &pages) -> std::vector<std::pair<std::string, uint64_t>>
+{
+    std::vector<std::pair<std::string, uint64_t>> ret;
+    std::vector<uint8_t> page;
+    std::string cursor = start;
+    size_t remaining = count;
+    for (pages = 1; ; pages++) {
+        serve(store, cursor, remaining, limit, page);
+        bool more;
+        size_t num = 0;
+        auto last = RangePage::read(page.data(), trailer_size, more, [&](const hill_key_t *key, const uint8_t *trailer) {
+            ret.emplace_back(key->to_string(), *reinterpret_cast<const uint64_t *>(trailer));
+            ++num;
+        });
+        if (!RangePage::advance(remaining, num, more)) {
+            break;
+        }
+        RangePage::next_key(last, cursor);
+        assert(pages < store.size() + 1);
+    }
+    return ret;
+}
+
+int main() {
+    // the continuation key is the smallest one after the last, keys extending it by a NUL are not skipped
+    {
+        std::string cursor;
+        std::vector<uint8_t> buf(KVPair::HillString::object_size_of(3));
+        KVPair::HillString::make_string(buf.data(), "key", 3);
+        RangePage::next_key(reinterpret_cast<hill_key_t *>(buf.data()), cursor);
+        assert(cursor == "key\0"s);
+
+        std::map<std::string, uint64_t> store = {{"key", 0}, {"key\0"s, 1}, {"key\0\0"s, 2}, {"key\x01", 3}, {"kez", 4}};
+        assert(store.lower_bound(cursor)->second == 1);
+        assert(std::prev(store.lower_bound(cursor))->first == "key");
+    }
+    std::cout << "Succeded\n";
+
+    // a page stops before its limit, more is set only when keys are left out
+    {
+        std::map<std::string, uint64_t> store;
+        for (uint64_t i = 0; i < 10; i++) {
+            store.emplace("key" + std::to_string(i), i);
+        }
+        auto entry = KVPair::HillString::object_size_of(4) + trailer_size;
+        std::vector<uint8_t> page;
+        serve(store, "", 10, RangePage::uHEADER_SIZE + 3 * entry + entry - 1, page);
+        bool more;
+        std::vector<uint64_t> values;
+        auto last = RangePage::read(page.data(), trailer_size, more, [&](const hill_key_t *, const uint8_t *trailer) {
+            values.push_back(*reinterpret_cast<const uint64_t *>(trailer));
+        });
+        assert(more && (values == std::vector<uint64_t>{0, 1, 2}) && last->to_string() == "key2");
+
+        size_t remaining = 10;
+        assert(RangePage::advance(remaining, values.size(), more) && remaining == 7);
+
+        serve(store, "key7", 3, RangePage::uHEADER_SIZE + 3 * entry, page);
+        values.clear();
+        RangePage::read(page.data(), trailer_size, more, [&](const hill_key_t *, const uint8_t *trailer) {
+            values.push_back(*reinterpret_cast<const uint64_t *>(trailer));
+        });
+        assert(!more && (values == std::vector<uint64_t>{7, 8, 9}));
+
+        // an empty page ends the range, a key larger than a page would be asked for forever
+        serve(store, "", 10, RangePage::uHEADER_SIZE + entry - 1, page);
+        assert(RangePage::read(page.data(), trailer_size, more, [](const hill_key_t *, const uint8_t *) { assert(false); }) == nullptr);
+        assert(more);
+        assert(!RangePage::advance(remaining, 0, more));
+        // enough keys are collected
+        remaining = 3;
+        assert(!RangePage::advance(remaining, 3, true) && remaining == 0);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Ranges over keys of different sizes, some being prefixes of others or extended by NUL bytes,
+     * are read page by page. Every key from the start is returned exactly once and in order,
+     * until the wanted number of keys is collected
+     */
+    {
+        std::map<std::string, uint64_t> store;
+        uint64_t value = 0;
+        for (int i = 0; i < 200; i++) {
+            auto key = "k" + std::to_string(i * 7919 % 1000);
+            store.emplace(key, value++);
+            if (i % 3 == 0) {
+                store.emplace(key + '\0', value++);
+                store.emplace(key + "\0\0"s, value++);
+            }
+            if (i % 5 == 0) {
+                store.emplace(key + std::string(i % 40, 'x'), value++);
+            }
+        }
+
+        std::vector<std::string> starts = {"", "k1", "k5\0"s, "k999", "l"};
+        for (const auto &start : starts) {
+            for (size_t count : {1UL, 7UL, 100UL, store.size() + 10}) {
+                for (size_t limit : {64UL, 200UL, 4096UL}) {
+                    std::vector<std::pair<std::string, uint64_t>> expected;
+                    for (auto it = store.lower_bound(start); it != store.end() && expected.size() < count; ++it) {
+                        expected.push_back(*it);
+                    }
+
+                    size_t pages;
+                    auto got = scan(store, start, count, limit, pages);
+                    assert(got == expected);
+                    if (limit == 64 && expected.size() > 1) {
+                        assert(pages > 1);
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
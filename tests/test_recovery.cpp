@@ -0,0 +1,415 @@
+#include "indexing/indexing.hpp"
+#include "crash_test/crash_test.hpp"
+#include "cmd_parser/cmd_parser.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Crash-point injection and recovery benchmark
+ *
+ * A DRAM-backed fake PM file is shared by a workload process and a recovery process. For each
+ * crash point n, a workload process runs OLFIT inserts and updates and dies at the n-th crash
+ * point. A recovery process then recovers the allocator and the WAL on the same mapping, checks
+ * invariants and reports recovery latency. Both are children so that a crashing recovery is a
+ * finding instead of the end of the test.
+ *
+ * Stores never flushed survive in the fake PM, so this checks what recovery makes of every
+ * intermediate state, not what happens when cache lines are lost.
+ *
+ * The workload runs once with every operation durable on its own, then once more in WAL groups,
+ * where crashes in the middle of a group lose its operations but must not leave the index
+ * pointing to reclaimed memory.
+ *
+ * Requires __HILL_CRASH_TEST__ in config.hpp, and runs against the page allocator or the log
+ * allocator, whichever config.hpp selects
+ */
+using namespace Hill;
+using namespace Hill::Indexing;
+using namespace CmdParser;
+
+#ifdef __HILL_CRASH_TEST__
+namespace {
+    constexpr uint64_t uROOT_MAGIC = 0xc4a54c4a54c4a5UL;
+    constexpr size_t uROOT_SIZE = Memory::Constants::uPAGE_SIZE;
+
+    enum Violation {
+        RecoveryCrashed,
+        AllocatorLost,
+        BrokenLists,
+        DanglingPointer,
+        LostInsert,
+        LostUpdate,
+        ReusedMemory,
+        ViolationNum,
+    };
+
+    const char *violation_names[] = {
+        "recovery crashed",
+        "allocator lost",
+        "broken page lists",
+        "dangling pointer",
+        "lost insert",
+        "lost update",
+        "reused live memory",
+    };
+
+    // the first page of the fake PM, written by both processes
+    struct Root {
+        uint64_t magic;
+        LeafNode *first_leaf;
+        uint64_t acked_inserts;
+        uint64_t acked_updates;
+        uint64_t points;
+        uint64_t alloc_us;
+        uint64_t wal_us;
+        uint64_t violations[ViolationNum];
+        char crashed_at[64];
+    };
+
+    struct FakePM {
+        byte_ptr_t base;
+        size_t size;
+        Root *root;
+        byte_ptr_t wal;
+        byte_ptr_t heap;
+        size_t heap_size;
+
+        static auto make_fake_pm(const std::string &path, size_t heap_size) -> std::optional<FakePM> {
+            FakePM ret;
+            auto wal_size = (sizeof(WAL::LogRegions) + Memory::Constants::uPAGE_SIZE - 1) & Memory::Constants::uPAGE_MASK;
+            ret.size = uROOT_SIZE + wal_size + heap_size;
+            auto fd = open(path.c_str(), O_CREAT | O_RDWR, 0666);
+            if (fd == -1 || ftruncate(fd, ret.size) != 0) {
+                return {};
+            }
+            auto mapped = mmap(nullptr, ret.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mapped == MAP_FAILED) {
+                return {};
+            }
+
+            ret.base = reinterpret_cast<byte_ptr_t>(mapped);
+            ret.root = reinterpret_cast<Root *>(ret.base);
+            ret.wal = ret.base + uROOT_SIZE;
+            ret.heap = ret.wal + wal_size;
+            ret.heap_size = heap_size;
+            return ret;
+        }
+    };
+
+    Root *crash_root = nullptr;
+    auto leave_note(const char *point) -> void {
+        strncpy(crash_root->crashed_at, point, sizeof(crash_root->crashed_at) - 1);
+    }
+
+    auto key_of(size_t i) -> std::string {
+        return "key" + std::to_string(1000000000UL + i);
+    }
+
+    auto value_of(size_t i, bool updated) -> std::string {
+        return (updated ? "updated-" : "inserted") + std::to_string(1000000000UL + i);
+    }
+
+    /*
+     * exits at the armed crash point, or with 0 once the workload is done. With group, every group
+     * operations are a WAL group and only acknowledged once it ends
+     */
+    auto run_workload(FakePM &pm, size_t num, size_t group, uint64_t crash_at) -> void {
+        memset(pm.root, 0, sizeof(Root));
+        crash_root = pm.root;
+        CrashTest::arm(crash_at, leave_note);
+
+        auto alloc = Memory::Allocator::make_allocator(pm.heap, pm.heap_size);
+        auto logger = WAL::Logger::make_unique_logger(pm.wal);
+        auto tid = alloc->register_thread().value();
+        logger->register_thread();
+
+        OLFIT olfit(tid, alloc, logger.get());
+        pm.root->first_leaf = olfit.get_root().get_as<LeafNode *>();
+        pm.root->magic = uROOT_MAGIC;
+
+        // acked is set to done when an operation is durable, at once or at the end of its group
+        auto run = [&](uint64_t &acked, auto &&op) {
+            for (size_t i = 0; i < num; i++) {
+                if (group != 0 && i % group == 0) {
+                    logger->begin_group(tid);
+                }
+                op(i);
+                if (group == 0) {
+                    acked = i + 1;
+                } else if ((i + 1) % group == 0 || i + 1 == num) {
+                    logger->end_group(tid);
+                    acked = i + 1;
+                }
+            }
+        };
+
+        byte_t kbuf[64], vbuf[64];
+        run(pm.root->acked_inserts, [&](size_t i) {
+            auto k = key_of(i), v = value_of(i, false);
+            auto &hk = KVPair::HillString::make_string(kbuf, k.c_str(), k.size());
+            auto &hv = KVPair::HillString::make_string(vbuf, v.c_str(), v.size());
+            olfit.insert(tid, k.c_str(), k.size(), v.c_str(), v.size(), &hk, &hv);
+        });
+
+        run(pm.root->acked_updates, [&](size_t i) {
+            auto k = key_of(i), v = value_of(i, true);
+            olfit.update(tid, k.c_str(), k.size(), v.c_str(), v.size());
+        });
+
+        pm.root->points = CrashTest::get_passed();
+        _exit(0);
+    }
+
+#ifndef __HILL_LOG_ALLOCATOR__
+    // a chunk is live if its page is not free and one of the page's records still starts at it
+    auto is_live(const byte_ptr_t ptr, const std::unordered_set<const Memory::Page *> &free_pages) -> bool {
+        auto page = Memory::Page::get_page(ptr);
+        if (free_pages.count(page) != 0) {
+            return false;
+        }
+
+        auto headers = page->get_headers();
+        auto offset = ptr - reinterpret_cast<byte_ptr_t>(page);
+        for (size_t i = 0; i < page->header.records; i++) {
+            if (headers[i].offset == offset) {
+                return true;
+            }
+        }
+        return false;
+    }
+#endif
+
+    auto run_recovery(FakePM &pm, size_t num) -> void {
+        auto &v = pm.root->violations;
+        auto start = std::chrono::steady_clock::now();
+        auto alloc = Memory::Allocator::recover_or_makie_allocator(pm.heap, pm.heap_size);
+        auto mid = std::chrono::steady_clock::now();
+        auto logger = WAL::Logger::recover_unique_logger(pm.wal, [](WAL::LogEntry &) { return true; });
+        auto end = std::chrono::steady_clock::now();
+        pm.root->alloc_us = std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+        pm.root->wal_us = std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+
+        if (alloc == nullptr) {
+            ++v[AllocatorLost];
+            _exit(0);
+        }
+
+#ifdef __HILL_LOG_ALLOCATOR__
+        // whatever the log handed out stays live, the rest is handed out again
+        auto is_live = [&](const byte_ptr_t ptr) {
+            return alloc->is_allocated(ptr);
+        };
+#else
+        auto free_pages = alloc->collect_free_pages();
+        if (!free_pages.has_value()) {
+            ++v[BrokenLists];
+            _exit(0);
+        }
+        auto is_live = [&](const byte_ptr_t ptr) {
+            return ::is_live(ptr, free_pages.value());
+        };
+#endif
+
+        // crashed before the tree was made
+        if (pm.root->magic != uROOT_MAGIC) {
+            _exit(0);
+        }
+
+        // chunks reachable from leaves, they must be live and never handed out again
+        std::vector<std::pair<byte_ptr_t, size_t>> referenced;
+        std::unordered_map<std::string, std::string> found;
+        std::unordered_set<LeafNode *> visited;
+        for (auto leaf = pm.root->first_leaf; leaf != nullptr; leaf = leaf->next) {
+            if (!visited.insert(leaf).second) {
+                ++v[BrokenLists];
+                break;
+            }
+
+            auto leaf_ptr = reinterpret_cast<byte_ptr_t>(leaf);
+            if (!is_live(leaf_ptr)) {
+                ++v[DanglingPointer];
+                break;
+            }
+            referenced.emplace_back(leaf_ptr, sizeof(LeafNode));
+
+            for (int i = 0; i < Constants::iNUM_HIGHKEY && leaf->keys[i] != nullptr; i++) {
+                auto key = reinterpret_cast<byte_ptr_t>(leaf->keys[i]);
+                auto value = leaf->values[i].get_as<byte_ptr_t>();
+                // an unfinished insert at the end of a leaf, the key is linked but its value is not yet
+                if (value == nullptr) {
+                    continue;
+                }
+
+                if (!is_live(key) || !is_live(value)) {
+                    ++v[DanglingPointer];
+                    continue;
+                }
+                referenced.emplace_back(key, leaf->keys[i]->object_size());
+                auto v_sz = leaf->values[i].get_as<KVPair::HillString *>()->size();
+                referenced.emplace_back(value, KVPair::ValueStamp::stamped_size_of(v_sz));
+                found[leaf->keys[i]->to_string()] = leaf->values[i].get_as<KVPair::HillString *>()->to_string();
+            }
+        }
+
+        for (size_t i = 0; i < std::min<size_t>(num, pm.root->acked_inserts); i++) {
+            auto it = found.find(key_of(i));
+            if (it == found.end()) {
+                ++v[LostInsert];
+            } else if (i < pm.root->acked_updates && it->second != value_of(i, true)) {
+                ++v[LostUpdate];
+            }
+        }
+
+        // recovered memory is handed out again, it must not overlap anything reachable
+        std::sort(referenced.begin(), referenced.end());
+        auto tid = alloc->register_thread().value();
+        for (int i = 0; i < 1024; i++) {
+            byte_ptr_t ptr;
+            alloc->allocate(tid, 64, ptr);
+            auto it = std::upper_bound(referenced.begin(), referenced.end(), std::make_pair(ptr + 64, size_t(0)));
+            if (it != referenced.begin() && std::prev(it)->first + std::prev(it)->second > ptr) {
+                ++v[ReusedMemory];
+            }
+        }
+        _exit(0);
+    }
+
+    template<typename F>
+    auto in_child(F &&f) -> int {
+        auto pid = fork();
+        if (pid == 0) {
+            f();
+            _exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (WIFEXITED(status)) {
+            return WEXITSTATUS(status);
+        }
+        return -1;
+    }
+
+    // kills the workload at crash points in turn and recovers, returns the violations found or nothing if the harness fails
+    auto sweep(FakePM &pm, size_t num, size_t group, size_t exhaustive, size_t crashes) -> std::optional<uint64_t> {
+        // a dry run counts crash points
+        if (in_child([&] { run_workload(pm, num, group, CrashTest::Constants::uDISARMED); }) != 0) {
+            std::cout << ">> Workload failed without crashing\n";
+            return {};
+        }
+        auto points = pm.root->points;
+        auto stride = points > exhaustive ? std::max<size_t>(1, (points - exhaustive) / crashes) : 1;
+        std::cout << ">> " << points << " crash points in " << num << " inserts and updates";
+        if (group != 0) {
+            std::cout << " in groups of " << group;
+        }
+        std::cout << ", every one of the first "
+                  << exhaustive << " and one in " << stride << " afterwards is tested\n";
+
+        uint64_t totals[ViolationNum] = {};
+        std::vector<uint64_t> alloc_us, wal_us;
+        size_t runs = 0;
+        for (uint64_t n = 1; n <= points; n += (n < exhaustive ? 1 : stride)) {
+            auto code = in_child([&] { run_workload(pm, num, group, n); });
+            if (code != CrashTest::Constants::iCRASH_EXIT_CODE) {
+                std::cout << ">> Workload did not crash at point " << n << " (exit " << code << ")\n";
+                return {};
+            }
+            std::string point = pm.root->crashed_at;
+
+            memset(pm.root->violations, 0, sizeof(pm.root->violations));
+            if (in_child([&] { run_recovery(pm, num); }) != 0) {
+                ++pm.root->violations[RecoveryCrashed];
+            }
+            ++runs;
+            alloc_us.push_back(pm.root->alloc_us);
+            wal_us.push_back(pm.root->wal_us);
+
+            for (int i = 0; i < ViolationNum; i++) {
+                if (pm.root->violations[i] != 0) {
+                    std::cout << ">> Crash #" << n << " at " << point << ": " << pm.root->violations[i]
+                              << " " << violation_names[i] << "\n";
+                    totals[i] += pm.root->violations[i];
+                }
+            }
+        }
+
+        auto report = [&](const char *name, std::vector<uint64_t> &us) {
+            std::sort(us.begin(), us.end());
+            uint64_t sum = 0;
+            for (auto u : us) {
+                sum += u;
+            }
+            std::cout << ">> " << name << " recovery: avg " << sum / us.size() << "us, p50 " << us[us.size() / 2]
+                      << "us, max " << us.back() << "us\n";
+        };
+        std::cout << ">> " << runs << " crashes recovered\n";
+        report("Allocator", alloc_us);
+        report("WAL", wal_us);
+
+        uint64_t violations = 0;
+        for (int i = 0; i < ViolationNum; i++) {
+            if (totals[i] != 0) {
+                std::cout << ">> " << totals[i] << " " << violation_names[i] << " in total\n";
+            }
+            violations += totals[i];
+        }
+        return violations;
+    }
+}
+
+auto main(int argc, char *argv[]) -> int {
+    Parser parser;
+    parser.add_option<size_t>("--size", "-s", 2000);
+    parser.add_option<size_t>("--memory", "-m", 64 * 1024 * 1024);
+    parser.add_option<size_t>("--exhaustive", "-e", 1000);
+    parser.add_option<size_t>("--crashes", "-c", 200);
+    parser.add_option<size_t>("--group", "-g", 8);
+    parser.add_option<std::string>("--file", "-f", "/dev/shm/hill_crash_test");
+    parser.parse(argc, argv);
+
+    auto num = parser.get_as<size_t>("--size").value();
+    auto exhaustive = parser.get_as<size_t>("--exhaustive").value();
+    auto crashes = parser.get_as<size_t>("--crashes").value();
+    auto group = parser.get_as<size_t>("--group").value();
+    auto path = parser.get_as<std::string>("--file").value();
+    auto pm = FakePM::make_fake_pm(path, parser.get_as<size_t>("--memory").value());
+    if (!pm.has_value()) {
+        std::cout << ">> Unable to map fake PM at " << path << "\n";
+        return -1;
+    }
+
+    // operations are durable one by one, then only at the end of their groups unless --group is 0
+    std::vector<size_t> groups = {0};
+    if (group != 0) {
+        groups.push_back(group);
+    }
+    uint64_t violations = 0;
+    for (auto g : groups) {
+        auto found = sweep(pm.value(), num, g, exhaustive, crashes);
+        if (!found.has_value()) {
+            return -1;
+        }
+        violations += found.value();
+    }
+    munmap(pm->base, pm->size);
+    unlink(path.c_str());
+    return violations == 0 ? 0 : -1;
+}
+#else
+auto main() -> int {
+    std::cout << ">> Define __HILL_CRASH_TEST__ in config.hpp to run crash tests\n";
+    return 0;
+}
+#endif
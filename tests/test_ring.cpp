@@ -0,0 +1,400 @@
+#include "store/ring/ring.hpp"
+
+#include "boost/lockfree/queue.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+
+static constexpr size_t uCAP = 128;
+static constexpr size_t uBATCH = 16;
+static constexpr int iFRONTENDS = 32;
+static constexpr int iBACKENDS = 32;
+static constexpr uint64_t uPER_FRONTEND = 100000;
+
+using Ring = SPSCRing<uint64_t, uCAP>;
+using Queue = boost::lockfree::queue<uint64_t, boost::lockfree::capacity<uCAP>>;
+
+/*
+ * Each frontend sends to backends in turn, each backend keeps the sum of what it receives
+ * so that nothing is lost or duplicated
+ */
+template<typename Push, typename Pop>
+static auto bench(Push push, Pop pop) -> double {
+    std::atomic_uint64_t received = 0, sum = 0;
+    std::atomic_bool start = false;
+    std::vector<std::thread> threads;
+
+    for (int f = 0; f < iFRONTENDS; f++) {
+        threads.emplace_back([&, f] {
+            while (!start.load());
+            for (uint64_t i = 0; i < uPER_FRONTEND; i++) {
+                auto b = (f + i) % iBACKENDS;
+                while (!push(f, b, i + 1)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    const uint64_t total = iFRONTENDS * uPER_FRONTEND;
+    for (int b = 0; b < iBACKENDS; b++) {
+        threads.emplace_back([&, b] {
+            uint64_t local = 0;
+            while (!start.load());
+            while (received.load() < total) {
+                auto num = pop(b, local);
+                if (num == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                received += num;
+            }
+            sum += local;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (auto &t : threads) {
+        t.join();
+    }
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    assert(received.load() == total);
+    assert(sum.load() == iFRONTENDS * uPER_FRONTEND * (uPER_FRONTEND + 1) / 2);
+    return total / secs;
+}
+
+int main() {
+    // wrap around and batched pop on a single thread
+    {
+        auto ring = std::make_unique<SPSCRing<int, 4>>();
+        int out[8];
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 4; i++) {
+                assert(ring->push(round * 4 + i));
+            }
+            assert(!ring->push(-1));
+            assert(ring->pop(out, 3) == 3);
+            assert(out[0] == round * 4 && out[2] == round * 4 + 2);
+            assert(ring->pop(out[3]));
+            assert(out[3] == round * 4 + 3);
+            assert(ring->pop(out, 8) == 0);
+            assert(ring->empty());
+        }
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * A consumer parks with a timeout far longer than the test whenever the ring is empty, a lost
+     * wakeup would stall it for the whole timeout
+     */
+    {
+        constexpr uint64_t num = 20000;
+        auto ring = std::make_unique<SPSCRing<uint64_t, uCAP>>();
+        Parker parker;
+        uint64_t sum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        std::thread consumer([&] {
+            uint64_t received = 0, v;
+            while (received < num) {
+                if (ring->pop(v)) {
+                    sum += v;
+                    ++received;
+                    continue;
+                }
+                parker.park([&] { return !ring->empty(); }, 10000000);
+            }
+        });
+
+        for (uint64_t i = 1; i <= num; i++) {
+            while (!ring->push(i));
+            parker.unpark();
+            // leave the consumer time to park now and then
+            if (i % 64 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        consumer.join();
+        auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        assert(sum == num * (num + 1) / 2);
+        assert(secs < 10);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * A thief runs items until one is refused, the refused item goes back to the owner and the
+     * thief reports only what it ran
+     */
+    {
+        Queue shared;
+        for (uint64_t i = 1; i <= 8; i++) {
+            assert(shared.push(i));
+        }
+        uint64_t sum = 0;
+        auto run_below_4 = [&](uint64_t v) {
+            if (v >= 4) {
+                return false;
+            }
+            sum += v;
+            return true;
+        };
+        assert(steal_from(shared, 2, run_below_4) == 2);
+        assert(sum == 1 + 2);
+        assert(steal_from(shared, 4, run_below_4) == 1);
+        assert(sum == 1 + 2 + 3);
+        // every item refused, nothing is run and nothing is lost
+        assert(steal_from(shared, 4, run_below_4) == 0);
+        Queue empty;
+        assert(steal_from(empty, 4, run_below_4) == 0);
+
+        uint64_t left = 0, v;
+        size_t num = 0;
+        while (shared.pop(v)) {
+            left += v;
+            ++num;
+        }
+        assert(num == 5);
+        assert(left == 4 + 5 + 6 + 7 + 8);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Thieves race with the owner on one queue, the owner runs whatever thieves hand back, so every
+     * item is run exactly once
+     */
+    {
+        constexpr uint64_t num = 200000;
+        constexpr int thieves = 4;
+        Queue shared;
+        std::atomic_uint64_t sum = 0, run = 0;
+        std::atomic_bool done = false;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thieves; t++) {
+            threads.emplace_back([&] {
+                while (!done.load()) {
+                    // odd items are refused, as searches on a leaf the owner is modifying
+                    steal_from(shared, 4, [&](uint64_t v) {
+                        if (v & 1) {
+                            return false;
+                        }
+                        sum += v;
+                        ++run;
+                        return true;
+                    });
+                }
+            });
+        }
+
+        for (uint64_t i = 1; i <= num; i++) {
+            while (!shared.push(i)) {
+                uint64_t v;
+                if (shared.pop(v)) {
+                    sum += v;
+                    ++run;
+                }
+            }
+        }
+        while (run.load() < num) {
+            uint64_t v;
+            if (shared.pop(v)) {
+                sum += v;
+                ++run;
+            }
+        }
+        done = true;
+        for (auto &t : threads) {
+            t.join();
+        }
+        assert(run.load() == num);
+        assert(sum.load() == num * (num + 1) / 2);
+    }
+    std::cout << "Succeded\n";
+
+    // the deepest peer is the victim, only if it is behind enough, never the thief itself
+    {
+        std::atomic_int backlogs[4];
+        int values[4] = {3, 40, 16, 40};
+        for (int i = 0; i < 4; i++) {
+            backlogs[i] = values[i];
+        }
+        assert(pick_victim(backlogs, 4, 0, 16) == 1);
+        assert(pick_victim(backlogs, 4, 1, 16) == 3);
+        assert(pick_victim(backlogs, 3, 1, 16) == 2);
+        assert(pick_victim(backlogs, 3, 1, 17) == -1);
+        assert(pick_victim(backlogs, 1, 0, 0) == -1);
+
+        // a sender with writes queued to the owner keeps its searches behind them
+        assert(shares_search(0, 16, 16));
+        assert(!shares_search(0, 15, 16));
+        assert(!shares_search(1, 40, 16));
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * Senders write and search their own keys, mostly of one hot partition. Owners drain their rings
+     * and the searches shared with thieves in groups, idle backends steal from the one most behind
+     * and hand back what they can not run. Every search is answered once and sees the writes its
+     * sender sent before it, and the hot partition is helped
+     */
+    {
+        constexpr int partitions = 4;
+        constexpr int senders = 3;
+        constexpr int group = 8;
+        constexpr int rounds = 2000;
+        struct Op {
+            bool write;
+            int sender;
+            int partition;
+            uint64_t value;
+            // what the sender wrote last before a search, and what the search found
+            uint64_t expected;
+            uint64_t found;
+            int answered;
+        };
+        std::vector<Op> ops;
+        ops.reserve(rounds * senders * 4);
+        std::vector<uint64_t> owned[partitions];
+        Queue shared[partitions];
+        std::atomic_int backlogs[partitions];
+        for (auto &b : backlogs) {
+            b = 0;
+        }
+        uint64_t index[partitions][senders] = {};
+        uint64_t written[partitions][senders] = {};
+        int inflight_writes[senders][partitions] = {};
+        size_t stolen = 0, refused = 0;
+
+        auto run = [&](uint64_t id) {
+            auto &op = ops[id];
+            if (op.write) {
+                index[op.partition][op.sender] = op.value;
+                --inflight_writes[op.sender][op.partition];
+            } else {
+                op.found = index[op.partition][op.sender];
+            }
+            ++op.answered;
+        };
+
+        uint64_t seed = 1;
+        auto next = [&] {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            return seed >> 33;
+        };
+        auto round = [&](bool send) {
+            for (int s = 0; send && s < senders; s++) {
+                for (int k = 0; k < 4; k++) {
+                    Op op{};
+                    op.sender = s;
+                    op.partition = next() % 8 == 0 ? next() % partitions : 0;
+                    op.write = next() % 4 == 0;
+                    op.value = ops.size() + 1;
+                    if (op.write) {
+                        written[op.partition][s] = op.value;
+                        ++inflight_writes[s][op.partition];
+                    } else {
+                        op.expected = written[op.partition][s];
+                    }
+                    ops.push_back(op);
+                    auto id = ops.size() - 1;
+                    auto p = op.partition;
+                    if (!op.write && shares_search(inflight_writes[s][p], backlogs[p].load(), group) && shared[p].push(id)) {
+                        continue;
+                    }
+                    owned[p].push_back(id);
+                }
+            }
+
+            for (int b = 0; b < partitions; b++) {
+                size_t num = 0;
+                for (; num < group && !owned[b].empty(); num++) {
+                    run(owned[b].front());
+                    owned[b].erase(owned[b].begin());
+                }
+                uint64_t id;
+                while (num < group && shared[b].pop(id)) {
+                    run(id);
+                    ++num;
+                }
+                backlogs[b] = num;
+                if (num != 0) {
+                    continue;
+                }
+
+                auto victim = pick_victim(backlogs, partitions, b, group);
+                if (victim == -1) {
+                    continue;
+                }
+                assert(victim == 0);
+                stolen += steal_from(shared[victim], 4, [&](uint64_t id) {
+                    // the owner keeps modifying the leaf
+                    if (next() % 4 == 0) {
+                        ++refused;
+                        return false;
+                    }
+                    run(id);
+                    return true;
+                });
+            }
+        };
+
+        for (int r = 0; r < rounds; r++) {
+            round(true);
+        }
+        for (int r = 0; r < rounds * 4; r++) {
+            round(false);
+        }
+
+        for (const auto &op : ops) {
+            assert(op.answered == 1);
+            if (!op.write) {
+                // writes sent after the search may be run before it, never the ones sent before
+                assert(op.found >= op.expected);
+            }
+        }
+        assert(stolen != 0 && refused != 0);
+    }
+    std::cout << "Succeded\n";
+
+    auto rings = std::make_unique<Ring[]>(iFRONTENDS * iBACKENDS);
+    auto ring_ops = bench(
+        [&](int f, int b, uint64_t v) { return rings[f * iBACKENDS + b].push(v); },
+        [&](int b, uint64_t &sum) {
+            uint64_t batch[uBATCH];
+            size_t num = 0;
+            for (int f = 0; f < iFRONTENDS && num < uBATCH; f++) {
+                num += rings[f * iBACKENDS + b].pop(batch + num, uBATCH - num);
+            }
+            for (size_t i = 0; i < num; i++) {
+                sum += batch[i];
+            }
+            return num;
+        });
+
+    auto queues = std::make_unique<Queue[]>(iBACKENDS);
+    auto queue_ops = bench(
+        [&](int, int b, uint64_t v) { return queues[b].push(v); },
+        [&](int b, uint64_t &sum) {
+            uint64_t v;
+            size_t num = 0;
+            while (num < uBATCH && queues[b].pop(v)) {
+                sum += v;
+                ++num;
+            }
+            return num;
+        });
+
+    std::cout << ">> " << iFRONTENDS << " frontends x " << iBACKENDS << " backends\n";
+    std::cout << ">> SPSC ring mesh: " << ring_ops / 1e6 << " Mops/s\n";
+    std::cout << ">> boost::lockfree::queue: " << queue_ops / 1e6 << " Mops/s\n";
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "store/rmw/rmw.hpp"
+
+#include <iostream>
+#include <string>
+
+#include <cassert>
+
+using namespace Hill;
+using namespace Hill::Store;
+
+static auto counter_of(uint64_t c) -> std::string {
+    return std::string(reinterpret_cast<const char *>(&c), sizeof(c));
+}
+
+int main() {
+    // CompareAndSwap swaps only if the expected value is the current one
+    {
+        std::string desired;
+        auto operand = RMW::make_cas_operand("old", "new value");
+        assert(RMW::compare_and_swap("old", operand.data(), operand.size(), desired) == RMW::Outcome::Ok);
+        assert(desired == "new value");
+
+        desired.clear();
+        assert(RMW::compare_and_swap("other", operand.data(), operand.size(), desired) == RMW::Outcome::Mismatch);
+        assert(desired.empty());
+        // a prefix of the current value is not a match
+        assert(RMW::compare_and_swap("old value", operand.data(), operand.size(), desired) == RMW::Outcome::Mismatch);
+
+        // swapping to an empty value is allowed
+        operand = RMW::make_cas_operand("old", "");
+        assert(RMW::compare_and_swap("old", operand.data(), operand.size(), desired) == RMW::Outcome::Ok);
+        assert(desired.empty());
+
+        // an expected length beyond the operand is malformed
+        operand = RMW::make_cas_operand("old", "");
+        operand.pop_back();
+        assert(RMW::compare_and_swap("old", operand.data(), operand.size(), desired) == RMW::Outcome::Invalid);
+        assert(RMW::compare_and_swap("old", operand.data(), 2, desired) == RMW::Outcome::Invalid);
+    }
+    std::cout << "Succeded\n";
+
+    // FetchAdd wraps around and only applies to 8-byte counters
+    {
+        std::string desired;
+        auto delta = counter_of(5);
+        assert(RMW::fetch_add(counter_of(37), delta.data(), delta.size(), desired) == RMW::Outcome::Ok);
+        assert(desired == counter_of(42));
+
+        assert(RMW::fetch_add(counter_of(UINT64_MAX - 1), delta.data(), delta.size(), desired) == RMW::Outcome::Ok);
+        assert(desired == counter_of(3));
+
+        // a negative delta is its two's complement
+        auto minus_one = counter_of(uint64_t(-1));
+        assert(RMW::fetch_add(counter_of(0), minus_one.data(), minus_one.size(), desired) == RMW::Outcome::Ok);
+        assert(desired == counter_of(UINT64_MAX));
+
+        assert(RMW::fetch_add("short", delta.data(), delta.size(), desired) == RMW::Outcome::Invalid);
+        assert(RMW::fetch_add(counter_of(1), delta.data(), 4, desired) == RMW::Outcome::Invalid);
+    }
+    std::cout << "Succeded\n";
+
+    // Append concatenates whatever is there
+    {
+        std::string desired = "stale";
+        assert(RMW::append("abc", "def", 3, desired) == RMW::Outcome::Ok);
+        assert(desired == "abcdef");
+        assert(RMW::append("", "x", 1, desired) == RMW::Outcome::Ok);
+        assert(desired == "x");
+        assert(RMW::append("abc", "", 0, desired) == RMW::Outcome::Ok);
+        assert(desired == "abc");
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "store/stalled/stalled.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill::Store;
+
+static constexpr int iPARTITIONS = 4;
+static constexpr size_t uBOUND = 3;
+using Stalled = StalledWrites<int, iPARTITIONS, uBOUND>;
+
+// what a frontend does with a write short of memory, false if it is answered Busy
+static auto admit(Stalled &stalled, int partition, int write, std::vector<int> &requests) -> bool {
+    switch (stalled.admit(partition)) {
+    case Enums::Admission::Reject:
+        return false;
+    case Enums::Admission::Request:
+        stalled.request(partition);
+        requests.push_back(partition);
+        [[fallthrough]];
+    case Enums::Admission::Stall:
+        stalled.stall(partition, write);
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    // two starved partitions ask for memory of their own, a full one answers Busy
+    {
+        Stalled stalled;
+        std::vector<int> requests, released, resumed;
+        auto drain = [&] {
+            stalled.drain([&](int p) { released.push_back(p); }, [&](int w) { resumed.push_back(w); });
+        };
+
+        assert(!stalled.needs_memory());
+        assert(admit(stalled, 1, 10, requests));
+        assert(admit(stalled, 2, 20, requests));
+        assert(admit(stalled, 1, 11, requests));
+        assert((requests == std::vector<int>{1, 2}));
+        assert(stalled.needs_memory(1) && stalled.needs_memory(2) && !stalled.needs_memory(0));
+
+        assert(admit(stalled, 1, 12, requests));
+        assert(!admit(stalled, 1, 13, requests));
+        // a partition full of parked writes does not turn away the others
+        assert(admit(stalled, 2, 21, requests));
+        assert(stalled.size() == 5);
+
+        // nothing moves before memory is offered
+        drain();
+        assert(released.empty() && resumed.empty());
+
+        // memory of 2 is offered first, 1 keeps waiting for its own
+        stalled.offered(2);
+        drain();
+        assert((released == std::vector<int>{2}));
+        assert((resumed == std::vector<int>{20, 21}));
+        assert(stalled.needs_memory(1) && !stalled.needs_memory(2));
+
+        // a retry of the write answered Busy is turned away while the partition is full
+        assert(admit(stalled, 1, 13, requests) == false);
+        stalled.offered(1);
+        drain();
+        assert((released == std::vector<int>{2, 1}));
+        assert((resumed == std::vector<int>{20, 21, 10, 11, 12}));
+        assert(stalled.size() == 0 && !stalled.needs_memory());
+
+        // the retry finds no request in flight and asks again
+        assert(admit(stalled, 1, 13, requests));
+        assert((requests == std::vector<int>{1, 2, 1}));
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * A monitor thread offers memory to every starved partition. Busy writes are retried until
+     * each of them is resumed, so no partition waits for memory that is asked for another one
+     */
+    {
+        Stalled stalled;
+        std::atomic_bool done = false;
+        std::thread monitor([&] {
+            while (!done.load()) {
+                for (int p = 0; p < iPARTITIONS; p++) {
+                    if (stalled.needs_memory(p)) {
+                        stalled.offered(p);
+                    }
+                }
+            }
+        });
+
+        constexpr int writes = 1000;
+        std::vector<int> requests;
+        std::vector<int> resumed(iPARTITIONS, 0);
+        std::vector<int> pending;
+        for (int w = 0; w < writes; w++) {
+            pending.push_back(w);
+        }
+        int busy = 0;
+        while (!pending.empty()) {
+            std::vector<int> retried;
+            for (auto w : pending) {
+                if (!admit(stalled, w % 2 == 0 ? 0 : 3, w, requests)) {
+                    ++busy;
+                    retried.push_back(w);
+                }
+            }
+            stalled.drain([](int) {}, [&](int w) { ++resumed[w % 2 == 0 ? 0 : 3]; });
+            pending.swap(retried);
+        }
+        while (stalled.size() != 0) {
+            stalled.drain([](int) {}, [&](int w) { ++resumed[w % 2 == 0 ? 0 : 3]; });
+        }
+        done = true;
+        monitor.join();
+
+        assert(resumed[0] == writes / 2 && resumed[3] == writes / 2);
+        assert(resumed[1] == 0 && resumed[2] == 0);
+        // every write beyond the bound of its partition is answered Busy at least once
+        assert(busy > 0);
+        for (auto p : requests) {
+            assert(p == 0 || p == 3);
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}
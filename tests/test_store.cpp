@@ -55,8 +55,10 @@ auto run_server(const std::string &config, int threads) -> void {
     }
 }
 
-auto run_ycsb_workload(const std::string &config, int threads, const std::string &ycsb_type) -> void {
+auto run_ycsb_workload(const std::string &config, int threads, const std::string &ycsb_type, int keys, int window) -> void {
     auto client = StoreClient::make_client(config);
+    client->set_batch_size(keys);
+    client->set_window(window);
     client->launch();
 
     std::vector<std::thread> clients;
@@ -119,8 +121,10 @@ auto run_ycsb_workload(const std::string &config, int threads, const std::string
     }
 }
 
-auto run_simple_workload(const std::string &config, int threads, int batch) -> void {
+auto run_simple_workload(const std::string &config, int threads, int batch, int keys, int window) -> void {
     auto client = StoreClient::make_client(config);
+    client->set_batch_size(keys);
+    client->set_window(window);
     client->launch();
 
     std::vector<std::thread> clients;
@@ -183,11 +187,13 @@ auto run_simple_workload(const std::string &config, int threads, int batch) -> v
 
 auto run_client(const std::string &config, int threads, CmdParser::Parser &parser) -> void {
     auto ycsb = parser.get_as<std::string>("--ycsb");
+    auto keys = parser.get_as<int>("--keys-per-request").value();
+    auto window = parser.get_as<int>("--window").value();
     if (ycsb.has_value()) {
-        run_ycsb_workload(config, threads, ycsb.value());
+        run_ycsb_workload(config, threads, ycsb.value(), keys, window);
     } else {
         auto batch = parser.get_as<int>("--size").value();
-        run_simple_workload(config, threads, batch);
+        run_simple_workload(config, threads, batch, keys, window);
     }
 }
 
@@ -198,6 +204,8 @@ auto main(int argc, char *argv[]) -> int {
     parser.add_option<std::string>("--config", "-c", "config.moni");
     parser.add_option<int>("--size", "-s", 100000);
     parser.add_option<int>("--multithread", "-m", 1);
+    parser.add_option<int>("--keys-per-request", "-k", 1);
+    parser.add_option<int>("--window", "-w", 1);
     parser.add_option("--ycsb", "-y");
 
     if (argc < 2) {
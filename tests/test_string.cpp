@@ -1,10 +1,71 @@
 #include "kv_pair/kv_pair.hpp"
 
 #include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
 
 #include <cassert>
 
 using namespace Hill::KVPair;
+
+// the comparison HillString used to do, kept as the baseline of the microbenchmark
+static auto bytewise_less(const HillString &lhs, const HillString &rhs) -> bool {
+    for (size_t i = 0; i < std::min(lhs.size(), rhs.size()); i++) {
+        if (lhs.raw_bytes()[i] > rhs.raw_bytes()[i]) {
+            return false;
+        }
+
+        if (lhs.raw_bytes()[i] < rhs.raw_bytes()[i]) {
+            return true;
+        }
+    }
+    return lhs.size() < rhs.size();
+}
+
+// keys share a common head of shared bytes to mimic keys with a fixed prefix like "user"
+static auto benchmark(size_t key_size, size_t shared) -> void {
+    const size_t num = 1024;
+    const size_t rounds = 2000;
+    std::mt19937_64 rng(key_size);
+    std::vector<byte_ptr_t> bufs;
+    std::vector<HillString *> keys;
+    std::vector<uint64_t> prefixes;
+    for (size_t i = 0; i < num; i++) {
+        std::string k(shared, 'k');
+        while (k.size() < key_size) {
+            k.push_back('a' + rng() % 26);
+        }
+        bufs.push_back(new byte_t[sizeof(HillStringHeader) + key_size]);
+        keys.push_back(&HillString::make_string(bufs.back(), k.c_str(), k.size()));
+        prefixes.push_back(keys.back()->prefix());
+    }
+
+    auto run = [&](const char *name, auto less) {
+        size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < num; i++) {
+                hits += less(i, (i + r + 1) % num);
+            }
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << ">> " << key_size << "B keys, " << name << ": "
+                  << double(ns) / (num * rounds) << " ns/cmp (" << hits << ")\n";
+    };
+
+    run("bytewise", [&](size_t a, size_t b) { return bytewise_less(*keys[a], *keys[b]); });
+    run("memcmp", [&](size_t a, size_t b) { return *keys[a] < *keys[b]; });
+    run("prefixed", [&](size_t a, size_t b) {
+        return HillString::compare(prefixes[a], keys[a], prefixes[b], keys[b]->raw_chars(), keys[b]->size()) < 0;
+    });
+
+    for (auto b : bufs) {
+        delete[] b;
+    }
+}
+
 int main() {
     auto buf1 = new byte_t[1024];
     auto buf2 = new byte_t[1024];
@@ -32,5 +93,67 @@ int main() {
     assert(str1->compare("abce", 4) < 0);
     assert(str1->compare("abcde", 5) < 0);
     assert(str1->compare("abc", 3) > 0);
+
+    // binary keys, strncmp used to stop at the first NUL
+    const char bin1[] = {'a', '\0', 'b'};
+    const char bin2[] = {'a', '\0', 'c'};
+    str1 = &HillString::make_string(buf1, bin1, 3);
+    str2 = &HillString::make_string(buf2, bin2, 3);
+    assert(str1->compare(bin2, 3) < 0);
+    assert(str2->compare(bin1, 3) > 0);
+    assert(*str1 < *str2);
+    assert(*str1 != *str2);
+    assert(str1->compare("a", 1) > 0);
+
+    // prefixes agree with the order of keys whenever they differ
+    const std::vector<std::string> ordered = {
+        "", std::string(1, '\0'), "a", std::string("a\0", 2), "ab", "abcdefgh", "abcdefgh0", "abcdefgi", "b", "\xff",
+    };
+    for (size_t i = 0; i < ordered.size(); i++) {
+        for (size_t j = 0; j < ordered.size(); j++) {
+            auto &l = ordered[i];
+            auto &r = ordered[j];
+            auto lp = HillString::prefix_of(l.c_str(), l.size());
+            auto rp = HillString::prefix_of(r.c_str(), r.size());
+            if (lp != rp) {
+                assert((lp < rp) == (i < j));
+            }
+
+            str1 = &HillString::make_string(buf1, l.c_str(), l.size());
+            auto c = HillString::compare(lp, str1, rp, r.c_str(), r.size());
+            assert((c < 0) == (i < j) && (c == 0) == (i == j));
+        }
+    }
+
+    // values of 32KB or more carry a 32-bit length after the header
+    for (size_t size : {Constants::uEXTENDED_LENGTH - 1, Constants::uEXTENDED_LENGTH, 1024 * 1024UL}) {
+        std::string big(size, 'x');
+        big.back() = 'y';
+        auto big1 = new byte_t[HillString::object_size_of(size)];
+        auto big2 = new byte_t[HillString::object_size_of(size)];
+        str1 = &HillString::make_string(big1, big.c_str(), big.size());
+        str2 = &HillString::make_string(big2, big.c_str(), big.size());
+        assert(str1->is_extended() == HillString::is_extended_size(size));
+        assert(str1->is_valid());
+        assert(str1->size() == size);
+        assert(str1->object_size() == HillString::object_size_of(size));
+        assert(str1->to_string() == big);
+        assert(*str1 == *str2);
+
+        // shrinking keeps the layout, so the content stays where it was
+        auto old = str1->raw_bytes();
+        assert(str1->inplace_update("abc", 3));
+        assert(str1->raw_bytes() == old);
+        assert(str1->to_string() == "abc");
+        assert(*str1 < *str2);
+        assert(!str1->inplace_update(big.c_str(), big.size()));
+        delete[] big1;
+        delete[] big2;
+    }
     std::cout <<"Succeded\n";
+
+    benchmark(8, 0);
+    benchmark(16, 4);
+    benchmark(64, 16);
+    benchmark(256, 64);
 }
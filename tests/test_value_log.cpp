@@ -0,0 +1,108 @@
+#include "value_log/value_log.hpp"
+#include "memory_manager/memory_manager.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+using namespace Hill;
+using namespace Hill::ValueLog;
+using namespace Hill::Memory;
+
+int main() {
+    // arenas are 1GB each, pages are only touched by segment headers and records
+    auto total = 3 * Memory::Constants::uREMOTE_REGION_SIZE;
+    byte_ptr_t memory = new byte_t[total];
+    byte_ptr_t dir = new byte_t[sizeof(Directory)];
+    auto alloc = Allocator::make_allocator(memory, total);
+    auto vlog = ValueLog::ValueLog::make_value_log(dir, alloc);
+    auto tid = alloc->register_thread().value();
+
+    // a toy index mapping keys to values
+    std::unordered_map<std::string, byte_ptr_t> index;
+    const int num = 10000;
+    const std::string payload(1000, 'v');
+    for (int i = 0; i < num; i++) {
+        auto key = "key" + std::to_string(i);
+        auto value = payload + std::to_string(i);
+        auto ptr = vlog->append(tid, key.c_str(), key.size(), value.c_str(), value.size(), i);
+        assert(ptr != nullptr);
+        assert(vlog->contains(ptr));
+        index[key] = ptr;
+    }
+    Memory::Util::sfence();
+
+    for (int i = 0; i < num; i++) {
+        auto key = "key" + std::to_string(i);
+        auto v = reinterpret_cast<KVPair::HillString *>(index[key]);
+        assert(v->to_string() == payload + std::to_string(i));
+        auto rec = ValueLog::RecordHeader::of(index[key]);
+        assert(std::string(rec->key(), rec->key_size) == key);
+        assert(KVPair::ValueStamp::validate(index[key], rec->total, key.c_str(), key.size()));
+    }
+    std::cout << ">> " << num << " values appended to " << vlog->get_num_arenas() << " arena(s)\n";
+
+    // a value too long for the 15-bit length gets an extended header, the key still follows it
+    const std::string big(100 * 1024, 'b');
+    auto big_ptr = vlog->append(tid, "big", 3, big.c_str(), big.size(), 0);
+    assert(big_ptr != nullptr);
+    assert(reinterpret_cast<KVPair::HillString *>(big_ptr)->to_string() == big);
+    assert(std::string(ValueLog::RecordHeader::of(big_ptr)->key(), 3) == "big");
+    index["big"] = big_ptr;
+
+    // only a quarter stays live, so all sealed segments become victims
+    for (int i = 0; i < num; i++) {
+        if (i % 4 != 0) {
+            auto key = "key" + std::to_string(i);
+            vlog->free(index[key]);
+            index.erase(key);
+        }
+    }
+
+    auto free_before = vlog->get_num_free_segments();
+    vlog->launch_cleaner();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    vlog->stop_cleaner();
+
+    size_t relocated = 0;
+    auto relocate = [&](const char *k, size_t k_sz, const byte_ptr_t &old, const byte_ptr_t &copy) {
+        auto it = index.find(std::string(k, k_sz));
+        if (it == index.end() || it->second != old) {
+            return false;
+        }
+        it->second = copy;
+        return true;
+    };
+    while (auto n = vlog->clean(tid, relocate)) {
+        relocated += n;
+    }
+    assert(relocated > 0);
+    assert(vlog->get_num_free_segments() > free_before);
+
+    for (auto &[key, ptr] : index) {
+        if (key == "big") {
+            assert(reinterpret_cast<KVPair::HillString *>(ptr)->to_string() == big);
+            continue;
+        }
+        auto i = std::stoi(key.substr(3));
+        auto v = reinterpret_cast<KVPair::HillString *>(ptr);
+        assert(v->to_string() == payload + std::to_string(i));
+        // relocated values keep their stamps
+        assert(KVPair::ValueStamp::of(v)->version == uint32_t(i));
+        assert(KVPair::ValueStamp::validate(ptr, ValueLog::RecordHeader::of(ptr)->total, key.c_str(), key.size()));
+    }
+    std::cout << ">> " << relocated << " live values relocated\n";
+
+    // the directory is the only root, records are rediscovered from segments
+    size_t recovered = 0;
+    auto recovered_log = ValueLog::ValueLog::recover_or_make_value_log(dir, alloc, [&](const char *k, size_t k_sz, const byte_ptr_t &v) {
+        auto it = index.find(std::string(k, k_sz));
+        assert(it != index.end() && it->second == v);
+        ++recovered;
+    });
+    assert(recovered == index.size());
+    std::cout << ">> " << recovered << " values recovered\n";
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include "memory_manager/memory_manager.hpp"
 
 #include <iostream>
+#include <cassert>
+#include <algorithm>
 
 using namespace Hill;
 using namespace Hill::WAL;
@@ -10,7 +12,7 @@ using namespace Hill::Memory;
 
 // 2020.8.19: More test to go
 int main() {
-    byte_ptr_t region = new byte_t[1024 * 1024 * 64];
+    byte_ptr_t region = new byte_t[sizeof(LogRegions)];
 
     byte_ptr_t memory = new byte_t[1024 * 1024 * 128];
     auto logger = Logger::make_unique_logger(region);
@@ -29,9 +31,90 @@ int main() {
     auto log_id = _log_id.value();
     auto mem_id = _mem_id.value();
     for (size_t i = 0; i < Hill::WAL::Constants::uBATCH_SIZE; i++) {
-        auto &addr = logger->make_log(log_id, WAL::Enums::Ops::Insert);
+        auto &entry = logger->make_log(log_id, WAL::Enums::Ops::Insert);
+        byte_ptr_t addr;
         alloc->allocate(mem_id , 16, addr);
+        logger->publish(log_id, entry, addr);
         *((size_t *)addr) = i;
         std::cout << ">> reading " << *((size_t *)addr) << "\n";
     }
+
+    // op and status are packed into the address
+    auto &packed = logger->make_log(log_id, WAL::Enums::Ops::Update);
+    auto remote = reinterpret_cast<byte_ptr_t>(0x8500123456789abcUL);
+    logger->publish(log_id, packed, remote);
+    assert(packed.get_address() == remote);
+    assert(packed.get_op() == WAL::Enums::Ops::Update);
+    assert(packed.get_status() == WAL::Enums::LogStatus::Uncommited);
+    assert(packed.is_remote());
+    packed.commit();
+    assert(packed.get_status() == WAL::Enums::LogStatus::Committed);
+    assert(packed.get_address() == remote);
+    logger->commit(log_id);
+
+    // group commit: entries are only made durable at end_group
+    logger->begin_group(log_id);
+    for (size_t i = 0; i < Hill::WAL::Constants::uBATCH_SIZE; i++) {
+        auto &entry = logger->make_log(log_id, WAL::Enums::Ops::Insert);
+        byte_ptr_t addr;
+        alloc->allocate(mem_id , 16, addr);
+        logger->publish(log_id, entry, addr);
+        *((size_t *)addr) = i;
+        logger->persist(log_id, addr, sizeof(size_t));
+        logger->commit(log_id);
+    }
+    logger->end_group(log_id);
+    std::cout << ">> group committed, cursor is " << logger->regions->regions[log_id].cursor << "\n";
+
+    // run through the ring a few times with the checkpointer draining it
+    logger->launch_checkpointer();
+    auto &r = logger->regions->regions[log_id];
+    for (size_t i = 0; i < 3 * Hill::WAL::Constants::uREGION_CAPACITY; i++) {
+        auto &entry = logger->make_log(log_id, WAL::Enums::Ops::Insert);
+        logger->publish(log_id, entry, reinterpret_cast<byte_ptr_t>(i + 1));
+        logger->commit(log_id);
+    }
+    logger->checkpoint(log_id);
+    logger->stop_checkpointer();
+    std::cout << ">> cursor is " << r.cursor << ", checkpointed is " << r.checkpointed << "\n";
+    assert(r.checkpointed == r.cursor);
+
+    // leave some entries uncommitted in every region and replay them in parallel, never more than a
+    // region holds, or make_log waits for a checkpoint that uncommitted entries never get
+    constexpr size_t uncommitted = std::min(4UL, Hill::WAL::Constants::uREGION_CAPACITY);
+    auto pages = new (std::align_val_t(Hill::Memory::Constants::uPAGE_SIZE)) byte_t[Hill::Memory::Constants::uPAGE_SIZE * 16]();
+    auto crashed = Logger::make_unique_logger(region);
+    for (int i = 0; i < Hill::WAL::Constants::iREGION_NUM; i++) {
+        for (size_t j = 0; j < uncommitted; j++) {
+            auto &entry = crashed->make_log(i, WAL::Enums::Ops::Insert);
+            crashed->publish(i, entry, pages + Hill::Memory::Constants::uPAGE_SIZE * ((i + j) % 16) + 64);
+        }
+    }
+
+    std::atomic_size_t replayed = 0;
+    auto recovered = Logger::recover_unique_logger(region, [&](LogEntry &) {
+        ++replayed;
+        return true;
+    });
+    std::cout << ">> replayed " << replayed << " entries\n";
+    assert(replayed == uncommitted * Hill::WAL::Constants::iREGION_NUM);
+
+    // a crash in the middle of a group replays its entries and closes it
+    crashed = Logger::make_unique_logger(region);
+    crashed->begin_group(0);
+    for (size_t j = 0; j < uncommitted; j++) {
+        auto &entry = crashed->make_log(0, WAL::Enums::Ops::Insert);
+        crashed->publish(0, entry, pages + Hill::Memory::Constants::uPAGE_SIZE * j + 64);
+        crashed->commit(0);
+    }
+    assert(crashed->regions->regions[0].group_start != Hill::WAL::Constants::uNO_GROUP);
+
+    replayed = 0;
+    recovered = Logger::recover_unique_logger(region, [&](LogEntry &) {
+        ++replayed;
+        return true;
+    });
+    std::cout << ">> replayed " << replayed << " entries of an open group\n";
+    assert(replayed == uncommitted);
+    assert(recovered->regions->regions[0].group_start == Hill::WAL::Constants::uNO_GROUP);
 }
@@ -0,0 +1,137 @@
+#include "store/window/window.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include <cassert>
+
+using namespace Hill::Store;
+
+struct Slot {
+    int node_id;
+    std::chrono::steady_clock::time_point retry_at;
+    int request;
+};
+
+using Window = RequestWindow<Slot, 2>;
+
+int main() {
+    // a node with every slot in flight polls until one is released, other nodes are not blocked
+    {
+        Window window;
+        std::vector<Slot> slots(3);
+        slots[0].node_id = slots[1].node_id = 0;
+        slots[2].node_id = 1;
+        for (auto &s : slots) {
+            window.add(&s);
+        }
+
+        auto a = window.acquire(0, [] { assert(false); });
+        window.sent(a);
+        auto b = window.acquire(0, [] { assert(false); });
+        window.sent(b);
+        auto c = window.acquire(1, [] { assert(false); });
+        window.sent(c);
+        assert(window.in_flight() == 3);
+
+        int polls = 0;
+        auto d = window.acquire(0, [&] {
+            if (++polls == 2) {
+                window.release(b);
+            }
+        });
+        assert(polls == 2 && d == b && window.in_flight() == 2);
+
+        // a request that is not sent gives its slot back without being counted
+        window.unused(d);
+        assert(window.in_flight() == 2);
+        assert(window.acquire(0, [] { assert(false); }) == b);
+    }
+    std::cout << "Succeded\n";
+
+    // a deferred request keeps its slot and is resent once its hint passes
+    {
+        Window window;
+        Slot slot;
+        slot.node_id = 1;
+        window.add(&slot);
+        auto s = window.acquire(1, [] { assert(false); });
+        window.sent(s);
+
+        auto now = std::chrono::steady_clock::now();
+        window.defer(s, now + std::chrono::microseconds(100));
+        assert(window.has_deferred() && window.in_flight() == 1);
+        assert(window.resend(now, [](Slot *) { assert(false); }) == 0);
+
+        std::vector<Slot *> resent;
+        assert(window.resend(now + std::chrono::microseconds(100), [&](Slot *r) { resent.push_back(r); }) == 1);
+        assert(resent.size() == 1 && resent[0] == s);
+        assert(!window.has_deferred() && window.in_flight() == 1);
+        window.release(s);
+        assert(window.in_flight() == 0);
+    }
+    std::cout << "Succeded\n";
+
+    /*
+     * A client sends requests to two servers that answer in the order they receive them and
+     * answer every third request Busy once. Each server never has more than its window, and
+     * every request is answered exactly once
+     */
+    {
+        constexpr int window_size = 4;
+        constexpr int requests = 1000;
+        Window window;
+        std::vector<Slot> slots(2 * window_size);
+        for (size_t i = 0; i < slots.size(); i++) {
+            slots[i].node_id = i / window_size;
+            window.add(&slots[i]);
+        }
+
+        std::vector<Slot *> servers[2];
+        std::vector<int> answered(requests, 0);
+        std::vector<bool> rejected(requests, false);
+        auto now = std::chrono::steady_clock::now();
+        // one event of the loop, each server answers its oldest request
+        auto poll = [&] {
+            now += std::chrono::microseconds(1);
+            for (auto &server : servers) {
+                assert(server.size() <= window_size);
+                if (server.empty()) {
+                    continue;
+                }
+                auto slot = server.front();
+                server.erase(server.begin());
+                if (slot->request % 3 == 0 && !rejected[slot->request]) {
+                    rejected[slot->request] = true;
+                    window.defer(slot, now + std::chrono::microseconds(5));
+                    continue;
+                }
+                ++answered[slot->request];
+                window.release(slot);
+            }
+            window.resend(now, [&](Slot *slot) {
+                servers[slot->node_id].push_back(slot);
+            });
+        };
+
+        for (int r = 0; r < requests; r++) {
+            auto node = (r / 3) % 2;
+            auto slot = window.acquire(node, poll);
+            assert(slot->node_id == node);
+            slot->request = r;
+            window.sent(slot);
+            servers[node].push_back(slot);
+            assert(window.in_flight() <= slots.size());
+        }
+        while (window.in_flight() != 0) {
+            poll();
+        }
+
+        for (int r = 0; r < requests; r++) {
+            assert(answered[r] == 1);
+            assert(rejected[r] == (r % 3 == 0));
+        }
+    }
+    std::cout << "Succeded\n";
+    return 0;
+}